@@ -80,7 +80,7 @@ private:
 /// \sa SlabAlloc
 class Allocator {
 public:
-    static constexpr int CURRENT_FILE_FORMAT_VERSION = 6;
+    static constexpr int CURRENT_FILE_FORMAT_VERSION = 7;
 
     /// The specified size must be divisible by 8, and must not be
     /// zero.
@@ -103,7 +103,8 @@ public:
     /// Shorthand for free_(mem.get_ref(), mem.get_addr()).
     void free_(MemRef mem) noexcept;
 
-    /// Calls do_translate().
+    /// Calls do_translate(), unless the ref lies in the range that the
+    /// allocator has marked as directly mapped.
     char* translate(ref_type ref) const noexcept;
 
     /// Returns true if, and only if the object at the specified 'ref'
@@ -202,6 +203,13 @@ public:
     ///     including reshuffling instructions. This is the format used in
     ///     milestone 2.0.0.
     ///
+    ///   7 Introduced the compressed form of leaves of medium strings
+    ///     (ArrayStringLong), which Table::optimize() creates. Earlier
+    ///     versions would read the dictionary of such a leaf as its
+    ///     elements. Also introduced prefix nodes in the StringIndex, which
+    ///     earlier versions would read as lists of row indexes. Files of
+    ///     version 6 are upgraded without changes.
+    ///
     /// IMPORTANT: When introducing a new file format version, be sure to review
     /// the file validity checks in AllocSlab::validate_buffer(), the file
     /// format selection logic in
@@ -212,6 +220,13 @@ public:
 protected:
     size_t m_baseline = 0; // Separation line between immutable and mutable refs.
 
+    // Refs below m_fast_translate_end are translated by translate() as
+    // `m_fast_translate_base + ref`, without calling do_translate(). Allocators
+    // that map a prefix of the ref space directly, such as the initial mapping
+    // of a SlabAlloc, set these.
+    const char* m_fast_translate_base = nullptr;
+    size_t m_fast_translate_end = 0;
+
     Replication* m_replication = nullptr;
 
     /// See get_file_format_version().
@@ -420,6 +435,8 @@ inline void Allocator::free_(MemRef mem) noexcept
 
 inline char* Allocator::translate(ref_type ref) const noexcept
 {
+    if (ref < m_fast_translate_end)
+        return const_cast<char*>(m_fast_translate_base) + ref;
     return do_translate(ref);
 }
 
@@ -154,22 +154,6 @@ private:
 };
 
 
-class SlabAlloc::SlabRefEndEq {
-public:
-    SlabRefEndEq(ref_type ref) noexcept
-        : m_ref(ref)
-    {
-    }
-    bool operator()(const Slab& slab) const noexcept
-    {
-        return slab.ref_end == m_ref;
-    }
-
-private:
-    ref_type m_ref;
-};
-
-
 void SlabAlloc::detach() noexcept
 {
     switch (m_attach_mode) {
@@ -190,6 +174,8 @@ void SlabAlloc::detach() noexcept
             REALM_UNREACHABLE();
     }
     invalidate_cache();
+    m_fast_translate_base = nullptr;
+    m_fast_translate_end = 0;
 
     // Release all allocated memory - this forces us to create new
     // slabs after re-attaching thereby ensuring that the slabs are
@@ -198,6 +184,7 @@ void SlabAlloc::detach() noexcept
         delete[] slab.addr;
     }
     m_slabs.clear();
+    clear_free_space_fast_paths();
 
     m_attach_mode = attach_None;
 }
@@ -260,6 +247,40 @@ MemRef SlabAlloc::do_alloc(const size_t size)
 
     m_free_space_state = free_space_Dirty;
 
+    // Reuse a freed chunk of the same size, or carve the chunk from the arena
+    {
+        ref_type ref = 0;
+        bool found = false;
+        if (size <= max_size_class && !m_size_classes[size / 8 - 1].empty()) {
+            std::vector<ref_type>& size_class = m_size_classes[size / 8 - 1];
+            ref = size_class.back();
+            size_class.pop_back();
+            found = true;
+        }
+        else if (size <= m_arena.size) {
+            ref = m_arena.ref;
+            m_arena.ref += size;
+            m_arena.size -= size;
+            found = true;
+        }
+        if (found) {
+#ifdef REALM_DEBUG
+            if (REALM_COVER_NEVER(m_debug_out))
+                std::cerr << "Alloc ref: " << ref << " size: " << size << "\n";
+#endif
+
+            char* addr = translate(ref);
+#if REALM_ENABLE_ALLOC_SET_ZERO
+            std::fill(addr, addr + size, 0);
+#endif
+#ifdef REALM_SLAB_ALLOC_DEBUG
+            malloc_debug_map[ref] = malloc(1);
+#endif
+            REALM_ASSERT_EX(ref >= m_baseline, ref, m_baseline);
+            return MemRef(addr, ref, *this);
+        }
+    }
+
     // Do we have a free space we can reuse?
     {
         typedef chunks::reverse_iterator iter;
@@ -282,8 +303,13 @@ MemRef SlabAlloc::do_alloc(const size_t size)
                 ref_type ref = i->ref;
                 size_t rest = i->size - size;
 
-                // Update free list
-                if (rest == 0) {
+                // Update free list. If the arena is used up, the rest of the
+                // chunk becomes the new arena.
+                if (rest == 0 || m_arena.size == 0) {
+                    if (rest != 0) {
+                        m_arena.ref = ref + size;
+                        m_arena.size = rest;
+                    }
                     // Erase by "move last over"
                     *i = m_free_space.back();
                     m_free_space.pop_back();
@@ -312,6 +338,12 @@ MemRef SlabAlloc::do_alloc(const size_t size)
     }
 
 
+    // The rest of the arena is too small, so leave it to the free list
+    if (m_arena.size != 0) {
+        m_free_space.push_back(m_arena); // Throws
+        m_arena.size = 0;
+    }
+
     // Allocate new slab. To avoid wasting physical memory, we allocate a page
     size_t new_size = size > page_size() ? size : page_size();
     ref_type ref;
@@ -361,14 +393,9 @@ MemRef SlabAlloc::do_alloc(const size_t size)
     m_slabs.push_back(slab); // Throws
     mem.release();
 
-    // Update free list
-    size_t unused = new_size - size;
-    if (0 < unused) {
-        Chunk chunk;
-        chunk.ref = ref + size;
-        chunk.size = unused;
-        m_free_space.push_back(chunk); // Throws
-    }
+    // The rest of the slab becomes the arena
+    m_arena.ref = ref + size;
+    m_arena.size = new_size - size;
 
 #ifdef REALM_DEBUG
     if (REALM_COVER_NEVER(m_debug_out))
@@ -418,13 +445,48 @@ void SlabAlloc::do_free(ref_type ref, const char* addr) noexcept
 
 #ifdef REALM_DEBUG
     // Check for double free
-    for (auto& c : free_space) {
-        if ((ref >= c.ref && ref < (c.ref + c.size)) || (ref < c.ref && ref_end > c.ref)) {
+    auto check_overlap = [&](ref_type c_ref, size_t c_size) {
+        if ((ref >= c_ref && ref < (c_ref + c_size)) || (ref < c_ref && ref_end > c_ref)) {
             REALM_ASSERT(!"Double Free");
         }
+    };
+    for (auto& c : free_space)
+        check_overlap(c.ref, c.size);
+    if (!read_only) {
+        if (m_arena.size != 0)
+            check_overlap(m_arena.ref, m_arena.size);
+        for (size_t i = 0; i < max_size_class / 8; ++i) {
+            for (ref_type c_ref : m_size_classes[i])
+                check_overlap(c_ref, (i + 1) * 8);
+        }
     }
 #endif
 
+    if (!read_only) {
+        // Give the chunk back to the arena if it directly precedes it within
+        // the same slab
+        if (ref_end == m_arena.ref && (m_arena.size == 0 || !is_slab_end(ref_end))) {
+            m_arena.ref = ref;
+            m_arena.size += size;
+            return;
+        }
+
+#if !REALM_ENABLE_MEMDEBUG
+        // Small chunks go to the list of their size class. When memory
+        // debugging is enabled, they go to the free list instead, so that
+        // do_alloc() can pick a random match.
+        if (size <= max_size_class) {
+            try {
+                m_size_classes[size / 8 - 1].push_back(ref); // Throws
+            }
+            catch (...) {
+                m_free_space_state = free_space_Invalid;
+            }
+            return;
+        }
+#endif
+    }
+
     // Check if we can merge with adjacent succeeding free block
     typedef chunks::iterator iter;
     iter merged_with = free_space.end();
@@ -433,7 +495,7 @@ void SlabAlloc::do_free(ref_type ref, const char* addr) noexcept
             iter i = find_if(free_space.begin(), free_space.end(), ChunkRefEq(ref_end));
             if (i != free_space.end()) {
                 // No consolidation over slab borders
-                if (find_if(m_slabs.begin(), m_slabs.end(), SlabRefEndEq(ref_end)) == m_slabs.end()) {
+                if (!is_slab_end(ref_end)) {
                     i->ref = ref;
                     i->size += size;
                     merged_with = i;
@@ -443,7 +505,7 @@ void SlabAlloc::do_free(ref_type ref, const char* addr) noexcept
 
         // Check if we can merge with adjacent preceeding free block (not if that
         // would cross slab boundary)
-        if (find_if(m_slabs.begin(), m_slabs.end(), SlabRefEndEq(ref)) == m_slabs.end()) {
+        if (!is_slab_end(ref)) {
             iter i = find_if(free_space.begin(), free_space.end(), ChunkRefEndEq(ref));
             if (i != free_space.end()) {
                 if (merged_with != free_space.end()) {
@@ -537,6 +599,16 @@ MemRef SlabAlloc::do_realloc(size_t ref, const char* addr, size_t old_size, size
 }
 
 
+void SlabAlloc::update_fast_translate() noexcept
+{
+    // Reading from an encrypted mapping requires a read barrier, which only
+    // do_translate() applies
+    bool encrypted = m_file_mappings && m_file_mappings->m_initial_mapping.get_encrypted_mapping();
+    m_fast_translate_base = m_data;
+    m_fast_translate_end = (m_data && !encrypted) ? m_initial_chunk_size : 0;
+}
+
+
 char* SlabAlloc::do_translate(ref_type ref) const noexcept
 {
     REALM_ASSERT_DEBUG(is_attached());
@@ -696,6 +768,7 @@ ref_type SlabAlloc::attach_file(const std::string& path, Config& cfg)
         else {
             m_baseline = m_file_mappings->m_initial_mapping.get_size();
         }
+        update_fast_translate();
         ref_type top_ref = 0;
         if (cfg.read_only)
             top_ref = get_top_ref(m_data, m_file_mappings->m_file.get_size());
@@ -874,6 +947,7 @@ ref_type SlabAlloc::attach_file(const std::string& path, Config& cfg)
     dg.release();  // Do not detach
     fcg.release(); // Do not close
     m_file_mappings->m_success = true;
+    update_fast_translate();
     return top_ref;
 }
 
@@ -895,6 +969,7 @@ ref_type SlabAlloc::attach_buffer(const char* data, size_t size)
     m_baseline = size;
     m_initial_chunk_size = size;
     m_attach_mode = attach_UsersBuffer;
+    update_fast_translate();
 
     // Below this point (assignment to `m_attach_mode`), nothing must throw.
 
@@ -965,25 +1040,26 @@ void SlabAlloc::validate_buffer(const char* data, size_t size, const std::string
     else if (is_shared) {
         // In shared mode (Realm file opened via a SharedGroup instance) this
         // version of the core library is able to open Realms using file format
-        // versions 2, 3, 4, 5, and 6. Version 2, 3, 4, and 5 files need to be
-        // upgraded.
+        // versions 2, 3, 4, 5, 6, and 7. Version 2, 3, 4, 5, and 6 files need
+        // to be upgraded.
         switch (file_format_version) {
             case 2:
             case 3:
             case 4:
             case 5:
             case 6:
+            case 7:
                 bad_file_format = false;
         }
     }
     else {
         // In non-shared mode (Realm file opened via a Group instance) this
         // version of the core library is only able to open Realms using file
-        // format version 6. Since a Realm file cannot be upgraded when opened
+        // format version 7. Since a Realm file cannot be upgraded when opened
         // in this mode (we may be unable to write to the file), no earlier
         // versions can be opened.
         switch (file_format_version) {
-            case 6:
+            case 7:
                 bad_file_format = false;
         }
     }
@@ -1008,6 +1084,7 @@ void SlabAlloc::reset_free_space_tracking()
     // been commited to persistent space)
     m_free_read_only.clear();
     m_free_space.clear();
+    clear_free_space_fast_paths();
 
     // Rebuild free list to include all slabs
     Chunk chunk;
@@ -1027,6 +1104,32 @@ void SlabAlloc::reset_free_space_tracking()
 }
 
 
+SlabAlloc::chunks SlabAlloc::get_free_space() const
+{
+    chunks free_space = m_free_space; // Throws
+    if (m_arena.size != 0)
+        free_space.push_back(m_arena); // Throws
+    for (size_t i = 0; i < max_size_class / 8; ++i) {
+        Chunk chunk;
+        chunk.size = (i + 1) * 8;
+        for (ref_type ref : m_size_classes[i]) {
+            chunk.ref = ref;
+            free_space.push_back(chunk); // Throws
+        }
+    }
+    return free_space;
+}
+
+
+void SlabAlloc::clear_free_space_fast_paths() noexcept
+{
+    m_arena.ref = 0;
+    m_arena.size = 0;
+    for (auto& size_class : m_size_classes)
+        size_class.clear();
+}
+
+
 void SlabAlloc::remap(size_t file_size)
 {
     REALM_ASSERT(file_size % 8 == 0); // 8-byte alignment required
@@ -1201,7 +1304,7 @@ void SlabAlloc::verify() const
 {
 #ifdef REALM_DEBUG
     // Make sure that all free blocks fit within a slab
-    for (const auto& chunk : m_free_space) {
+    for (const auto& chunk : get_free_space()) {
         slabs::const_iterator slab =
             upper_bound(m_slabs.begin(), m_slabs.end(), chunk.ref, &ref_less_than_slab_ref_end);
         REALM_ASSERT(slab != m_slabs.end());
@@ -1217,15 +1320,31 @@ void SlabAlloc::verify() const
 
 bool SlabAlloc::is_all_free() const
 {
-    if (m_free_space.size() != m_slabs.size())
+    // Merge adjacent free chunks within each slab, since the arena and the
+    // size class lists are not merged with their neighbours
+    chunks free_space = get_free_space();
+    std::sort(free_space.begin(), free_space.end(), [](const Chunk& a, const Chunk& b) {
+        return a.ref < b.ref;
+    });
+    chunks merged;
+    for (const auto& chunk : free_space) {
+        if (!merged.empty() && merged.back().ref + merged.back().size == chunk.ref && !is_slab_end(chunk.ref)) {
+            merged.back().size += chunk.size;
+        }
+        else {
+            merged.push_back(chunk);
+        }
+    }
+
+    if (merged.size() != m_slabs.size())
         return false;
 
     // Verify that free space matches slabs
     ref_type slab_ref = m_baseline;
     for (const auto& slab : m_slabs) {
         size_t slab_size = slab.ref_end - slab_ref;
-        chunks::const_iterator chunk = find_if(m_free_space.begin(), m_free_space.end(), ChunkRefEq(slab_ref));
-        if (chunk == m_free_space.end())
+        chunks::const_iterator chunk = find_if(merged.begin(), merged.end(), ChunkRefEq(slab_ref));
+        if (chunk == merged.end())
             return false;
         if (slab_size != chunk->size)
             return false;
@@ -1240,8 +1359,9 @@ void SlabAlloc::print() const
 {
     size_t allocated_for_slabs = m_slabs.empty() ? 0 : m_slabs.back().ref_end - m_baseline;
 
+    chunks free_space = get_free_space();
     size_t free = 0;
-    for (const auto& free_block : m_free_space) {
+    for (const auto& free_block : free_space) {
         free += free_block.size;
     }
 
@@ -1265,10 +1385,10 @@ void SlabAlloc::print() const
         std::cout << "\n";
     }
 
-    if (!m_free_space.empty()) {
+    if (!free_space.empty()) {
         std::cout << "FreeSpace: ";
-        for (const auto& free_block : m_free_space) {
-            if (&free_block != &m_free_space.front())
+        for (const auto& free_block : free_space) {
+            if (&free_block != &free_space.front())
                 std::cout << ", ";
 
             ref_type last_ref = free_block.ref + free_block.size - 1;
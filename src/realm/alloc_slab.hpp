@@ -23,6 +23,7 @@
 #include <vector>
 #include <string>
 #include <atomic>
+#include <algorithm>
 
 #include <realm/util/features.h>
 #include <realm/util/file.hpp>
@@ -421,6 +422,20 @@ private:
     chunks m_free_space;
     chunks m_free_read_only;
 
+    // The unused tail of the most recently added slab. Allocations that cannot
+    // reuse a freed chunk of their exact size are carved from its start before
+    // m_free_space is searched, and a freed chunk that ends where the arena
+    // begins is given back to it.
+    Chunk m_arena = {0, 0};
+
+    // Freed chunks of mutable memory of up to `max_size_class` bytes are kept
+    // in one list per size (at index `size / 8 - 1`) rather than in
+    // m_free_space, so that freeing and reusing them takes constant time. They
+    // are not merged with their neighbours until the free space tracking is
+    // reset.
+    static const size_t max_size_class = 1024;
+    std::vector<ref_type> m_size_classes[max_size_class / 8];
+
     bool m_debug_out = false;
     struct hash_entry {
         ref_type ref = 0;
@@ -446,8 +461,19 @@ private:
 
     class ChunkRefEq;
     class ChunkRefEndEq;
-    class SlabRefEndEq;
     static bool ref_less_than_slab_ref_end(ref_type, const Slab&) noexcept;
+    bool is_slab_end(ref_type) const noexcept;
+
+    /// Returns all free chunks of mutable memory, that is, those of
+    /// m_free_space, the arena and the size class lists, in no particular
+    /// order and without merging adjacent chunks.
+    chunks get_free_space() const;
+    void clear_free_space_fast_paths() noexcept;
+
+    /// Let Allocator::translate() map refs into the initial mapping or buffer
+    /// directly, unless it is encrypted. Must be called whenever m_data or
+    /// m_initial_chunk_size changes.
+    void update_fast_translate() noexcept;
 
     Replication* get_replication() const noexcept
     {
@@ -490,6 +516,7 @@ private:
 
     friend class Group;
     friend class GroupWriter;
+    friend class SharedGroup;
 };
 
 inline void SlabAlloc::invalidate_cache() noexcept
@@ -567,6 +594,13 @@ inline bool SlabAlloc::ref_less_than_slab_ref_end(ref_type ref, const Slab& slab
     return ref < slab.ref_end;
 }
 
+inline bool SlabAlloc::is_slab_end(ref_type ref) const noexcept
+{
+    // The first slab ending at or after `ref`
+    slabs::const_iterator i = std::upper_bound(m_slabs.begin(), m_slabs.end(), ref - 1, &ref_less_than_slab_ref_end);
+    return i != m_slabs.end() && i->ref_end == ref;
+}
+
 inline size_t SlabAlloc::get_upper_section_boundary(size_t start_pos) const noexcept
 {
     return get_section_base(1 + get_section_index(start_pos));
@@ -16,6 +16,10 @@
  *
  **************************************************************************/
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include <realm/array_string_long.hpp>
 #include <realm/array_blob.hpp>
 #include <realm/impl/destroy_guard.hpp>
@@ -33,15 +37,137 @@ void ArrayStringLong::init_from_mem(MemRef mem) noexcept
     m_offsets.init_from_ref(offsets_ref);
     m_blob.init_from_ref(blob_ref);
 
-    if (m_nullable) {
+    m_compressed = (Array::size() == compressed_top_size);
+    if (m_compressed) {
+        ref_type indexes_ref = get_as_ref(2);
+        m_indexes.init_from_ref(indexes_ref);
+    }
+    else if (m_nullable) {
         ref_type nulls_ref = get_as_ref(2);
         m_nulls.init_from_ref(nulls_ref);
     }
 }
 
 
+void ArrayStringLong::insert_key(size_t key_ndx, StringData value)
+{
+    size_t pos = 0 < key_ndx ? to_size_t(m_offsets.get(key_ndx - 1)) : 0;
+    bool add_zero_term = true;
+    m_blob.insert(pos, value.data(), value.size(), add_zero_term); // Throws
+    m_offsets.insert(key_ndx, pos + value.size() + 1);             // Throws
+    m_offsets.adjust(key_ndx + 1, m_offsets.size(), value.size() + 1);
+}
+
+
+size_t ArrayStringLong::lower_bound_key(StringData value) const noexcept
+{
+    size_t lo = 0;
+    size_t hi = m_offsets.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (get_key(mid) < value) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+
+size_t ArrayStringLong::find_key(StringData value) const noexcept
+{
+    REALM_ASSERT_DEBUG(m_compressed);
+
+    if (value.is_null()) {
+        if (m_nullable)
+            return 0;
+        // Non-nullable leaves store null as the empty string
+        value = StringData("", 0);
+    }
+
+    size_t key_ndx = lower_bound_key(value);
+    if (key_ndx < m_offsets.size() && get_key(key_ndx) == value)
+        return key_ndx + 1;
+    return npos;
+}
+
+
+size_t ArrayStringLong::intern(StringData value)
+{
+    if (value.is_null()) {
+        if (m_nullable)
+            return 0;
+        value = StringData("", 0);
+    }
+
+    size_t key_ndx = lower_bound_key(value);
+    if (key_ndx < m_offsets.size() && get_key(key_ndx) == value)
+        return key_ndx + 1;
+
+    // Reclaim the entries that are left behind by erase() and set() once
+    // they dominate the dictionary. Since the dictionary then holds no more
+    // entries than there are elements, this takes amortized constant time
+    // per added entry.
+    if (m_offsets.size() > 2 * m_indexes.size() + 16) {
+        compact_dictionary(); // Throws
+        key_ndx = lower_bound_key(value);
+    }
+
+    insert_key(key_ndx, value); // Throws
+    // Elements referring to later entries must follow them
+    m_indexes.adjust_ge(int64_t(key_ndx + 1), 1);
+    return key_ndx + 1;
+}
+
+
+void ArrayStringLong::compact_dictionary()
+{
+    size_t num_keys = m_offsets.size();
+    size_t n = m_indexes.size();
+
+    // New value in `m_indexes` for each old one, zero for unused entries
+    std::vector<size_t> new_indexes(num_keys + 1, 0); // Throws
+    for (size_t i = 0; i < n; ++i)
+        new_indexes[to_size_t(m_indexes.get(i))] = 1;
+    std::vector<std::string> keys;
+    for (size_t key_ndx = 0; key_ndx < num_keys; ++key_ndx) {
+        if (new_indexes[key_ndx + 1] != 0) {
+            keys.push_back(get_key(key_ndx)); // Throws
+            new_indexes[key_ndx + 1] = keys.size();
+        }
+    }
+    new_indexes[0] = 0;
+
+    // The entries keep their order, so the dictionary stays sorted
+    m_blob.clear();
+    m_offsets.clear();
+    for (const std::string& key : keys)
+        insert_key(m_offsets.size(), key); // Throws
+    for (size_t i = 0; i < n; ++i)
+        m_indexes.set(i, new_indexes[to_size_t(m_indexes.get(i))]); // Throws
+}
+
+
+bool ArrayStringLong::can_store_compressed(StringData value) const noexcept
+{
+    REALM_ASSERT_DEBUG(m_compressed);
+
+    if (m_blob.size() + value.size() + 1 <= max_compressed_dictionary_size)
+        return true;
+    return find_key(value) != npos;
+}
+
+
 void ArrayStringLong::add(StringData value)
 {
+    if (m_compressed) {
+        size_t index = intern(value); // Throws
+        m_indexes.add(index);         // Throws
+        return;
+    }
+
     bool add_zero_term = true;
     m_blob.add(value.data(), value.size(), add_zero_term);
     size_t end = value.size() + 1;
@@ -54,7 +180,13 @@ void ArrayStringLong::add(StringData value)
 
 void ArrayStringLong::set(size_t ndx, StringData value)
 {
-    REALM_ASSERT_3(ndx, <, m_offsets.size());
+    REALM_ASSERT_3(ndx, <, size());
+
+    if (m_compressed) {
+        size_t index = intern(value); // Throws
+        m_indexes.set(ndx, index);    // Throws
+        return;
+    }
 
     size_t begin = 0 < ndx ? to_size_t(m_offsets.get(ndx - 1)) : 0;
     size_t end = to_size_t(m_offsets.get(ndx));
@@ -70,7 +202,13 @@ void ArrayStringLong::set(size_t ndx, StringData value)
 
 void ArrayStringLong::insert(size_t ndx, StringData value)
 {
-    REALM_ASSERT_3(ndx, <=, m_offsets.size());
+    REALM_ASSERT_3(ndx, <=, size());
+
+    if (m_compressed) {
+        size_t index = intern(value);  // Throws
+        m_indexes.insert(ndx, index); // Throws
+        return;
+    }
 
     size_t pos = 0 < ndx ? to_size_t(m_offsets.get(ndx - 1)) : 0;
     bool add_zero_term = true;
@@ -84,7 +222,18 @@ void ArrayStringLong::insert(size_t ndx, StringData value)
 
 void ArrayStringLong::erase(size_t ndx)
 {
-    REALM_ASSERT_3(ndx, <, m_offsets.size());
+    REALM_ASSERT_3(ndx, <, size());
+
+    if (m_compressed) {
+        // The dictionary entry is left behind, and reclaimed by intern() or
+        // slice()
+        if (m_indexes.size() == 1) {
+            clear();
+            return;
+        }
+        m_indexes.erase(ndx);
+        return;
+    }
 
     size_t begin = 0 < ndx ? to_size_t(m_offsets.get(ndx - 1)) : 0;
     size_t end = to_size_t(m_offsets.get(ndx));
@@ -98,6 +247,10 @@ void ArrayStringLong::erase(size_t ndx)
 
 bool ArrayStringLong::is_null(size_t ndx) const
 {
+    if (m_compressed) {
+        REALM_ASSERT_3(ndx, <, m_indexes.size());
+        return m_indexes.get(ndx) == 0;
+    }
     if (m_nullable) {
         REALM_ASSERT_3(ndx, <, m_nulls.size());
         return !m_nulls.get(ndx);
@@ -109,6 +262,13 @@ bool ArrayStringLong::is_null(size_t ndx) const
 
 void ArrayStringLong::set_null(size_t ndx)
 {
+    if (m_compressed) {
+        if (m_nullable) {
+            REALM_ASSERT_3(ndx, <, m_indexes.size());
+            m_indexes.set(ndx, 0);
+        }
+        return;
+    }
     if (m_nullable) {
         REALM_ASSERT_3(ndx, <, m_nulls.size());
         m_nulls.set(ndx, false);
@@ -139,6 +299,15 @@ size_t ArrayStringLong::find_first(StringData value, size_t begin, size_t end) c
     REALM_ASSERT_7(begin, <=, n, &&, end, <=, n);
     REALM_ASSERT_3(begin, <=, end);
 
+    if (m_compressed) {
+        // Search the dictionary once, and then the (typically very narrow)
+        // array of indexes, instead of comparing each string.
+        size_t index = find_key(value);
+        if (index == npos)
+            return not_found;
+        return m_indexes.find_first(int64_t(index), begin, end);
+    }
+
     for (size_t i = begin; i < end; ++i) {
         StringData value_2 = get(i);
         if (value_2 == value)
@@ -168,7 +337,16 @@ StringData ArrayStringLong::get(const char* header, size_t ndx, Allocator& alloc
     ref_type blob_ref;
     ref_type nulls_ref;
 
-    if (nullable) {
+    if (Array::get_size_from_header(header) == compressed_top_size) {
+        ref_type indexes_ref;
+        get_three(header, 0, offsets_ref, blob_ref, indexes_ref);
+        const char* indexes_header = alloc.translate(indexes_ref);
+        size_t index = to_size_t(Array::get(indexes_header, ndx));
+        if (index == 0)
+            return realm::null();
+        ndx = index - 1;
+    }
+    else if (nullable) {
         get_three(header, 0, offsets_ref, blob_ref, nulls_ref);
         const char* nulls_header = alloc.translate(nulls_ref);
         if (Array::get(nulls_header, ndx) == 0)
@@ -214,7 +392,7 @@ ref_type ArrayStringLong::bptree_leaf_insert(size_t ndx, StringData value, TreeI
 
     // Split leaf node
     ArrayStringLong new_leaf(get_alloc(), m_nullable);
-    new_leaf.create(); // Throws
+    new_leaf.create(m_compressed); // Throws
     if (ndx == leaf_size) {
         new_leaf.add(value); // Throws
         state.m_split_offset = ndx;
@@ -231,12 +409,16 @@ ref_type ArrayStringLong::bptree_leaf_insert(size_t ndx, StringData value, TreeI
 }
 
 
-MemRef ArrayStringLong::create_array(size_t size, Allocator& alloc, bool nullable)
+MemRef ArrayStringLong::create_array(size_t size, Allocator& alloc, bool nullable, bool compressed)
 {
     Array top(alloc);
     _impl::DeepArrayDestroyGuard dg(&top);
     top.create(type_HasRefs); // Throws
 
+    // A compressed array starts out with an empty dictionary, so it can only
+    // be created empty.
+    REALM_ASSERT(!compressed || size == 0);
+
     _impl::DeepArrayRefDestroyGuard dg_2(alloc);
     {
         bool context_flag = false;
@@ -255,7 +437,18 @@ MemRef ArrayStringLong::create_array(size_t size, Allocator& alloc, bool nullabl
         top.add(v); // Throws
         dg_2.release();
     }
-    if (nullable) {
+    if (compressed) {
+        bool context_flag = false;
+        int64_t value = 0;
+        MemRef mem = ArrayInteger::create_array(type_Normal, context_flag, size, value, alloc); // Throws
+        dg_2.reset(mem.get_ref());
+        int64_t v(from_ref(mem.get_ref()));
+        top.add(v); // Throws
+        dg_2.release();
+        uint_fast64_t flags = nullable ? 1 : 0;
+        top.add(RefOrTagged::make_tagged(flags)); // Throws
+    }
+    else if (nullable) {
         bool context_flag = false;
         int64_t value = 0; // initialize all rows to realm::null()
         MemRef mem = ArrayInteger::create_array(type_Normal, context_flag, size, value, alloc); // Throws
@@ -276,7 +469,7 @@ MemRef ArrayStringLong::slice(size_t offset, size_t slice_size, Allocator& targe
 
     ArrayStringLong array_slice(target_alloc, m_nullable);
     _impl::ShallowArrayDestroyGuard dg(&array_slice);
-    array_slice.create(); // Throws
+    array_slice.create(m_compressed); // Throws
     size_t begin = offset;
     size_t end = offset + slice_size;
     for (size_t i = begin; i != end; ++i) {
@@ -303,6 +496,8 @@ void ArrayStringLong::to_dot(std::ostream& out, StringData title) const
     Array::to_dot(out, "stringlong_top");
     m_offsets.to_dot(out, "offsets");
     m_blob.to_dot(out, "blob");
+    if (m_compressed)
+        m_indexes.to_dot(out, "indexes");
 
     out << "}" << std::endl;
 }
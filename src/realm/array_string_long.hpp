@@ -25,10 +25,36 @@
 namespace realm {
 
 
+/// A leaf of medium strings. Normally the strings are stored back to back
+/// in a blob, and the end offset of each string is stored in a separate
+/// integer array. A leaf can also be in compressed form, where offsets and
+/// blob hold a dictionary of the distinct strings of the leaf, and each
+/// element refers to an entry in that dictionary:
+///
+///     uncompressed:  [ offsets, blob ] or [ offsets, blob, nulls ]
+///     compressed:    [ offsets, blob, indexes, flags ]
+///
+/// In the compressed form, the value of an element in `indexes` is zero
+/// for null, and otherwise one plus the index of the dictionary
+/// entry. `flags` is a tagged integer that records whether the leaf is
+/// nullable. The dictionary is kept in ascending order, so that strings are
+/// looked up by binary search. Entries that are no longer referred to are
+/// left behind by modifying operations, until they make up more than half of
+/// the dictionary, at which point the dictionary is compacted. Slicing the
+/// leaf (see slice()) also drops them.
+///
+/// Since every element of a compressed leaf is looked up through the
+/// dictionary, there is no need to restrict the size of the strings that it
+/// holds, as long as the dictionary stays within
+/// `max_compressed_dictionary_size`.
 class ArrayStringLong : public Array {
 public:
     typedef StringData value_type;
 
+    /// The maximum number of bytes that the dictionary of a compressed leaf
+    /// can occupy.
+    static const size_t max_compressed_dictionary_size = 0x400000; // 4 MiB
+
     explicit ArrayStringLong(Allocator&, bool nullable) noexcept;
     ~ArrayStringLong() noexcept override
     {
@@ -40,7 +66,7 @@ public:
     ///
     /// Note that the caller assumes ownership of the allocated
     /// underlying node. It is not owned by the accessor.
-    void create();
+    void create(bool compressed = false);
 
     //@{
     /// Overriding functions of Array
@@ -66,6 +92,18 @@ public:
     bool is_null(size_t ndx) const;
     void set_null(size_t ndx);
 
+    /// Returns true if, and only if this leaf is in compressed form.
+    bool is_compressed() const noexcept;
+
+    /// Returns true if the specified value can be stored in this compressed
+    /// leaf, that is, if there is room for it in the dictionary, or if it is
+    /// already there. The dictionary is only searched when it is nearly full.
+    bool can_store_compressed(StringData value) const noexcept;
+
+    /// Returns the number of entries in the dictionary of a compressed leaf,
+    /// or the number of elements of an uncompressed leaf.
+    size_t get_dictionary_size() const noexcept;
+
     size_t count(StringData value, size_t begin = 0, size_t end = npos) const noexcept;
     size_t find_first(StringData value, size_t begin = 0, size_t end = npos) const noexcept;
     void find_all(IntegerColumn& result, StringData value, size_t add_offset = 0, size_t begin = 0,
@@ -83,11 +121,12 @@ public:
 
     /// Construct a long string array of the specified size and return
     /// just the reference to the underlying memory. All elements will
-    /// be initialized to zero size blobs.
-    static MemRef create_array(size_t size, Allocator&, bool nullable);
+    /// be initialized to zero size blobs (or null, if nullable).
+    static MemRef create_array(size_t size, Allocator&, bool nullable, bool compressed = false);
 
     /// Construct a copy of the specified slice of this long string
-    /// array using the specified target allocator.
+    /// array using the specified target allocator. The copy is compressed
+    /// if, and only if this array is compressed.
     MemRef slice(size_t offset, size_t slice_size, Allocator& target_alloc) const;
 
 #ifdef REALM_DEBUG
@@ -100,7 +139,29 @@ private:
     ArrayInteger m_offsets;
     ArrayBlob m_blob;
     Array m_nulls;
+    ArrayInteger m_indexes;
     bool m_nullable;
+    bool m_compressed = false;
+
+    static const size_t compressed_top_size = 4;
+
+    StringData get_key(size_t key_ndx) const noexcept;
+    void insert_key(size_t key_ndx, StringData value);
+
+    // Returns the index of the first dictionary entry that is not less than
+    // the specified string.
+    size_t lower_bound_key(StringData value) const noexcept;
+
+    // Returns the value to be stored in `m_indexes` for the specified string,
+    // or `npos` if it is not in the dictionary.
+    size_t find_key(StringData value) const noexcept;
+
+    // Same as find_key(), but adds the string to the dictionary if it is not
+    // already there.
+    size_t intern(StringData value);
+
+    // Remove the dictionary entries that no element refers to.
+    void compact_dictionary();
 };
 
 
@@ -110,18 +171,20 @@ inline ArrayStringLong::ArrayStringLong(Allocator& allocator, bool nullable) noe
     , m_offsets(allocator)
     , m_blob(allocator)
     , m_nulls(nullable ? allocator : Allocator::get_default())
+    , m_indexes(allocator)
     , m_nullable(nullable)
 {
     m_offsets.set_parent(this, 0);
     m_blob.set_parent(this, 1);
     if (nullable)
         m_nulls.set_parent(this, 2);
+    m_indexes.set_parent(this, 2);
 }
 
-inline void ArrayStringLong::create()
+inline void ArrayStringLong::create(bool compressed)
 {
     size_t init_size = 0;
-    MemRef mem = create_array(init_size, get_alloc(), m_nullable); // Throws
+    MemRef mem = create_array(init_size, get_alloc(), m_nullable, compressed); // Throws
     init_from_mem(mem);
 }
 
@@ -130,7 +193,13 @@ inline void ArrayStringLong::init_from_ref(ref_type ref) noexcept
     REALM_ASSERT(ref);
     char* header = get_alloc().translate(ref);
     init_from_mem(MemRef(header, ref, m_alloc));
-    m_nullable = (Array::size() == 3);
+    if (m_compressed) {
+        uint_fast64_t flags = Array::get(3) >> 1;
+        m_nullable = (flags & 1) != 0;
+    }
+    else {
+        m_nullable = (Array::size() == 3);
+    }
 }
 
 inline void ArrayStringLong::init_from_parent() noexcept
@@ -141,25 +210,32 @@ inline void ArrayStringLong::init_from_parent() noexcept
 
 inline bool ArrayStringLong::is_empty() const noexcept
 {
-    return m_offsets.is_empty();
+    return size() == 0;
 }
 
 inline size_t ArrayStringLong::size() const noexcept
 {
+    if (m_compressed)
+        return m_indexes.size();
     return m_offsets.size();
 }
 
-inline StringData ArrayStringLong::get(size_t ndx) const noexcept
+inline bool ArrayStringLong::is_compressed() const noexcept
 {
-    REALM_ASSERT_3(ndx, <, m_offsets.size());
+    return m_compressed;
+}
 
-    if (m_nullable && m_nulls.get(ndx) == 0)
-        return realm::null();
+inline size_t ArrayStringLong::get_dictionary_size() const noexcept
+{
+    return m_offsets.size();
+}
 
+inline StringData ArrayStringLong::get_key(size_t key_ndx) const noexcept
+{
     size_t begin, end;
-    if (0 < ndx) {
-        begin = to_size_t(m_offsets.get(ndx - 1));
-        end = to_size_t(m_offsets.get(ndx));
+    if (0 < key_ndx) {
+        begin = to_size_t(m_offsets.get(key_ndx - 1));
+        end = to_size_t(m_offsets.get(key_ndx));
     }
     else {
         begin = 0;
@@ -170,9 +246,35 @@ inline StringData ArrayStringLong::get(size_t ndx) const noexcept
     return StringData(m_blob.get(begin), end - begin);
 }
 
+inline StringData ArrayStringLong::get(size_t ndx) const noexcept
+{
+    REALM_ASSERT_3(ndx, <, size());
+
+    if (m_compressed) {
+        size_t index = to_size_t(m_indexes.get(ndx));
+        if (index == 0)
+            return realm::null();
+        return get_key(index - 1);
+    }
+
+    if (m_nullable && m_nulls.get(ndx) == 0)
+        return realm::null();
+
+    return get_key(ndx);
+}
+
 inline void ArrayStringLong::truncate(size_t new_size)
 {
-    REALM_ASSERT_3(new_size, <, m_offsets.size());
+    REALM_ASSERT_3(new_size, <, size());
+
+    if (m_compressed) {
+        if (new_size == 0) {
+            clear();
+            return;
+        }
+        m_indexes.truncate(new_size);
+        return;
+    }
 
     size_t blob_size = new_size ? to_size_t(m_offsets.get(new_size - 1)) : 0;
 
@@ -186,6 +288,10 @@ inline void ArrayStringLong::clear()
 {
     m_blob.clear();
     m_offsets.clear();
+    if (m_compressed) {
+        m_indexes.clear();
+        return;
+    }
     if (m_nullable)
         m_nulls.clear();
 }
@@ -194,8 +300,12 @@ inline void ArrayStringLong::destroy()
 {
     m_blob.destroy();
     m_offsets.destroy();
-    if (m_nullable)
+    if (m_compressed) {
+        m_indexes.destroy();
+    }
+    else if (m_nullable) {
         m_nulls.destroy();
+    }
     Array::destroy();
 }
 
@@ -205,17 +315,22 @@ inline bool ArrayStringLong::update_from_parent(size_t old_baseline) noexcept
     if (res) {
         m_blob.update_from_parent(old_baseline);
         m_offsets.update_from_parent(old_baseline);
-        if (m_nullable)
+        if (m_compressed) {
+            m_indexes.update_from_parent(old_baseline);
+        }
+        else if (m_nullable) {
             m_nulls.update_from_parent(old_baseline);
+        }
     }
     return res;
 }
 
 inline size_t ArrayStringLong::get_size_from_header(const char* header, Allocator& alloc) noexcept
 {
-    ref_type offsets_ref = to_ref(Array::get(header, 0));
-    const char* offsets_header = alloc.translate(offsets_ref);
-    return Array::get_size_from_header(offsets_header);
+    bool compressed = Array::get_size_from_header(header) == compressed_top_size;
+    ref_type ref = to_ref(Array::get(header, compressed ? 2 : 0));
+    const char* sizing_header = alloc.translate(ref);
+    return Array::get_size_from_header(sizing_header);
 }
 
 
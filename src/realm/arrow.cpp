@@ -0,0 +1,1147 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+#include <realm/arrow.hpp>
+#include <realm/exceptions.hpp>
+#include <realm/table.hpp>
+#include <realm/table_view.hpp>
+
+using namespace realm;
+
+namespace {
+
+const int64_t nanoseconds_per_second = 1000000000;
+
+// Rows `begin` to `end` of a table
+struct TableRows {
+    size_t begin, end;
+
+    size_t size() const noexcept
+    {
+        return end - begin;
+    }
+
+    template <class F>
+    void for_each(F func) const
+    {
+        for (size_t row = begin; row < end; ++row)
+            func(row); // Throws
+    }
+};
+
+// The attached rows among rows `begin` to `end` of a view, of which there are
+// `count`
+struct ViewRows {
+    const TableViewBase& view;
+    size_t begin, end, count;
+
+    size_t size() const noexcept
+    {
+        return count;
+    }
+
+    template <class F>
+    void for_each(F func) const
+    {
+        for (size_t i = begin; i < end; ++i) {
+            if (view.is_row_attached(i))
+                func(view.get_source_ndx(i)); // Throws
+        }
+    }
+};
+
+// Calls `func(row, value)` for each row, where `value` is the value of the row
+// in integer or bool column `col`, or none if it is null. For a range of table rows,
+// the column is read one leaf at a time.
+template <class F>
+void for_each_int(const Table& table, size_t col, const TableRows& rows, F func)
+{
+    const ColumnBase& column = _impl::TableFriend::get_column(table, col);
+    if (table.is_nullable(col)) {
+        const IntNullColumn& ints = static_cast<const IntNullColumn&>(column);
+        IntNullColumn::LeafType fallback(ints.get_alloc());
+        const IntNullColumn::LeafType* leaf = nullptr;
+        for (size_t row = rows.begin; row < rows.end;) {
+            size_t ndx_in_leaf;
+            IntNullColumn::LeafInfo leaf_info{&leaf, &fallback};
+            ints.get_leaf(row, ndx_in_leaf, leaf_info);
+            size_t leaf_end = std::min(leaf->size(), ndx_in_leaf + (rows.end - row));
+            for (; ndx_in_leaf < leaf_end; ++ndx_in_leaf, ++row)
+                func(row, leaf->get(ndx_in_leaf));
+        }
+    }
+    else {
+        const IntegerColumn& ints = static_cast<const IntegerColumn&>(column);
+        IntegerColumn::LeafType fallback(ints.get_alloc());
+        const IntegerColumn::LeafType* leaf = nullptr;
+        for (size_t row = rows.begin; row < rows.end;) {
+            size_t ndx_in_leaf;
+            IntegerColumn::LeafInfo leaf_info{&leaf, &fallback};
+            ints.get_leaf(row, ndx_in_leaf, leaf_info);
+            size_t leaf_end = std::min(leaf->size(), ndx_in_leaf + (rows.end - row));
+            for (; ndx_in_leaf < leaf_end; ++ndx_in_leaf, ++row)
+                func(row, util::Optional<int64_t>(leaf->get(ndx_in_leaf)));
+        }
+    }
+}
+
+template <class Rows, class F>
+void for_each_int(const Table& table, size_t col, const Rows& rows, F func)
+{
+    bool nullable = table.is_nullable(col);
+    bool is_bool = table.get_column_type(col) == type_Bool;
+    rows.for_each([&](size_t row) {
+        if (nullable && table.is_null(col, row))
+            func(row, util::none);
+        else if (is_bool)
+            func(row, util::Optional<int64_t>(table.get_bool(col, row)));
+        else
+            func(row, util::Optional<int64_t>(table.get_int(col, row)));
+    });
+}
+
+// Same as for_each_int() for float and double columns
+template <class T, class F>
+void for_each_float(const Table& table, size_t col, const TableRows& rows, F func)
+{
+    const Column<T>& floats = static_cast<const Column<T>&>(_impl::TableFriend::get_column(table, col));
+    bool nullable = table.is_nullable(col);
+    typename Column<T>::LeafType fallback(floats.get_alloc());
+    const typename Column<T>::LeafType* leaf = nullptr;
+    for (size_t row = rows.begin; row < rows.end;) {
+        size_t ndx_in_leaf;
+        typename Column<T>::LeafInfo leaf_info{&leaf, &fallback};
+        floats.get_leaf(row, ndx_in_leaf, leaf_info);
+        size_t leaf_end = std::min(leaf->size(), ndx_in_leaf + (rows.end - row));
+        for (; ndx_in_leaf < leaf_end; ++ndx_in_leaf, ++row) {
+            if (nullable && leaf->is_null(ndx_in_leaf))
+                func(row, util::Optional<T>());
+            else
+                func(row, util::Optional<T>(leaf->get(ndx_in_leaf)));
+        }
+    }
+}
+
+template <class T, class Rows, class F>
+void for_each_float(const Table& table, size_t col, const Rows& rows, F func)
+{
+    bool nullable = table.is_nullable(col);
+    rows.for_each([&](size_t row) {
+        if (nullable && table.is_null(col, row))
+            func(row, util::Optional<T>());
+        else
+            func(row, util::Optional<T>(table.get<T>(col, row)));
+    });
+}
+
+template <class T>
+void store(std::vector<uint8_t>& buffer, size_t ndx, T value)
+{
+    std::memcpy(buffer.data() + ndx * sizeof(T), &value, sizeof(T));
+}
+
+template <class T>
+T load(const std::vector<uint8_t>& buffer, size_t ndx)
+{
+    T value;
+    std::memcpy(&value, buffer.data() + ndx * sizeof(T), sizeof(T));
+    return value;
+}
+
+bool get_bit(const std::vector<uint8_t>& bitmap, size_t ndx)
+{
+    return (bitmap[ndx >> 3] >> (ndx & 7)) & 1;
+}
+
+void set_bit(std::vector<uint8_t>& bitmap, size_t ndx)
+{
+    bitmap[ndx >> 3] |= uint8_t(1 << (ndx & 7));
+}
+
+int64_t to_nanoseconds(Timestamp value)
+{
+    int64_t seconds = value.get_seconds();
+    int64_t nanoseconds = value.get_nanoseconds();
+    const int64_t max = std::numeric_limits<int64_t>::max();
+    const int64_t min = std::numeric_limits<int64_t>::min();
+    if (seconds > max / nanoseconds_per_second || seconds < min / nanoseconds_per_second)
+        throw std::out_of_range("Timestamp out of range of Arrow timestamps");
+    int64_t result = seconds * nanoseconds_per_second;
+    if ((nanoseconds > 0 && result > max - nanoseconds) || (nanoseconds < 0 && result < min - nanoseconds))
+        throw std::out_of_range("Timestamp out of range of Arrow timestamps");
+    return result + nanoseconds;
+}
+
+// Appends `data` to the data buffer of a string or binary column
+void add_bytes(ArrowColumn& column, const char* data, size_t size)
+{
+    size_t offset = column.data.size();
+    if (size > size_t(std::numeric_limits<int32_t>::max()) - offset)
+        throw std::out_of_range("Column data too large for an Arrow record batch");
+    column.data.insert(column.data.end(), data, data + size);
+    column.offsets.push_back(int32_t(offset + size));
+}
+
+template <class Rows>
+void export_column(const Table& table, size_t col, const Rows& rows, ArrowColumn& column)
+{
+    size_t length = rows.size();
+    column.name = table.get_column_name(col);
+    column.type = table.get_column_type(col);
+    column.nullable = table.is_nullable(col);
+    column.null_count = 0;
+    column.validity.assign((length + 7) / 8, 0);
+    column.offsets.clear();
+    column.data.clear();
+
+    size_t i = 0;
+    switch (column.type) {
+        case type_Int:
+            column.data.resize(length * sizeof(int64_t));
+            for_each_int(table, col, rows, [&](size_t, util::Optional<int64_t> value) {
+                if (value) {
+                    store<int64_t>(column.data, i, *value);
+                    set_bit(column.validity, i);
+                }
+                else {
+                    store<int64_t>(column.data, i, 0);
+                    ++column.null_count;
+                }
+                ++i;
+            });
+            break;
+        case type_Bool:
+            column.data.assign((length + 7) / 8, 0);
+            for_each_int(table, col, rows, [&](size_t, util::Optional<int64_t> value) {
+                if (value) {
+                    if (*value)
+                        set_bit(column.data, i);
+                    set_bit(column.validity, i);
+                }
+                else {
+                    ++column.null_count;
+                }
+                ++i;
+            });
+            break;
+        case type_Float:
+            column.data.resize(length * sizeof(float));
+            for_each_float<float>(table, col, rows, [&](size_t, util::Optional<float> value) {
+                store<float>(column.data, i, value ? *value : 0);
+                if (value)
+                    set_bit(column.validity, i);
+                else
+                    ++column.null_count;
+                ++i;
+            });
+            break;
+        case type_Double:
+            column.data.resize(length * sizeof(double));
+            for_each_float<double>(table, col, rows, [&](size_t, util::Optional<double> value) {
+                store<double>(column.data, i, value ? *value : 0);
+                if (value)
+                    set_bit(column.validity, i);
+                else
+                    ++column.null_count;
+                ++i;
+            });
+            break;
+        case type_String:
+            column.offsets.reserve(length + 1);
+            column.offsets.push_back(0);
+            rows.for_each([&](size_t row) {
+                StringData value = table.get_string(col, row);
+                add_bytes(column, value.data(), value.size()); // Throws
+                if (value.is_null())
+                    ++column.null_count;
+                else
+                    set_bit(column.validity, i);
+                ++i;
+            });
+            break;
+        case type_Binary:
+            column.offsets.reserve(length + 1);
+            column.offsets.push_back(0);
+            rows.for_each([&](size_t row) {
+                BinaryData value = table.get_binary(col, row);
+                add_bytes(column, value.data(), value.size()); // Throws
+                if (value.is_null())
+                    ++column.null_count;
+                else
+                    set_bit(column.validity, i);
+                ++i;
+            });
+            break;
+        case type_Timestamp:
+            column.data.resize(length * sizeof(int64_t));
+            rows.for_each([&](size_t row) {
+                Timestamp value = table.get_timestamp(col, row);
+                if (value.is_null()) {
+                    store<int64_t>(column.data, i, 0);
+                    ++column.null_count;
+                }
+                else {
+                    store<int64_t>(column.data, i, to_nanoseconds(value)); // Throws
+                    set_bit(column.validity, i);
+                }
+                ++i;
+            });
+            break;
+        case type_OldDateTime:
+            column.data.resize(length * sizeof(int64_t));
+            rows.for_each([&](size_t row) {
+                if (column.nullable && table.is_null(col, row)) {
+                    store<int64_t>(column.data, i, 0);
+                    ++column.null_count;
+                }
+                else {
+                    store<int64_t>(column.data, i, table.get_olddatetime(col, row).get_olddatetime());
+                    set_bit(column.validity, i);
+                }
+                ++i;
+            });
+            break;
+        case type_Table:
+        case type_Mixed:
+        case type_Link:
+        case type_LinkList:
+            throw LogicError(LogicError::illegal_type);
+    }
+    if (column.null_count == 0)
+        column.validity.clear();
+}
+
+template <class Rows>
+ArrowBatch export_rows(const Table& table, const Rows& rows)
+{
+    if (!table.is_attached())
+        throw LogicError(LogicError::detached_accessor);
+
+    ArrowBatch batch;
+    batch.length = rows.size();
+    batch.columns.resize(table.get_column_count());
+    for (size_t col = 0; col < batch.columns.size(); ++col)
+        export_column(table, col, rows, batch.columns[col]); // Throws
+    return batch;
+}
+
+
+// Builds a FlatBuffers (https://google.github.io/flatbuffers/) buffer from the
+// back, as the FlatBuffers library does, so that all offsets point forward.
+// Objects are identified by their position counted from the end of the
+// buffer. Only what the Arrow metadata needs is supported, and the host is
+// assumed to be little-endian.
+class FlatBufferBuilder {
+public:
+    using Ref = uint32_t;
+
+    Ref add_string(StringData str)
+    {
+        align(str.size() + 1, 4);
+        prepend("", 1);
+        prepend(str.data(), str.size());
+        return add_length(str.size());
+    }
+
+    // A vector of structs, which must have a size that is a multiple of 8
+    template <class T>
+    Ref add_structs(const std::vector<T>& structs)
+    {
+        static_assert(sizeof(T) % 8 == 0, "Unaligned struct");
+        size_t size = structs.size() * sizeof(T);
+        align(size, 8);
+        prepend(structs.data(), size);
+        return add_length(structs.size());
+    }
+
+    // A vector of tables or strings
+    Ref add_refs(const std::vector<Ref>& refs)
+    {
+        align(4 * refs.size(), 4);
+        for (size_t i = refs.size(); i > 0; --i) {
+            uint32_t offset = uint32_t(m_buffer.size() + 4 - refs[i - 1]);
+            prepend(&offset, 4);
+        }
+        return add_length(refs.size());
+    }
+
+    void start_table()
+    {
+        m_fields.clear();
+    }
+
+    template <class T>
+    void add_field(uint16_t id, T value)
+    {
+        Field field{id, sizeof(T), false, 0, 0};
+        std::memcpy(&field.value, &value, sizeof(T));
+        m_fields.push_back(field);
+    }
+
+    void add_ref_field(uint16_t id, Ref ref)
+    {
+        m_fields.push_back(Field{id, 4, true, ref, 0});
+    }
+
+    Ref end_table()
+    {
+        // The table starts with the offset of its vtable, followed by the
+        // fields, largest first, each aligned to its size
+        std::stable_sort(m_fields.begin(), m_fields.end(),
+                         [](const Field& a, const Field& b) { return a.size > b.size; });
+        size_t table_size = 4;
+        uint16_t field_count = 0;
+        for (Field& field : m_fields) {
+            table_size = (table_size + field.size - 1) / field.size * field.size;
+            field.offset = table_size;
+            table_size += field.size;
+            field_count = std::max(field_count, uint16_t(field.id + 1));
+        }
+        table_size = (table_size + 7) / 8 * 8;
+        align(table_size, 8);
+        Ref table_ref = Ref(m_buffer.size() + table_size);
+        std::string table(table_size, '\0');
+        for (const Field& field : m_fields) {
+            if (field.is_ref) {
+                uint32_t offset = uint32_t(table_ref - field.offset - field.value);
+                std::memcpy(&table[field.offset], &offset, 4);
+            }
+            else {
+                std::memcpy(&table[field.offset], &field.value, field.size);
+            }
+        }
+        prepend(table.data(), table_size);
+
+        std::vector<uint16_t> vtable(2 + field_count, 0);
+        vtable[0] = uint16_t(2 * vtable.size());
+        vtable[1] = uint16_t(table_size);
+        for (const Field& field : m_fields)
+            vtable[2 + field.id] = uint16_t(field.offset);
+        prepend(vtable.data(), 2 * vtable.size());
+        int32_t vtable_offset = int32_t(m_buffer.size() - table_ref);
+        std::memcpy(&m_buffer[m_buffer.size() - table_ref], &vtable_offset, 4);
+        return table_ref;
+    }
+
+    // The finished buffer, whose size is a multiple of 8
+    std::string finish(Ref root)
+    {
+        align(4, 8);
+        uint32_t offset = uint32_t(m_buffer.size() + 4 - root);
+        prepend(&offset, 4);
+        return std::move(m_buffer);
+    }
+
+private:
+    struct Field {
+        uint16_t id;
+        size_t size;
+        bool is_ref;
+        uint64_t value; // The value of a scalar, or the object referred to
+        size_t offset;  // Offset in table
+    };
+
+    std::string m_buffer;
+    std::vector<Field> m_fields;
+
+    void prepend(const void* data, size_t size)
+    {
+        m_buffer.insert(0, static_cast<const char*>(data), size);
+    }
+
+    // Pad so that `size` more bytes end at a multiple of `alignment`
+    void align(size_t size, size_t alignment)
+    {
+        size_t padding = (alignment - (m_buffer.size() + size) % alignment) % alignment;
+        m_buffer.insert(0, padding, '\0');
+    }
+
+    Ref add_length(size_t length)
+    {
+        uint32_t length_2 = uint32_t(length);
+        prepend(&length_2, 4);
+        return Ref(m_buffer.size());
+    }
+};
+
+REALM_NORETURN void bad_arrow_file()
+{
+    throw std::runtime_error("Invalid or unsupported Arrow file");
+}
+
+// A table in a FlatBuffers buffer. All reads are bounds-checked.
+class FlatTable {
+public:
+    FlatTable(const char* data, size_t size, size_t pos)
+        : m_data(data)
+        , m_size(size)
+        , m_pos(pos)
+    {
+        int64_t vtable = int64_t(pos) - read<int32_t>(pos);
+        if (vtable < 0 || size_t(vtable) + 4 > size)
+            bad_arrow_file();
+        m_vtable = size_t(vtable);
+        m_vtable_size = read<uint16_t>(m_vtable);
+    }
+
+    // The root table of a buffer
+    static FlatTable root(const char* data, size_t size)
+    {
+        uint32_t pos;
+        if (size < 4)
+            bad_arrow_file();
+        std::memcpy(&pos, data, 4);
+        if (pos >= size)
+            bad_arrow_file();
+        return FlatTable(data, size, pos);
+    }
+
+    template <class T>
+    T get(uint16_t id, T default_value) const
+    {
+        size_t pos = field_pos(id);
+        return pos ? read<T>(pos) : default_value;
+    }
+
+    bool has(uint16_t id) const
+    {
+        return field_pos(id) != 0;
+    }
+
+    FlatTable get_table(uint16_t id) const
+    {
+        size_t pos = field_pos(id);
+        if (!pos)
+            bad_arrow_file();
+        return FlatTable(m_data, m_size, follow(pos));
+    }
+
+    // The position of the first element of a vector of `element_size` byte
+    // elements, which is empty if it is missing
+    size_t get_vector(uint16_t id, size_t element_size, size_t& count) const
+    {
+        size_t pos = field_pos(id);
+        count = 0;
+        if (!pos)
+            return 0;
+        pos = follow(pos);
+        count = read<uint32_t>(pos);
+        if (count > (m_size - pos - 4) / element_size)
+            bad_arrow_file();
+        return pos + 4;
+    }
+
+    // Element `ndx` of a vector of tables
+    FlatTable get_table(size_t vector_pos, size_t ndx) const
+    {
+        return FlatTable(m_data, m_size, follow(vector_pos + 4 * ndx));
+    }
+
+    std::string get_string(uint16_t id) const
+    {
+        size_t size;
+        size_t pos = get_vector(id, 1, size);
+        return std::string(m_data + pos, size);
+    }
+
+    template <class T>
+    T read(size_t pos) const
+    {
+        if (pos > m_size || m_size - pos < sizeof(T))
+            bad_arrow_file();
+        T value;
+        std::memcpy(&value, m_data + pos, sizeof(T));
+        return value;
+    }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos;
+    size_t m_vtable;
+    size_t m_vtable_size;
+
+    size_t field_pos(uint16_t id) const
+    {
+        size_t entry = 4 + 2 * size_t(id);
+        if (entry + 2 > m_vtable_size)
+            return 0;
+        uint16_t offset = read<uint16_t>(m_vtable + entry);
+        return offset ? m_pos + offset : 0;
+    }
+
+    size_t follow(size_t pos) const
+    {
+        size_t target = pos + read<uint32_t>(pos);
+        if (target >= m_size)
+            bad_arrow_file();
+        return target;
+    }
+};
+
+
+// Identifiers and constants of the Arrow metadata, see Schema.fbs, Message.fbs
+// and File.fbs in the Arrow repository
+const int16_t metadata_version = 4; // V5
+const uint8_t header_Schema = 1;
+const uint8_t header_RecordBatch = 3;
+const uint8_t type_ArrowInt = 2;
+const uint8_t type_ArrowFloatingPoint = 3;
+const uint8_t type_ArrowBinary = 4;
+const uint8_t type_ArrowUtf8 = 5;
+const uint8_t type_ArrowBool = 6;
+const uint8_t type_ArrowTimestamp = 10;
+const int16_t precision_Single = 1;
+const int16_t precision_Double = 2;
+const int16_t unit_Second = 0;
+const int16_t unit_Nanosecond = 3;
+const char arrow_magic[] = "ARROW1";
+
+struct FieldNode {
+    int64_t length;
+    int64_t null_count;
+};
+
+struct BufferSpec {
+    int64_t offset;
+    int64_t length;
+};
+
+struct Block {
+    int64_t offset;
+    int32_t metadata_length;
+    int32_t padding;
+    int64_t body_length;
+};
+
+struct ColumnSpec {
+    std::string name;
+    DataType type;
+    bool nullable;
+};
+
+FlatBufferBuilder::Ref add_schema(FlatBufferBuilder& builder, const std::vector<ColumnSpec>& columns)
+{
+    using Ref = FlatBufferBuilder::Ref;
+    std::vector<Ref> fields;
+    for (const ColumnSpec& column : columns) {
+        Ref name = builder.add_string(column.name);
+        Ref children = builder.add_refs({});
+        Ref timezone = 0;
+        if (column.type == type_Timestamp || column.type == type_OldDateTime)
+            timezone = builder.add_string("UTC");
+
+        uint8_t type_id = 0;
+        builder.start_table();
+        switch (column.type) {
+            case type_Int:
+                type_id = type_ArrowInt;
+                builder.add_field<int32_t>(0, 64);  // bitWidth
+                builder.add_field<uint8_t>(1, 1);   // is_signed
+                break;
+            case type_Bool:
+                type_id = type_ArrowBool;
+                break;
+            case type_Float:
+                type_id = type_ArrowFloatingPoint;
+                builder.add_field<int16_t>(0, precision_Single);
+                break;
+            case type_Double:
+                type_id = type_ArrowFloatingPoint;
+                builder.add_field<int16_t>(0, precision_Double);
+                break;
+            case type_String:
+                type_id = type_ArrowUtf8;
+                break;
+            case type_Binary:
+                type_id = type_ArrowBinary;
+                break;
+            case type_Timestamp:
+            case type_OldDateTime:
+                type_id = type_ArrowTimestamp;
+                builder.add_field<int16_t>(0, column.type == type_Timestamp ? unit_Nanosecond : unit_Second);
+                builder.add_ref_field(1, timezone);
+                break;
+            default:
+                REALM_ASSERT(false);
+        }
+        Ref type = builder.end_table();
+
+        builder.start_table();
+        builder.add_ref_field(0, name);
+        builder.add_field<uint8_t>(1, column.nullable ? 1 : 0);
+        builder.add_field<uint8_t>(2, type_id);
+        builder.add_ref_field(3, type);
+        builder.add_ref_field(5, children);
+        fields.push_back(builder.end_table());
+    }
+    Ref fields_ref = builder.add_refs(fields);
+    builder.start_table();
+    builder.add_ref_field(1, fields_ref);
+    return builder.end_table();
+}
+
+std::vector<ColumnSpec> read_schema(const FlatTable& schema)
+{
+    std::vector<ColumnSpec> columns;
+    size_t count;
+    size_t fields = schema.get_vector(1, 4, count);
+    for (size_t i = 0; i < count; ++i) {
+        FlatTable field = schema.get_table(fields, i);
+        ColumnSpec column;
+        column.name = field.get_string(0);
+        column.nullable = field.get<uint8_t>(1, 0) != 0;
+        if (field.has(4))
+            bad_arrow_file(); // Dictionary encoded
+        FlatTable type = field.get_table(3);
+        switch (field.get<uint8_t>(2, 0)) {
+            case type_ArrowInt:
+                if (type.get<int32_t>(0, 0) != 64 || !type.get<uint8_t>(1, 0))
+                    bad_arrow_file();
+                column.type = type_Int;
+                break;
+            case type_ArrowBool:
+                column.type = type_Bool;
+                break;
+            case type_ArrowFloatingPoint: {
+                int16_t precision = type.get<int16_t>(0, 0);
+                if (precision != precision_Single && precision != precision_Double)
+                    bad_arrow_file();
+                column.type = precision == precision_Single ? type_Float : type_Double;
+                break;
+            }
+            case type_ArrowUtf8:
+                column.type = type_String;
+                break;
+            case type_ArrowBinary:
+                column.type = type_Binary;
+                break;
+            case type_ArrowTimestamp: {
+                int16_t unit = type.get<int16_t>(0, 0);
+                if (unit != unit_Second && unit != unit_Nanosecond)
+                    bad_arrow_file();
+                column.type = unit == unit_Second ? type_OldDateTime : type_Timestamp;
+                break;
+            }
+            default:
+                bad_arrow_file();
+        }
+        columns.push_back(std::move(column));
+    }
+    return columns;
+}
+
+std::vector<ColumnSpec> get_columns(const ArrowBatch& batch)
+{
+    std::vector<ColumnSpec> columns;
+    for (const ArrowColumn& column : batch.columns)
+        columns.push_back(ColumnSpec{column.name, column.type, column.nullable});
+    return columns;
+}
+
+// Writes the parts of an Arrow IPC file
+class ArrowWriter {
+public:
+    ArrowWriter(std::ostream& out)
+        : m_out(out)
+    {
+    }
+
+    void write_header(const std::vector<ColumnSpec>& columns)
+    {
+        m_columns = columns;
+        write(arrow_magic, 6);
+        write_padding(2);
+        FlatBufferBuilder builder;
+        FlatBufferBuilder::Ref schema = add_schema(builder, columns);
+        write_message(builder, header_Schema, schema, 0);
+    }
+
+    void write_batch(const ArrowBatch& batch)
+    {
+        // The buffers of the body, each padded to a multiple of 8 bytes
+        std::vector<FieldNode> nodes;
+        std::vector<BufferSpec> buffers;
+        int64_t body_length = 0;
+        auto add_buffer = [&](size_t size) {
+            buffers.push_back(BufferSpec{body_length, int64_t(size)});
+            body_length += int64_t((size + 7) / 8 * 8);
+        };
+        for (const ArrowColumn& column : batch.columns) {
+            nodes.push_back(FieldNode{int64_t(batch.length), int64_t(column.null_count)});
+            add_buffer(column.validity.size());
+            if (column.type == type_String || column.type == type_Binary)
+                add_buffer(column.offsets.size() * sizeof(int32_t));
+            add_buffer(column.data.size());
+        }
+
+        FlatBufferBuilder builder;
+        FlatBufferBuilder::Ref nodes_ref = builder.add_structs(nodes);
+        FlatBufferBuilder::Ref buffers_ref = builder.add_structs(buffers);
+        builder.start_table();
+        builder.add_field<int64_t>(0, int64_t(batch.length));
+        builder.add_ref_field(1, nodes_ref);
+        builder.add_ref_field(2, buffers_ref);
+        FlatBufferBuilder::Ref record_batch = builder.end_table();
+
+        Block block;
+        block.offset = m_pos;
+        block.padding = 0;
+        block.metadata_length = int32_t(write_message(builder, header_RecordBatch, record_batch, body_length));
+        block.body_length = body_length;
+        for (const ArrowColumn& column : batch.columns) {
+            write_buffer(column.validity.data(), column.validity.size());
+            if (column.type == type_String || column.type == type_Binary)
+                write_buffer(column.offsets.data(), column.offsets.size() * sizeof(int32_t));
+            write_buffer(column.data.data(), column.data.size());
+        }
+        m_blocks.push_back(block);
+    }
+
+    void write_footer()
+    {
+        // End-of-stream marker
+        int32_t end_of_stream[2] = {-1, 0};
+        write(end_of_stream, 8);
+
+        FlatBufferBuilder builder;
+        FlatBufferBuilder::Ref blocks = builder.add_structs(m_blocks);
+        FlatBufferBuilder::Ref schema = add_schema(builder, m_columns);
+        builder.start_table();
+        builder.add_field<int16_t>(0, metadata_version);
+        builder.add_ref_field(1, schema);
+        builder.add_ref_field(3, blocks);
+        std::string footer = builder.finish(builder.end_table());
+        write(footer.data(), footer.size());
+        int32_t footer_size = int32_t(footer.size());
+        write(&footer_size, 4);
+        write(arrow_magic, 6);
+    }
+
+private:
+    std::ostream& m_out;
+    int64_t m_pos = 0;
+    std::vector<ColumnSpec> m_columns;
+    std::vector<Block> m_blocks;
+
+    void write(const void* data, size_t size)
+    {
+        m_out.write(static_cast<const char*>(data), std::streamsize(size));
+        m_pos += int64_t(size);
+    }
+
+    void write_padding(size_t size)
+    {
+        const char zeros[8] = {};
+        write(zeros, size);
+    }
+
+    void write_buffer(const void* data, size_t size)
+    {
+        write(data, size);
+        write_padding((8 - size % 8) % 8);
+    }
+
+    // Returns the size of the message before the body
+    size_t write_message(FlatBufferBuilder& builder, uint8_t header_type, FlatBufferBuilder::Ref header,
+                         int64_t body_length)
+    {
+        builder.start_table();
+        builder.add_field<int16_t>(0, metadata_version);
+        builder.add_field<uint8_t>(1, header_type);
+        builder.add_ref_field(2, header);
+        builder.add_field<int64_t>(3, body_length);
+        std::string message = builder.finish(builder.end_table());
+        int32_t prefix[2] = {-1, int32_t(message.size())}; // Continuation marker and size
+        write(prefix, 8);
+        write(message.data(), message.size());
+        return 8 + message.size();
+    }
+};
+
+template <class Batches>
+void write_batches(const Table& table, const Batches& batches, std::ostream& out, size_t batch_size)
+{
+    ArrowWriter writer(out);
+    writer.write_header(get_columns(export_rows(table, TableRows{0, 0}))); // Throws
+    batch_size = std::max(batch_size, size_t(1));
+    batches.for_each_batch(batch_size, [&](const ArrowBatch& batch) {
+        writer.write_batch(batch); // Throws
+    });
+    writer.write_footer(); // Throws
+}
+
+// Splits rows into batches for write_batches()
+struct TableBatches {
+    const Table& table;
+
+    template <class F>
+    void for_each_batch(size_t batch_size, F func) const
+    {
+        for (size_t begin = 0; begin < table.size(); begin += batch_size)
+            func(export_rows(table, TableRows{begin, std::min(begin + batch_size, table.size())})); // Throws
+    }
+};
+
+struct ViewBatches {
+    const Table& table;
+    const TableViewBase& view;
+
+    template <class F>
+    void for_each_batch(size_t batch_size, F func) const
+    {
+        size_t begin = 0;
+        while (begin < view.size()) {
+            size_t end = begin;
+            size_t count = 0;
+            while (end < view.size() && count < batch_size) {
+                if (view.is_row_attached(end))
+                    ++count;
+                ++end;
+            }
+            func(export_rows(table, ViewRows{view, begin, end, count})); // Throws
+            begin = end;
+        }
+    }
+};
+
+} // anonymous namespace
+
+
+ArrowBatch realm::export_arrow(const Table& table, size_t begin, size_t end)
+{
+    end = std::min(end, table.size());
+    if (begin > end)
+        throw LogicError(LogicError::row_index_out_of_range);
+    return export_rows(table, TableRows{begin, end}); // Throws
+}
+
+ArrowBatch realm::export_arrow(const TableView& view)
+{
+    view.sync_if_needed();
+    return export_rows(view.get_parent(), ViewRows{view, 0, view.size(), view.num_attached_rows()}); // Throws
+}
+
+ArrowBatch realm::export_arrow(const ConstTableView& view)
+{
+    view.sync_if_needed();
+    return export_rows(view.get_parent(), ViewRows{view, 0, view.size(), view.num_attached_rows()}); // Throws
+}
+
+void realm::import_arrow(const ArrowBatch& batch, Table& table)
+{
+    if (!table.is_attached())
+        throw LogicError(LogicError::detached_accessor);
+
+    size_t column_count = batch.columns.size();
+    if (table.get_column_count() == 0) {
+        for (const ArrowColumn& column : batch.columns)
+            table.add_column(column.type, column.name, column.nullable); // Throws
+    }
+    if (table.get_column_count() != column_count)
+        throw LogicError(LogicError::type_mismatch);
+    for (size_t col = 0; col < column_count; ++col) {
+        const ArrowColumn& column = batch.columns[col];
+        if (table.get_column_type(col) != column.type)
+            throw LogicError(LogicError::type_mismatch);
+        if (column.null_count > 0 && !table.is_nullable(col))
+            throw LogicError(LogicError::column_not_nullable);
+    }
+
+    // The new rows are null in nullable columns, and only the values that are
+    // not null are set, column by column
+    size_t first_row = table.size();
+    table.add_empty_row(batch.length); // Throws
+    for (size_t col = 0; col < column_count; ++col) {
+        const ArrowColumn& column = batch.columns[col];
+        bool has_nulls = column.null_count > 0;
+        for (size_t i = 0; i < batch.length; ++i) {
+            if (has_nulls && !get_bit(column.validity, i))
+                continue;
+            size_t row = first_row + i;
+            switch (column.type) {
+                case type_Int:
+                    table.set_int(col, row, load<int64_t>(column.data, i)); // Throws
+                    break;
+                case type_Bool:
+                    table.set_bool(col, row, get_bit(column.data, i)); // Throws
+                    break;
+                case type_Float:
+                    table.set_float(col, row, load<float>(column.data, i)); // Throws
+                    break;
+                case type_Double:
+                    table.set_double(col, row, load<double>(column.data, i)); // Throws
+                    break;
+                case type_String:
+                case type_Binary: {
+                    // A null data pointer would make an empty value null
+                    size_t begin = size_t(column.offsets[i]);
+                    size_t size = size_t(column.offsets[i + 1]) - begin;
+                    const char* data = size ? reinterpret_cast<const char*>(column.data.data()) + begin : "";
+                    if (column.type == type_String)
+                        table.set_string(col, row, StringData(data, size)); // Throws
+                    else
+                        table.set_binary(col, row, BinaryData(data, size)); // Throws
+                    break;
+                }
+                case type_Timestamp: {
+                    int64_t nanoseconds = load<int64_t>(column.data, i);
+                    Timestamp value(nanoseconds / nanoseconds_per_second,
+                                    int32_t(nanoseconds % nanoseconds_per_second));
+                    table.set_timestamp(col, row, value); // Throws
+                    break;
+                }
+                case type_OldDateTime:
+                    table.set_olddatetime(col, row, OldDateTime(load<int64_t>(column.data, i))); // Throws
+                    break;
+                case type_Table:
+                case type_Mixed:
+                case type_Link:
+                case type_LinkList:
+                    throw LogicError(LogicError::illegal_type);
+            }
+        }
+    }
+}
+
+void realm::write_arrow(const Table& table, std::ostream& out, size_t batch_size)
+{
+    write_batches(table, TableBatches{table}, out, batch_size); // Throws
+}
+
+void realm::write_arrow(const TableView& view, std::ostream& out, size_t batch_size)
+{
+    view.sync_if_needed();
+    write_batches(view.get_parent(), ViewBatches{view.get_parent(), view}, out, batch_size); // Throws
+}
+
+void realm::write_arrow(const ConstTableView& view, std::ostream& out, size_t batch_size)
+{
+    view.sync_if_needed();
+    write_batches(view.get_parent(), ViewBatches{view.get_parent(), view}, out, batch_size); // Throws
+}
+
+size_t realm::read_arrow(std::istream& in, Table& table)
+{
+    std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const char* data = file.data();
+    size_t size = file.size();
+    if (size < 18 || std::memcmp(data, arrow_magic, 6) != 0 || std::memcmp(data + size - 6, arrow_magic, 6) != 0)
+        bad_arrow_file();
+
+    int32_t footer_size;
+    std::memcpy(&footer_size, data + size - 10, 4);
+    if (footer_size <= 0 || size_t(footer_size) > size - 18)
+        bad_arrow_file();
+    const char* footer_data = data + size - 10 - footer_size;
+    FlatTable footer = FlatTable::root(footer_data, size_t(footer_size));
+    std::vector<ColumnSpec> columns = read_schema(footer.get_table(1));
+
+    size_t block_count;
+    size_t blocks = footer.get_vector(3, sizeof(Block), block_count);
+    size_t row_count = 0;
+    for (size_t b = 0; b < block_count; ++b) {
+        Block block = footer.read<Block>(blocks + b * sizeof(Block));
+        if (block.offset < 8 || block.metadata_length < 8 || block.body_length < 0 ||
+            uint64_t(block.offset) + uint64_t(block.metadata_length) + uint64_t(block.body_length) > size)
+            bad_arrow_file();
+
+        // The message may be preceded by a continuation marker
+        const char* message_data = data + block.offset;
+        size_t message_size = size_t(block.metadata_length);
+        int32_t marker;
+        std::memcpy(&marker, message_data, 4);
+        size_t skip = marker == -1 ? 8 : 4;
+        FlatTable message = FlatTable::root(message_data + skip, message_size - skip);
+        if (message.get<uint8_t>(1, 0) != header_RecordBatch)
+            bad_arrow_file();
+        FlatTable record_batch = message.get_table(2);
+        if (record_batch.has(3))
+            bad_arrow_file(); // Compressed
+
+        int64_t length = record_batch.get<int64_t>(0, 0);
+        size_t node_count, buffer_count;
+        size_t nodes = record_batch.get_vector(1, sizeof(FieldNode), node_count);
+        size_t buffers = record_batch.get_vector(2, sizeof(BufferSpec), buffer_count);
+        if (length < 0 || node_count != columns.size())
+            bad_arrow_file();
+
+        const char* body = message_data + message_size;
+        size_t body_size = size_t(block.body_length);
+        size_t buffer_ndx = 0;
+        auto get_buffer = [&](std::vector<uint8_t>& buffer, size_t min_size) {
+            if (buffer_ndx == buffer_count)
+                bad_arrow_file();
+            BufferSpec spec = record_batch.read<BufferSpec>(buffers + buffer_ndx++ * sizeof(BufferSpec));
+            if (spec.offset < 0 || spec.length < 0 || uint64_t(spec.offset) + uint64_t(spec.length) > body_size ||
+                size_t(spec.length) < min_size)
+                bad_arrow_file();
+            buffer.assign(body + spec.offset, body + spec.offset + min_size);
+        };
+
+        ArrowBatch batch;
+        batch.length = size_t(length);
+        batch.columns.resize(columns.size());
+        for (size_t col = 0; col < columns.size(); ++col) {
+            ArrowColumn& column = batch.columns[col];
+            FieldNode node = record_batch.read<FieldNode>(nodes + col * sizeof(FieldNode));
+            if (node.length != length || node.null_count < 0 || node.null_count > length)
+                bad_arrow_file();
+            column.name = columns[col].name;
+            column.type = columns[col].type;
+            column.nullable = columns[col].nullable;
+            column.null_count = size_t(node.null_count);
+            size_t bitmap_size = (batch.length + 7) / 8;
+            get_buffer(column.validity, column.null_count ? bitmap_size : 0);
+
+            switch (column.type) {
+                case type_String:
+                case type_Binary: {
+                    std::vector<uint8_t> offsets;
+                    get_buffer(offsets, (batch.length + 1) * sizeof(int32_t));
+                    column.offsets.resize(batch.length + 1);
+                    std::memcpy(column.offsets.data(), offsets.data(), offsets.size());
+                    for (size_t i = 0; i < batch.length; ++i) {
+                        if (column.offsets[i] < 0 || column.offsets[i] > column.offsets[i + 1])
+                            bad_arrow_file();
+                    }
+                    get_buffer(column.data, size_t(column.offsets[batch.length]));
+                    break;
+                }
+                case type_Bool:
+                    get_buffer(column.data, bitmap_size);
+                    break;
+                case type_Float:
+                    get_buffer(column.data, batch.length * sizeof(float));
+                    break;
+                default:
+                    get_buffer(column.data, batch.length * 8);
+                    break;
+            }
+        }
+        import_arrow(batch, table); // Throws
+        row_count += batch.length;
+    }
+    return row_count;
+}
@@ -0,0 +1,105 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_ARROW_HPP
+#define REALM_ARROW_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <realm/data_type.hpp>
+#include <realm/util/features.h>
+
+namespace realm {
+
+class Table;
+class TableView;
+class ConstTableView;
+
+/// The values of one column in the memory layout of Apache Arrow
+/// (https://arrow.apache.org/docs/format/Columnar.html). The Arrow type
+/// follows from the Realm type:
+///
+///     Realm type        Arrow type         Buffers
+///     -------------------------------------------------------------------
+///     type_Int          int64              validity, data
+///     type_Bool         bool               validity, data (one bit per value)
+///     type_Float        float32            validity, data
+///     type_Double       float64            validity, data
+///     type_String       utf8               validity, offsets, data
+///     type_Binary       binary             validity, offsets, data
+///     type_Timestamp    timestamp[ns, UTC] validity, data
+///     type_OldDateTime  timestamp[s, UTC]  validity, data
+///
+/// Bit `i` of the validity bitmap, counting from the least significant bit of
+/// the first byte, is set if value `i` is not null. The bitmap is empty if
+/// there are no nulls. Value `i` of a string or binary column is the bytes
+/// from `offsets[i]` to `offsets[i + 1]` in `data`.
+struct ArrowColumn {
+    std::string name;
+    DataType type;
+    bool nullable;
+    size_t null_count;
+    std::vector<uint8_t> validity;
+    std::vector<int32_t> offsets;
+    std::vector<uint8_t> data;
+};
+
+/// A number of rows of a table in the memory layout of Apache Arrow, that is,
+/// an Arrow record batch.
+struct ArrowBatch {
+    size_t length;
+    std::vector<ArrowColumn> columns;
+};
+
+/// Copy rows `begin` to `end` of `table`, or the rows of `view` that are
+/// still attached, into the Arrow memory layout. Throws
+/// LogicError::illegal_type if the table has link, link list, subtable or
+/// mixed columns, and std::out_of_range if a timestamp cannot be represented
+/// as 64-bit nanoseconds since the epoch, or if the strings or binaries of a
+/// column exceed 2 GiB.
+ArrowBatch export_arrow(const Table& table, size_t begin = 0, size_t end = size_t(-1));
+ArrowBatch export_arrow(const TableView& view);
+ArrowBatch export_arrow(const ConstTableView& view);
+
+/// Append the rows of `batch` to `table`. If `table` has no columns, columns
+/// with the names, types and nullability of those of the batch are added
+/// first. Otherwise, the column types must match, or LogicError::type_mismatch
+/// is thrown.
+void import_arrow(const ArrowBatch& batch, Table& table);
+
+/// Write all rows of `table` or `view` to `out` as an Arrow IPC file
+/// (https://arrow.apache.org/docs/format/Columnar.html#ipc-file-format) with a
+/// record batch for every `batch_size` rows. The file is written without the
+/// Arrow library, and in little-endian byte order.
+void write_arrow(const Table& table, std::ostream& out, size_t batch_size = 65536);
+void write_arrow(const TableView& view, std::ostream& out, size_t batch_size = 65536);
+void write_arrow(const ConstTableView& view, std::ostream& out, size_t batch_size = 65536);
+
+/// Append the rows of an Arrow IPC file to `table`, see import_arrow(), and
+/// return the number of rows appended. Only the Arrow types listed for
+/// ArrowColumn are supported, without dictionaries or compression. Throws
+/// std::runtime_error if the file cannot be read.
+size_t read_arrow(std::istream& in, Table& table);
+
+} // namespace realm
+
+#endif // REALM_ARROW_HPP
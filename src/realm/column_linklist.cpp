@@ -306,6 +306,37 @@ void LinkListColumn::cascade_break_backlinks_to_all_rows__leaf(const Array& link
 }
 
 
+void LinkListColumn::get_target_rows(size_t row_ndx, std::vector<size_t>& target_rows) const
+{
+    // Avoid the construction of both a LinkView and a IntegerColumn instance,
+    // since both would involve heap allocations.
+    ref_type ref = get_as_ref(row_ndx);
+    if (ref == 0)
+        return;
+    BpTreeNode root(get_alloc());
+    root.init_from_ref(ref);
+
+    if (!root.is_inner_bptree_node()) {
+        size_t num_links = root.size();
+        for (size_t i = 0; i < num_links; ++i)
+            target_rows.push_back(to_size_t(root.get(i)));
+        return;
+    }
+
+    Array leaf(get_alloc());
+    size_t link_ndx = 0;
+    size_t num_links = root.get_bptree_size();
+    while (link_ndx < num_links) {
+        std::pair<MemRef, size_t> p = root.get_bptree_leaf(link_ndx);
+        leaf.init_from_mem(p.first);
+        size_t leaf_size = leaf.size();
+        for (size_t i = 0; i < leaf_size; ++i)
+            target_rows.push_back(to_size_t(leaf.get(i)));
+        link_ndx += leaf_size;
+    }
+}
+
+
 bool LinkListColumn::compare_link_list(const LinkListColumn& c) const
 {
     size_t n = size();
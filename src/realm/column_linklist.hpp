@@ -58,6 +58,11 @@ public:
     ConstLinkViewRef get(size_t row_ndx) const;
     LinkViewRef get(size_t row_ndx);
 
+    /// Append the target row indexes of the link list at \a row_ndx to \a
+    /// target_rows. Unlike get(), this reads the list directly and does not
+    /// instantiate or register a LinkView accessor.
+    void get_target_rows(size_t row_ndx, std::vector<size_t>& target_rows) const;
+
     bool is_null(size_t row_ndx) const noexcept final;
     void set_null(size_t row_ndx) final;
 
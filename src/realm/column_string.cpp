@@ -38,6 +38,15 @@ namespace {
 const size_t small_string_max_size = 15;  // ArrayString
 const size_t medium_string_max_size = 63; // ArrayStringLong
 
+// A compressed medium strings leaf can hold strings of any size, as long as
+// its dictionary has room for them.
+bool fits_in_medium_leaf(const ArrayStringLong& leaf, StringData value) noexcept
+{
+    if (leaf.is_compressed())
+        return leaf.can_store_compressed(value);
+    return value.size() <= medium_string_max_size;
+}
+
 void copy_leaf(const ArrayString& from, ArrayStringLong& to)
 {
     size_t n = from.size();
@@ -330,7 +339,7 @@ public:
             ArrayStringLong leaf(m_alloc, m_nullable);
             leaf.init_from_mem(mem);
             leaf.set_parent(parent, ndx_in_parent);
-            if (m_value.size() <= medium_string_max_size) {
+            if (fits_in_medium_leaf(leaf, m_value)) {
                 leaf.set(elem_ndx_in_leaf, m_value); // Throws
                 return;
             }
@@ -393,7 +402,7 @@ void StringColumn::set(size_t ndx, StringData value)
 
     bool array_root_is_leaf = !m_array->is_inner_bptree_node();
     if (array_root_is_leaf) {
-        LeafType leaf_type = upgrade_root_leaf(value.size()); // Throws
+        LeafType leaf_type = upgrade_root_leaf(value); // Throws
         switch (leaf_type) {
             case leaf_type_Small: {
                 ArrayString* leaf = static_cast<ArrayString*>(m_array.get());
@@ -1064,6 +1073,110 @@ bool StringColumn::auto_enumerate(ref_type& keys_ref, ref_type& values_ref, bool
 }
 
 
+namespace {
+
+// Build a compressed copy of the specified medium or big strings leaf. Returns
+// a null MemRef if the leaf is already compressed, if it has too few
+// duplicates to make compression worthwhile, or if its dictionary would grow
+// too big.
+MemRef compress_long_strings_leaf(MemRef leaf_mem, Allocator& alloc, bool nullable)
+{
+    bool is_big = Array::get_context_flag_from_header(leaf_mem.get_addr());
+    ArrayStringLong medium_leaf(alloc, nullable);
+    ArrayBigBlobs big_leaf(alloc, nullable);
+    size_t n;
+    if (is_big) {
+        big_leaf.init_from_mem(leaf_mem);
+        n = big_leaf.size();
+    }
+    else {
+        medium_leaf.init_from_mem(leaf_mem);
+        if (medium_leaf.is_compressed())
+            return MemRef();
+        n = medium_leaf.size();
+    }
+
+    ArrayStringLong new_leaf(alloc, nullable);
+    _impl::DeepArrayDestroyGuard dg(&new_leaf);
+    bool compressed = true;
+    new_leaf.create(compressed); // Throws
+    for (size_t i = 0; i != n; ++i) {
+        StringData value = is_big ? big_leaf.get_string(i) : medium_leaf.get(i);
+        if (!new_leaf.can_store_compressed(value))
+            return MemRef();
+        new_leaf.add(value); // Throws
+
+        // Don't bother compressing if there are too few duplicates
+        if (n / 2 < new_leaf.get_dictionary_size())
+            return MemRef();
+    }
+    dg.release();
+    return new_leaf.get_mem();
+}
+
+class CompressLeaf : public BpTreeNode::UpdateHandler {
+public:
+    bool m_compressed_any = false;
+
+    CompressLeaf(Allocator& alloc, bool nullable) noexcept
+        : m_alloc(alloc)
+        , m_nullable(nullable)
+    {
+    }
+
+    void update(MemRef mem, ArrayParent* parent, size_t ndx_in_parent, size_t) override
+    {
+        bool long_strings = Array::get_hasrefs_from_header(mem.get_addr());
+        if (!long_strings)
+            return;
+        MemRef new_mem = compress_long_strings_leaf(mem, m_alloc, m_nullable); // Throws
+        if (!new_mem.get_addr())
+            return;
+        ArrayStringLong new_leaf(m_alloc, m_nullable);
+        new_leaf.init_from_mem(new_mem);
+        new_leaf.set_parent(parent, ndx_in_parent);
+        new_leaf.update_parent(); // Throws
+        Array::destroy_deep(mem, m_alloc);
+        m_compressed_any = true;
+    }
+
+private:
+    Allocator& m_alloc;
+    bool m_nullable;
+};
+
+} // anonymous namespace
+
+
+bool StringColumn::compress_leaves()
+{
+    Allocator& alloc = m_array->get_alloc();
+    if (alloc.get_file_format_version() < 7)
+        return false;
+
+    if (!root_is_leaf()) {
+        CompressLeaf handler(alloc, m_nullable);
+        static_cast<BpTreeNode*>(m_array.get())->update_bptree_leaves(handler); // Throws
+        return handler.m_compressed_any;
+    }
+
+    bool long_strings = m_array->has_refs();
+    if (!long_strings)
+        return false;
+    MemRef new_mem = compress_long_strings_leaf(m_array->get_mem(), alloc, m_nullable); // Throws
+    if (!new_mem.get_addr())
+        return false;
+    std::unique_ptr<ArrayStringLong> new_leaf;
+    new_leaf.reset(new ArrayStringLong(alloc, m_nullable)); // Throws
+    new_leaf->init_from_mem(new_mem);
+    new_leaf->set_parent(m_array->get_parent(), m_array->get_ndx_in_parent());
+    new_leaf->update_parent(); // Throws
+    m_array->destroy_deep();
+    m_array = std::move(new_leaf);
+    return true;
+}
+
+
 bool StringColumn::compare_string(const StringColumn& c) const
 {
     size_t n = size();
@@ -1110,7 +1223,7 @@ void StringColumn::bptree_insert(size_t row_ndx, StringData value, size_t num_ro
         size_t row_ndx_2 = row_ndx == realm::npos ? realm::npos : row_ndx + i;
         if (root_is_leaf()) {
             REALM_ASSERT(row_ndx_2 == realm::npos || row_ndx_2 < REALM_MAX_BPNODE_SIZE);
-            LeafType leaf_type = upgrade_root_leaf(value.size()); // Throws
+            LeafType leaf_type = upgrade_root_leaf(value); // Throws
             switch (leaf_type) {
                 case leaf_type_Small: {
                     // Small strings root leaf
@@ -1168,7 +1281,7 @@ ref_type StringColumn::leaf_insert(MemRef leaf_mem, ArrayParent& parent, size_t
         ArrayStringLong leaf(alloc, state.m_nullable);
         leaf.init_from_mem(leaf_mem);
         leaf.set_parent(&parent, ndx_in_parent);
-        if (state.m_value.size() <= medium_string_max_size)
+        if (fits_in_medium_leaf(leaf, state.m_value))
             return leaf.bptree_leaf_insert(insert_ndx, state.m_value, state); // Throws
         // Upgrade leaf from medium to big strings
         ArrayBigBlobs new_leaf(alloc, state.m_nullable);
@@ -1205,19 +1318,20 @@ ref_type StringColumn::leaf_insert(MemRef leaf_mem, ArrayParent& parent, size_t
 }
 
 
-StringColumn::LeafType StringColumn::upgrade_root_leaf(size_t value_size)
+StringColumn::LeafType StringColumn::upgrade_root_leaf(StringData value)
 {
     REALM_ASSERT(root_is_leaf());
 
+    size_t value_size = value.size();
     bool long_strings = m_array->has_refs();
     if (long_strings) {
         bool is_big = m_array->get_context_flag();
         if (is_big)
             return leaf_type_Big;
-        if (value_size <= medium_string_max_size)
+        ArrayStringLong* leaf = static_cast<ArrayStringLong*>(m_array.get());
+        if (fits_in_medium_leaf(*leaf, value))
             return leaf_type_Medium;
         // Upgrade root leaf from medium to big strings
-        ArrayStringLong* leaf = static_cast<ArrayStringLong*>(m_array.get());
         std::unique_ptr<ArrayBigBlobs> new_leaf;
         ArrayParent* parent = leaf->get_parent();
         size_t ndx_in_parent = leaf->get_ndx_in_parent();
@@ -111,6 +111,13 @@ public:
     // enforce == false will auto-evaluate if it should be enumerated or not
     bool auto_enumerate(ref_type& keys, ref_type& values, bool enforce = false) const;
 
+    /// Convert leaves of medium and big strings that contain many duplicates
+    /// to compressed form (see ArrayStringLong). Returns true if, and only if
+    /// at least one leaf was converted. Nothing is converted unless the file
+    /// format version of the allocator is at least 7, since earlier versions
+    /// cannot represent compressed leaves.
+    bool compress_leaves();
+
     /// Compare two string columns for equality.
     bool compare_string(const StringColumn&) const;
 
@@ -182,7 +189,7 @@ private:
     /// Root must be a leaf. Upgrades the root leaf as
     /// necessary. Returns the type of the root leaf as it is upon
     /// return.
-    LeafType upgrade_root_leaf(size_t value_size);
+    LeafType upgrade_root_leaf(StringData value);
 
     void refresh_root_accessor();
 
@@ -19,6 +19,9 @@
 #ifndef REALM_COLUMN_TIMESTAMP_HPP
 #define REALM_COLUMN_TIMESTAMP_HPP
 
+#include <limits>
+#include <type_traits>
+
 #include <realm/column.hpp>
 #include <realm/timestamp.hpp>
 
@@ -99,8 +102,11 @@ public:
     template <class Condition>
     size_t find(Timestamp value, size_t begin, size_t end) const noexcept
     {
-        // FIXME: Here we can do all sorts of clever optimizations. Use bithack-search on seconds, then for each match
-        // check nanoseconds, etc. Lots of possibilities. Below code is naive and slow but works.
+        const bool is_range = std::is_same<Condition, Greater>::value || std::is_same<Condition, Less>::value ||
+                              std::is_same<Condition, GreaterEqual>::value ||
+                              std::is_same<Condition, LessEqual>::value;
+        if (is_range && !value.is_null())
+            return find_in_range<Condition>(value, begin, end);
 
         Condition cond;
         for (size_t t = begin; t < end; t++) {
@@ -111,6 +117,15 @@ public:
         return npos;
     }
 
+    using SecondsLeafInfo = BpTree<util::Optional<int64_t>>::LeafInfo;
+
+    // The leaf holding the seconds of row `row_ndx`, for scans over the seconds, see BpTree::get_leaf(). The seconds
+    // of null timestamps are null.
+    void get_seconds_leaf(size_t row_ndx, size_t& ndx_in_leaf, SecondsLeafInfo& leaf) const noexcept
+    {
+        m_seconds->get_leaf(row_ndx, ndx_in_leaf, leaf);
+    }
+
     typedef Timestamp value_type;
 
 private:
@@ -123,6 +138,67 @@ private:
     template <class BT>
     class CreateHandler;
 
+    // Range conditions are decided by the seconds alone, except for rows with the same seconds as `value`. So the
+    // seconds are scanned for candidates with the bithack and SSE search of Array, and only the candidates with
+    // equal seconds have their nanoseconds read.
+    template <class Condition>
+    size_t find_in_range(Timestamp value, size_t begin, size_t end) const noexcept
+    {
+        const bool greater = std::is_same<Condition, Greater>::value || std::is_same<Condition, GreaterEqual>::value;
+        int64_t seconds = value.get_seconds();
+        if (seconds == (greater ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max())) {
+            // Every non-null row is a candidate, and the bound below would overflow
+            Condition cond;
+            for (size_t t = begin; t < end; t++) {
+                Timestamp ts = get(t);
+                if (cond(ts, value, ts.is_null(), false))
+                    return t;
+            }
+            return npos;
+        }
+        int64_t bound = greater ? seconds - 1 : seconds + 1;
+
+        Condition cond;
+        ArrayIntNull fallback(m_seconds->get_alloc());
+        const ArrayIntNull* leaf;
+        SecondsLeafInfo leaf_info{&leaf, &fallback};
+        while (begin < end) {
+            size_t ndx_in_leaf;
+            m_seconds->get_leaf(begin, ndx_in_leaf, leaf_info);
+            size_t leaf_offset = begin - ndx_in_leaf;
+            size_t leaf_end = std::min(leaf->size(), end - leaf_offset);
+
+            // Search the plain array below the nullable one, where entry 0 is the null value, and the row at
+            // `i` is entry `i + 1`
+            const Array& array = *leaf;
+            int64_t null_value = array.get(0);
+            size_t i = ndx_in_leaf;
+            while (i < leaf_end) {
+                QueryState<int64_t> state;
+                state.init(act_ReturnFirst, nullptr, 1);
+                if (greater)
+                    array.find<Greater>(act_ReturnFirst, bound, i + 1, leaf_end + 1, 0, &state);
+                else
+                    array.find<Less>(act_ReturnFirst, bound, i + 1, leaf_end + 1, 0, &state);
+                if (state.m_match_count == 0)
+                    break;
+                size_t found = to_size_t(state.m_state);
+                i = found; // The row after the match
+                int64_t candidate = array.get(found);
+                if (candidate == null_value)
+                    continue;
+                size_t row = leaf_offset + found - 1;
+                if (candidate != seconds)
+                    return row;
+                Timestamp ts(candidate, int32_t(m_nanoseconds->get(row)));
+                if (cond(ts, value, false, false))
+                    return row;
+            }
+            begin = leaf_offset + leaf->size();
+        }
+        return npos;
+    }
+
     template <class Condition>
     Timestamp minmax(size_t* result_index) const noexcept
     {
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <set>
 #include <fstream>
+#include <thread>
 
 #ifdef REALM_DEBUG
 #include <iostream>
@@ -54,6 +55,15 @@ public:
 
 Initialization initialization;
 
+// The number of threads copying `size` bytes written by Group::write(). Each
+// thread copies at least 16 MiB, as less does not make up for starting it.
+size_t get_copy_thread_count(size_t size)
+{
+    size_t min_size_per_thread = 16 * 1024 * 1024;
+    size_t max_thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    return std::max(std::min(size / min_size_per_thread, max_thread_count), size_t(1));
+}
+
 } // anonymous namespace
 
 
@@ -125,7 +135,7 @@ void Group::upgrade_file_format(int target_file_format_version)
     // Be sure to revisit the following upgrade logic when a new file foprmat
     // version is introduced. The following assert attempt to help you not
     // forget it.
-    REALM_ASSERT_EX(target_file_format_version == 6, target_file_format_version);
+    REALM_ASSERT_EX(target_file_format_version == 7, target_file_format_version);
 
     int current_file_format_version = get_file_format_version();
     REALM_ASSERT(current_file_format_version < target_file_format_version);
@@ -134,7 +144,8 @@ void Group::upgrade_file_format(int target_file_format_version)
     // following upgrade logic when SlabAlloc::validate_buffer() is changed (or
     // vice versa).
     REALM_ASSERT_EX(current_file_format_version == 2 || current_file_format_version == 3 ||
-                        current_file_format_version == 4 || current_file_format_version == 5,
+                        current_file_format_version == 4 || current_file_format_version == 5 ||
+                        current_file_format_version == 6,
                     current_file_format_version);
 
     // Upgrade from 2 to 3
@@ -166,6 +177,13 @@ void Group::upgrade_file_format(int target_file_format_version)
         }
     }
 
+    // Upgrade from 6 to 7 (compressed medium strings leaves, and prefix nodes
+    // in the StringIndex)
+    if (current_file_format_version <= 6 && target_file_format_version >= 7) {
+        // No-op, existing leaves are left uncompressed, and existing chains of
+        // subindexes remain valid
+    }
+
     // NOTE: Additional future upgrade steps go here.
 
     set_file_format_version(target_file_format_version);
@@ -746,17 +764,25 @@ public:
         : m_group(group)
     {
     }
+    // The leaves of the group stay where they are while it is written, so a
+    // snapshot can borrow them
     ref_type write_names(_impl::OutputStream& out) override
     {
-        bool deep = true;                                                // Deep
-        bool only_if_modified = false;                                   // Always
-        return m_group.m_table_names.write(out, deep, only_if_modified); // Throws
+        bool deep = true;              // Deep
+        bool only_if_modified = false; // Always
+        out.set_borrow_arrays(true);
+        ref_type ref = m_group.m_table_names.write(out, deep, only_if_modified); // Throws
+        out.set_borrow_arrays(false);
+        return ref;
     }
     ref_type write_tables(_impl::OutputStream& out) override
     {
-        bool deep = true;                                           // Deep
-        bool only_if_modified = false;                              // Always
-        return m_group.m_tables.write(out, deep, only_if_modified); // Throws
+        bool deep = true;              // Deep
+        bool only_if_modified = false; // Always
+        out.set_borrow_arrays(true);
+        ref_type ref = m_group.m_tables.write(out, deep, only_if_modified); // Throws
+        out.set_borrow_arrays(false);
+        return ref;
     }
 
 private:
@@ -776,6 +802,16 @@ void Group::write(std::ostream& out, bool pad_for_encryption, uint_fast64_t vers
     write(out, m_alloc, table_writer, no_top_array, pad_for_encryption, version_number); // Throws
 }
 
+void Group::write(_impl::StreamSnapshot& snapshot, uint_fast64_t version_number) const
+{
+    REALM_ASSERT(is_attached());
+    DefaultTableWriter table_writer(*this);
+    bool no_top_array = !m_top.is_attached();
+    bool pad_for_encryption = false;
+    _impl::OutputStream out(snapshot);
+    write(out, m_alloc, table_writer, no_top_array, pad_for_encryption, version_number); // Throws
+}
+
 void Group::write(const std::string& path, const char* encryption_key) const
 {
     write(path, encryption_key, 0);
@@ -793,36 +829,35 @@ void Group::write(File& file, const char* encryption_key, uint_fast64_t version_
 {
     REALM_ASSERT(file.get_size() == 0);
 
-    file.set_encryption_key(encryption_key);
-    File::Streambuf streambuf(&file);
-    std::ostream out(&streambuf);
-    write(out, encryption_key != 0, version_number);
+    if (encryption_key) {
+        file.set_encryption_key(encryption_key);
+        File::Streambuf streambuf(&file);
+        std::ostream out(&streambuf);
+        write(out, true, version_number);
+        return;
+    }
+
+    // Lay out the file first, and then copy the arrays into a mapping of the
+    // file on several threads
+    _impl::StreamSnapshot snapshot;
+    write(snapshot, version_number); // Throws
+    file.prealloc(0, snapshot.size()); // Throws
+    File::Map<char> map(file, File::access_ReadWrite, snapshot.size()); // Throws
+    snapshot.copy_to(map.get_addr(), get_copy_thread_count(snapshot.size()));
 }
 
 BinaryData Group::write_to_mem() const
 {
     REALM_ASSERT(is_attached());
 
-    // Get max possible size of buffer
-    //
-    // FIXME: This size could potentially be vastly bigger that what
-    // is actually needed.
-    size_t max_size = m_alloc.get_total_size();
-
-    char* buffer = static_cast<char*>(malloc(max_size)); // Throws
+    _impl::StreamSnapshot snapshot;
+    write(snapshot, 0); // Throws
+    size_t size = snapshot.size();
+    char* buffer = static_cast<char*>(malloc(size)); // Throws
     if (!buffer)
         throw std::bad_alloc();
-    try {
-        MemoryOutputStream out; // Throws
-        out.set_buffer(buffer, buffer + max_size);
-        write(out); // Throws
-        size_t buffer_size = out.size();
-        return BinaryData(buffer, buffer_size);
-    }
-    catch (...) {
-        free(buffer);
-        throw;
-    }
+    snapshot.copy_to(buffer, get_copy_thread_count(size));
+    return BinaryData(buffer, size);
 }
 
 
@@ -830,6 +865,13 @@ void Group::write(std::ostream& out, const Allocator& alloc, TableWriter& table_
                   bool pad_for_encryption, uint_fast64_t version_number)
 {
     _impl::OutputStream out_2(out);
+    write(out_2, alloc, table_writer, no_top_array, pad_for_encryption, version_number); // Throws
+}
+
+
+void Group::write(_impl::OutputStream& out_2, const Allocator& alloc, TableWriter& table_writer, bool no_top_array,
+                  bool pad_for_encryption, uint_fast64_t version_number)
+{
 
     // Write the file header
     SlabAlloc::Header streaming_header;
@@ -1325,6 +1367,8 @@ public:
                 size_t from_row_ndx = row_ndx;
                 size_t to_row_ndx = prior_num_rows;
                 tf::adj_acc_move_over(*m_table, from_row_ndx, to_row_ndx);
+                if (num_rows_to_insert == 1)
+                    record_changed_row(row_ndx);
             }
             else {
                 tf::adj_acc_insert_rows(*m_table, row_ndx, num_rows_to_insert);
@@ -1387,49 +1431,58 @@ public:
         return true;
     }
 
-    bool set_int(size_t, size_t, int_fast64_t, _impl::Instruction, size_t) noexcept
+    bool set_int(size_t, size_t row_ndx, int_fast64_t, _impl::Instruction, size_t) noexcept
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
-    bool add_int(size_t, size_t, int_fast64_t) noexcept
+    bool add_int(size_t, size_t row_ndx, int_fast64_t) noexcept
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
-    bool set_bool(size_t, size_t, bool, _impl::Instruction) noexcept
+    bool set_bool(size_t, size_t row_ndx, bool, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
-    bool set_float(size_t, size_t, float, _impl::Instruction) noexcept
+    bool set_float(size_t, size_t row_ndx, float, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
-    bool set_double(size_t, size_t, double, _impl::Instruction) noexcept
+    bool set_double(size_t, size_t row_ndx, double, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
-    bool set_string(size_t, size_t, StringData, _impl::Instruction, size_t) noexcept
+    bool set_string(size_t, size_t row_ndx, StringData, _impl::Instruction, size_t) noexcept
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
-    bool set_binary(size_t, size_t, BinaryData, _impl::Instruction) noexcept
+    bool set_binary(size_t, size_t row_ndx, BinaryData, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
-    bool set_olddatetime(size_t, size_t, OldDateTime, _impl::Instruction) noexcept
+    bool set_olddatetime(size_t, size_t row_ndx, OldDateTime, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
-    bool set_timestamp(size_t, size_t, Timestamp, _impl::Instruction) noexcept
+    bool set_timestamp(size_t, size_t row_ndx, Timestamp, _impl::Instruction) noexcept
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
     bool set_table(size_t col_ndx, size_t row_ndx, _impl::Instruction) noexcept
@@ -1452,9 +1505,10 @@ public:
         return true;
     }
 
-    bool set_null(size_t, size_t, _impl::Instruction, size_t) noexcept
+    bool set_null(size_t, size_t row_ndx, _impl::Instruction, size_t) noexcept
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
     bool set_link(size_t col_ndx, size_t, size_t, size_t, _impl::Instruction) noexcept
@@ -1484,14 +1538,16 @@ public:
         return true;
     }
 
-    bool insert_substring(size_t, size_t, size_t, StringData)
+    bool insert_substring(size_t, size_t row_ndx, size_t, StringData)
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
-    bool erase_substring(size_t, size_t, size_t, size_t)
+    bool erase_substring(size_t, size_t row_ndx, size_t, size_t)
     {
-        return true; // No-op
+        record_changed_row(row_ndx);
+        return true;
     }
 
     bool optimize_table() noexcept
@@ -1722,6 +1778,13 @@ public:
 
 private:
     Group& m_group;
+    void record_changed_row(size_t row_ndx) noexcept
+    {
+        typedef _impl::TableFriend tf;
+        if (m_table)
+            tf::record_changed_row(*m_table, row_ndx);
+    }
+
     TableRef m_table;
     DescriptorRef m_desc;
     const size_t* m_desc_path_begin;
@@ -1741,8 +1804,10 @@ void Group::refresh_dirty_accessors()
             tf::set_ndx_in_parent(*table, table_ndx);
             if (tf::is_marked(*table)) {
                 tf::refresh_accessor_tree(*table); // Throws
+                uint_fast64_t old_version = table->get_version_counter();
                 bool bump_global = false;
                 tf::bump_version(*table, bump_global);
+                tf::record_version_bump(*table, old_version);
             }
         }
     }
@@ -2078,7 +2143,7 @@ void Group::verify() const
 
     // Check the concistency of the allocation of the mutable memory that has
     // been marked as free
-    for (const auto& free_block : m_alloc.m_free_space) {
+    for (const auto& free_block : m_alloc.get_free_space()) {
         mem_usage_2.add_mutable(free_block.ref, free_block.size);
     }
     mem_usage_2.canonicalize();
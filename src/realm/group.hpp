@@ -662,6 +662,8 @@ private:
 
     static void write(std::ostream&, const Allocator&, TableWriter&, bool no_top_array, bool pad_for_encryption,
                       uint_fast64_t version_number);
+    static void write(_impl::OutputStream&, const Allocator&, TableWriter&, bool no_top_array,
+                      bool pad_for_encryption, uint_fast64_t version_number);
 
     typedef void (*DescSetter)(Table&);
     typedef bool (*DescMatcher)(const Spec&);
@@ -686,6 +688,7 @@ private:
     void write(const std::string& file, const char* encryption_key, uint_fast64_t version_number) const;
     void write(util::File& file, const char* encryption_key, uint_fast64_t version_number) const;
     void write(std::ostream&, bool pad, uint_fast64_t version_numer) const;
+    void write(_impl::StreamSnapshot&, uint_fast64_t version_number) const;
 
     Replication* get_replication() const noexcept;
     void set_replication(Replication*) noexcept;
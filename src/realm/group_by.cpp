@@ -0,0 +1,667 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+#include <realm/group_by.hpp>
+#include <realm/column_string_enum.hpp>
+#include <realm/column_timestamp.hpp>
+#include <realm/query_engine.hpp>
+#include <realm/table_view.hpp>
+#include <realm/util/ordered_pipeline.hpp>
+
+using namespace realm;
+
+namespace {
+
+// The number of rows in each part when `count` rows are split into at most `thread_count` parts. Parts consist of
+// whole B+-tree leaves, so no two threads read the same leaf of a column.
+size_t get_part_size(size_t count, size_t thread_count)
+{
+    size_t part_size = (count + thread_count - 1) / std::max(thread_count, size_t(1));
+    size_t leaf_size = REALM_MAX_BPNODE_SIZE;
+    return std::max((part_size + leaf_size - 1) / leaf_size, size_t(1)) * leaf_size;
+}
+
+} // anonymous namespace
+
+// Assigns rows to groups and accumulates the aggregates of each row in a single pass. Rows are assigned to groups
+// in one of three ways: Through the key indexes of an auto-enumerated string column, which is the common case for
+// group-by columns with few distinct values, through a hash map of the values of a single integer column, or through
+// a hash map of the keys of all columns encoded into one string.
+class GroupByResult::Builder {
+public:
+    Builder(const Table& table, const std::vector<size_t>& keys, const std::vector<GroupByAggregate>& aggregates,
+            GroupByResult& result);
+
+    void add_row(size_t row);
+
+    // Add the rows `begin` to `end`, or the rows at those positions in `viewrefs`
+    void add_rows(const IntegerColumn* viewrefs, size_t begin, size_t end);
+
+    // Add the groups of `part`, which was built from other rows of the same table, with the same keys and
+    // aggregates. Groups new to this builder are added in the order of `part`.
+    void merge(const Builder& part);
+
+    void finalize();
+
+private:
+    using Aggregator = void (*)(const ColumnBase&, size_t row, AggregateColumn&, size_t group);
+
+    enum class Mode {
+        single_group,
+        enum_keys,
+        int_key,
+        encoded_keys,
+    };
+
+    const Table& m_table;
+    const std::vector<size_t>& m_key_columns;
+    GroupByResult& m_result;
+
+    // The first row of each group, which merge() uses to look up the group in another builder
+    std::vector<size_t> m_first_rows;
+
+    // For each aggregate, the column, the function applied to each row, and the type of the values accumulated for
+    // each group, which differs from the result type for averages
+    std::vector<const ColumnBase*> m_source_columns;
+    std::vector<Aggregator> m_aggregators;
+    std::vector<DataType> m_accumulator_types;
+
+    Mode m_mode;
+
+    // Mode::enum_keys
+    const StringEnumColumn* m_enums = nullptr;
+    std::vector<size_t> m_enum_groups;
+    const ArrayInteger* m_leaf = nullptr;
+    ArrayInteger m_leaf_cache;
+    size_t m_leaf_begin = 0;
+    size_t m_leaf_end = 0;
+
+    // Mode::int_key
+    const IntegerColumn* m_int_column = nullptr;
+    std::unordered_map<int64_t, size_t> m_int_groups;
+
+    // Mode::encoded_keys
+    std::unordered_map<std::string, size_t> m_encoded_groups;
+    std::string m_buffer;
+
+    size_t find_group(size_t row);
+    size_t add_group(size_t row);
+    void encode_keys(size_t row);
+
+    template <class T>
+    void encode(T value)
+    {
+        m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static bool get_value(const IntegerColumn& column, size_t row, int64_t& value)
+    {
+        value = column.get(row);
+        return true;
+    }
+
+    static bool get_value(const IntNullColumn& column, size_t row, int64_t& value)
+    {
+        util::Optional<int64_t> v = column.get(row);
+        value = v ? *v : 0;
+        return bool(v);
+    }
+
+    template <class T>
+    static bool get_value(const Column<T>& column, size_t row, double& value)
+    {
+        value = column.get(row);
+        return !column.is_null(row);
+    }
+
+    static bool get_value(const TimestampColumn& column, size_t row, Timestamp& value)
+    {
+        value = column.get(row);
+        return !value.is_null();
+    }
+
+    static std::vector<int64_t>& results(AggregateColumn& aggr, int64_t)
+    {
+        return aggr.ints;
+    }
+
+    static std::vector<double>& results(AggregateColumn& aggr, double)
+    {
+        return aggr.doubles;
+    }
+
+    static std::vector<Timestamp>& results(AggregateColumn& aggr, Timestamp)
+    {
+        return aggr.timestamps;
+    }
+
+    template <class ColType, class T>
+    static void sum(const ColumnBase& column, size_t row, AggregateColumn& aggr, size_t group)
+    {
+        T value;
+        if (get_value(static_cast<const ColType&>(column), row, value)) {
+            results(aggr, value)[group] += value;
+            ++aggr.counts[group];
+        }
+    }
+
+    template <class ColType, class T>
+    static void minimum(const ColumnBase& column, size_t row, AggregateColumn& aggr, size_t group)
+    {
+        T value;
+        if (get_value(static_cast<const ColType&>(column), row, value)) {
+            T& result = results(aggr, value)[group];
+            if (aggr.counts[group]++ == 0 || value < result)
+                result = value;
+        }
+    }
+
+    template <class ColType, class T>
+    static void maximum(const ColumnBase& column, size_t row, AggregateColumn& aggr, size_t group)
+    {
+        T value;
+        if (get_value(static_cast<const ColType&>(column), row, value)) {
+            T& result = results(aggr, value)[group];
+            if (aggr.counts[group]++ == 0 || value > result)
+                result = value;
+        }
+    }
+
+    template <class ColType, class T>
+    static Aggregator get_aggregator(Table::AggrType op)
+    {
+        switch (op) {
+            case Table::aggr_sum:
+            case Table::aggr_avg:
+                return &sum<ColType, T>;
+            case Table::aggr_min:
+                return &minimum<ColType, T>;
+            case Table::aggr_max:
+                return &maximum<ColType, T>;
+            case Table::aggr_count:
+                break;
+        }
+        REALM_UNREACHABLE();
+    }
+
+    template <class T>
+    static void merge_value(Table::AggrType op, bool first, T& value, const T& other)
+    {
+        if (first || (op == Table::aggr_min && other < value) || (op == Table::aggr_max && other > value))
+            value = other;
+    }
+
+    // For types that can only be compared, not summed
+    template <class ColType, class T>
+    static Aggregator get_minmax_aggregator(Table::AggrType op)
+    {
+        REALM_ASSERT(op == Table::aggr_min || op == Table::aggr_max);
+        return op == Table::aggr_min ? &minimum<ColType, T> : &maximum<ColType, T>;
+    }
+};
+
+
+GroupByResult::Builder::Builder(const Table& table, const std::vector<size_t>& keys,
+                                const std::vector<GroupByAggregate>& aggregates, GroupByResult& result)
+    : m_table(table)
+    , m_key_columns(keys)
+    , m_result(result)
+    , m_leaf_cache(table.get_alloc())
+{
+    size_t column_count = table.get_column_count();
+    for (size_t col : keys) {
+        if (col >= column_count)
+            throw LogicError(LogicError::column_index_out_of_range);
+        DataType type = table.get_column_type(col);
+        switch (type) {
+            case type_Int:
+            case type_Bool:
+            case type_Float:
+            case type_Double:
+            case type_String:
+            case type_Binary:
+            case type_OldDateTime:
+            case type_Timestamp:
+                break;
+            case type_Table:
+            case type_Mixed:
+            case type_Link:
+            case type_LinkList:
+                throw LogicError(LogicError::illegal_type);
+        }
+        m_result.m_keys.push_back(KeyColumn{type, {}, {}, {}});
+    }
+
+    for (const GroupByAggregate& aggregate : aggregates) {
+        AggregateColumn aggr;
+        aggr.op = aggregate.op;
+        const ColumnBase* column = nullptr;
+        Aggregator aggregator = nullptr;
+        DataType accumulator_type = type_Int;
+        if (aggregate.op != Table::aggr_count) {
+            if (aggregate.column_ndx >= column_count)
+                throw LogicError(LogicError::column_index_out_of_range);
+            column = &table.get_column_base(aggregate.column_ndx);
+            switch (table.get_column_type(aggregate.column_ndx)) {
+                case type_Int:
+                    if (table.is_nullable(aggregate.column_ndx))
+                        aggregator = get_aggregator<IntNullColumn, int64_t>(aggregate.op);
+                    else
+                        aggregator = get_aggregator<IntegerColumn, int64_t>(aggregate.op);
+                    accumulator_type = type_Int;
+                    break;
+                case type_Float:
+                    aggregator = get_aggregator<FloatColumn, double>(aggregate.op);
+                    accumulator_type = type_Double;
+                    break;
+                case type_Double:
+                    aggregator = get_aggregator<DoubleColumn, double>(aggregate.op);
+                    accumulator_type = type_Double;
+                    break;
+                case type_Timestamp:
+                    if (aggregate.op != Table::aggr_min && aggregate.op != Table::aggr_max)
+                        throw LogicError(LogicError::illegal_type);
+                    aggregator = get_minmax_aggregator<TimestampColumn, Timestamp>(aggregate.op);
+                    accumulator_type = type_Timestamp;
+                    break;
+                default:
+                    throw LogicError(LogicError::illegal_type);
+            }
+        }
+        aggr.type = aggregate.op == Table::aggr_avg ? type_Double : accumulator_type;
+        m_result.m_aggregates.push_back(std::move(aggr));
+        m_source_columns.push_back(column);
+        m_aggregators.push_back(aggregator);
+        m_accumulator_types.push_back(accumulator_type);
+    }
+
+    if (keys.empty()) {
+        m_mode = Mode::single_group;
+    }
+    else if (keys.size() == 1 && table.get_real_column_type(keys[0]) == col_type_StringEnum) {
+        m_mode = Mode::enum_keys;
+        m_enums = &table.get_column_string_enum(keys[0]);
+        m_enum_groups.assign(m_enums->get_keys().size(), npos);
+    }
+    else if (keys.size() == 1 && table.get_real_column_type(keys[0]) == col_type_Int &&
+             !table.is_nullable(keys[0])) {
+        m_mode = Mode::int_key;
+        m_int_column = &table.get_column(keys[0]);
+    }
+    else {
+        m_mode = Mode::encoded_keys;
+    }
+}
+
+void GroupByResult::Builder::add_row(size_t row)
+{
+    size_t group = find_group(row);
+    for (size_t i = 0; i < m_aggregators.size(); ++i) {
+        AggregateColumn& aggr = m_result.m_aggregates[i];
+        if (m_aggregators[i])
+            (*m_aggregators[i])(*m_source_columns[i], row, aggr, group);
+        else
+            ++aggr.counts[group];
+    }
+}
+
+void GroupByResult::Builder::add_rows(const IntegerColumn* viewrefs, size_t begin, size_t end)
+{
+    if (viewrefs) {
+        for (size_t i = begin; i < end; ++i) {
+            int64_t row = viewrefs->get(i);
+            if (row != detached_ref)
+                add_row(to_size_t(row)); // Throws
+        }
+    }
+    else {
+        for (size_t row = begin; row < end; ++row)
+            add_row(row); // Throws
+    }
+}
+
+void GroupByResult::Builder::merge(const Builder& part)
+{
+    const GroupByResult& source = part.m_result;
+    for (size_t from = 0; from < source.m_size; ++from) {
+        size_t to = find_group(part.m_first_rows[from]); // Throws
+        for (size_t i = 0; i < m_aggregators.size(); ++i) {
+            const AggregateColumn& other = source.m_aggregates[i];
+            AggregateColumn& aggr = m_result.m_aggregates[i];
+            size_t count = other.counts[from];
+            if (m_aggregators[i] && count != 0) {
+                bool first = aggr.counts[to] == 0;
+                bool sum = aggr.op == Table::aggr_sum || aggr.op == Table::aggr_avg;
+                switch (m_accumulator_types[i]) {
+                    case type_Int:
+                        if (sum)
+                            aggr.ints[to] += other.ints[from];
+                        else
+                            merge_value(aggr.op, first, aggr.ints[to], other.ints[from]);
+                        break;
+                    case type_Double:
+                        if (sum)
+                            aggr.doubles[to] += other.doubles[from];
+                        else
+                            merge_value(aggr.op, first, aggr.doubles[to], other.doubles[from]);
+                        break;
+                    case type_Timestamp:
+                        merge_value(aggr.op, first, aggr.timestamps[to], other.timestamps[from]);
+                        break;
+                    default:
+                        REALM_UNREACHABLE();
+                }
+            }
+            aggr.counts[to] += count;
+        }
+    }
+}
+
+size_t GroupByResult::Builder::find_group(size_t row)
+{
+    switch (m_mode) {
+        case Mode::single_group:
+            return m_result.m_size == 0 ? add_group(row) : 0;
+        case Mode::enum_keys: {
+            // Keep the current leaf of the key indexes cached, like Table::aggregate() does
+            if (row < m_leaf_begin || row >= m_leaf_end) {
+                size_t ndx_in_leaf;
+                IntegerColumn::LeafInfo leaf{&m_leaf, &m_leaf_cache};
+                m_enums->IntegerColumn::get_leaf(row, ndx_in_leaf, leaf);
+                m_leaf_begin = row - ndx_in_leaf;
+                m_leaf_end = m_leaf_begin + m_leaf->size();
+            }
+            size_t& group = m_enum_groups[to_size_t(m_leaf->get(row - m_leaf_begin))];
+            if (group == npos)
+                group = add_group(row);
+            return group;
+        }
+        case Mode::int_key: {
+            auto it = m_int_groups.find(m_int_column->get(row));
+            if (it != m_int_groups.end())
+                return it->second;
+            size_t group = add_group(row);
+            m_int_groups.emplace(m_int_column->get(row), group);
+            return group;
+        }
+        case Mode::encoded_keys: {
+            encode_keys(row);
+            auto it = m_encoded_groups.find(m_buffer);
+            if (it != m_encoded_groups.end())
+                return it->second;
+            size_t group = add_group(row);
+            m_encoded_groups.emplace(m_buffer, group);
+            return group;
+        }
+    }
+    REALM_UNREACHABLE();
+}
+
+void GroupByResult::Builder::encode_keys(size_t row)
+{
+    m_buffer.clear();
+    for (size_t i = 0; i < m_key_columns.size(); ++i) {
+        size_t col = m_key_columns[i];
+        bool is_null = m_table.is_nullable(col) && m_table.is_null(col, row);
+        encode(is_null);
+        if (is_null)
+            continue;
+        switch (m_result.m_keys[i].type) {
+            case type_Int:
+                encode(m_table.get_int(col, row));
+                break;
+            case type_Bool:
+                encode(m_table.get_bool(col, row));
+                break;
+            case type_OldDateTime:
+                encode(m_table.get_olddatetime(col, row).get_olddatetime());
+                break;
+            case type_Float:
+            case type_Double: {
+                double value = m_result.m_keys[i].type == type_Float ? m_table.get_float(col, row)
+                                                                      : m_table.get_double(col, row);
+                // Equal values must have equal encodings
+                if (value == 0)
+                    value = 0;
+                encode(value);
+                break;
+            }
+            case type_String: {
+                StringData value = m_table.get_string(col, row);
+                encode(value.size());
+                m_buffer.append(value.data(), value.size());
+                break;
+            }
+            case type_Binary: {
+                BinaryData value = m_table.get_binary(col, row);
+                encode(value.size());
+                m_buffer.append(value.data(), value.size());
+                break;
+            }
+            case type_Timestamp: {
+                Timestamp value = m_table.get_timestamp(col, row);
+                encode(value.get_seconds());
+                encode(value.get_nanoseconds());
+                break;
+            }
+            case type_Table:
+            case type_Mixed:
+            case type_Link:
+            case type_LinkList:
+                REALM_UNREACHABLE();
+        }
+    }
+}
+
+size_t GroupByResult::Builder::add_group(size_t row)
+{
+    for (size_t i = 0; i < m_key_columns.size(); ++i) {
+        size_t col = m_key_columns[i];
+        KeyColumn& key = m_result.m_keys[i];
+        bool is_null = m_table.is_nullable(col) && m_table.is_null(col, row);
+        key.nulls.push_back(is_null);
+        Mixed value;
+        if (!is_null) {
+            switch (key.type) {
+                case type_Int:
+                    value = m_table.get_int(col, row);
+                    break;
+                case type_Bool:
+                    value = m_table.get_bool(col, row);
+                    break;
+                case type_OldDateTime:
+                    value = m_table.get_olddatetime(col, row);
+                    break;
+                case type_Float:
+                    value = m_table.get_float(col, row);
+                    break;
+                case type_Double:
+                    value = m_table.get_double(col, row);
+                    break;
+                case type_Timestamp:
+                    value = m_table.get_timestamp(col, row);
+                    break;
+                case type_String:
+                case type_Binary:
+                case type_Table:
+                case type_Mixed:
+                case type_Link:
+                case type_LinkList:
+                    break;
+            }
+        }
+        if (key.type == type_String) {
+            StringData str = m_table.get_string(col, row);
+            key.blobs.emplace_back(str.data(), str.size());
+        }
+        else if (key.type == type_Binary) {
+            BinaryData bin = m_table.get_binary(col, row);
+            key.blobs.emplace_back(bin.data(), bin.size());
+        }
+        else {
+            key.values.push_back(value);
+        }
+    }
+
+    m_first_rows.push_back(row);
+    size_t group = m_result.m_size++;
+    for (size_t i = 0; i < m_aggregators.size(); ++i) {
+        AggregateColumn& aggr = m_result.m_aggregates[i];
+        aggr.counts.push_back(0);
+        if (!m_aggregators[i])
+            continue;
+        switch (m_accumulator_types[i]) {
+            case type_Int:
+                aggr.ints.push_back(0);
+                break;
+            case type_Double:
+                aggr.doubles.push_back(0);
+                break;
+            case type_Timestamp:
+                aggr.timestamps.push_back(Timestamp(0, 0));
+                break;
+            default:
+                REALM_UNREACHABLE();
+        }
+    }
+    return group;
+}
+
+void GroupByResult::Builder::finalize()
+{
+    for (size_t i = 0; i < m_aggregators.size(); ++i) {
+        AggregateColumn& aggr = m_result.m_aggregates[i];
+        if (aggr.op != Table::aggr_avg)
+            continue;
+        bool integral = m_accumulator_types[i] == type_Int;
+        aggr.doubles.resize(m_result.m_size);
+        for (size_t group = 0; group < m_result.m_size; ++group) {
+            double sum = integral ? double(aggr.ints[group]) : aggr.doubles[group];
+            aggr.doubles[group] = aggr.counts[group] ? sum / aggr.counts[group] : 0;
+        }
+        aggr.ints.clear();
+    }
+}
+
+
+GroupByResult Table::group_by(const std::vector<size_t>& keys, const std::vector<GroupByAggregate>& aggregates,
+                              const IntegerColumn* viewrefs, size_t thread_count) const
+{
+    using Builder = GroupByResult::Builder;
+    GroupByResult result;
+    Builder builder(*this, keys, aggregates, result); // Throws
+
+    size_t count = viewrefs ? viewrefs->size() : size();
+    size_t part_size = get_part_size(count, thread_count);
+    size_t part_count = (count + part_size - 1) / part_size;
+    if (part_count <= 1) {
+        builder.add_rows(viewrefs, 0, count); // Throws
+    }
+    else {
+        // The first part goes straight into `builder`, and the others into builders of their own, which are merged
+        // into it in order as they are done. The calling thread merges, and builds the parts no thread has claimed.
+        std::vector<GroupByResult> part_results(part_count - 1);
+        std::vector<std::unique_ptr<Builder>> part_builders;
+        for (GroupByResult& part_result : part_results)
+            part_builders.emplace_back(new Builder(*this, keys, aggregates, part_result)); // Throws
+
+        auto build = [&](size_t part, size_t) {
+            Builder& b = part == 0 ? builder : *part_builders[part - 1];
+            size_t begin = part * part_size;
+            b.add_rows(viewrefs, begin, std::min(begin + part_size, count)); // Throws
+        };
+        auto merge = [&](size_t part, size_t) {
+            if (part > 0)
+                builder.merge(*part_builders[part - 1]); // Throws
+            return true;
+        };
+        util::run_ordered_pipeline(part_count, part_count - 1, build, merge); // Throws
+    }
+
+    builder.finalize();
+    return result;
+}
+
+GroupByResult TableViewBase::group_by(const std::vector<size_t>& keys,
+                                      const std::vector<GroupByAggregate>& aggregates, size_t thread_count) const
+{
+    check_cookie();
+    return m_table->group_by(keys, aggregates, &m_row_indexes, thread_count);
+}
+
+GroupByResult Query::group_by(const std::vector<size_t>& keys, const std::vector<GroupByAggregate>& aggregates,
+                              size_t thread_count) const
+{
+    // Only conditions that read nothing but their own column are matched by several threads at once. Others, such
+    // as conditions on subtables, may create accessors while they run.
+    bool parallel_match = thread_count > 1 && !m_view && has_conditions() && !m_table->is_degenerate();
+    for (ParentNode* node = parallel_match ? root_node() : nullptr; node; node = node->m_child.get()) {
+        if (!node->can_match_block())
+            parallel_match = false;
+    }
+
+    if (!parallel_match) {
+        ConstTableView matches(*m_table);
+        find_all(matches);                                       // Throws
+        return matches.group_by(keys, aggregates, thread_count); // Throws
+    }
+
+    using Builder = GroupByResult::Builder;
+    GroupByResult result;
+    Builder builder(*m_table, keys, aggregates, result); // Throws
+
+    size_t count = m_table->size();
+    size_t part_size = get_part_size(count, thread_count);
+    size_t part_count = (count + part_size - 1) / part_size;
+
+    // Each part is matched by its own copy of the query, into a view of its own, and the matches are grouped by
+    // its own builder. Copies and views are made here, as they register with the table.
+    std::vector<GroupByResult> part_results(part_count);
+    std::vector<std::unique_ptr<Builder>> part_builders;
+    std::vector<std::unique_ptr<Query>> queries;
+    std::vector<std::unique_ptr<ConstTableView>> matches;
+    for (size_t part = 0; part < part_count; ++part) {
+        part_builders.emplace_back(new Builder(*m_table, keys, aggregates, part_results[part])); // Throws
+        queries.emplace_back(new Query(*this));                                                 // Throws
+        matches.emplace_back(new ConstTableView(*m_table));                                     // Throws
+    }
+
+    auto build = [&](size_t part, size_t) {
+        const Query& query = *queries[part];
+        IntegerColumn& rows = matches[part]->m_row_indexes;
+        size_t begin = part * part_size;
+        size_t end = std::min(begin + part_size, count);
+        query.init();
+        QueryState<int64_t> st;
+        st.init(act_FindAll, &rows, size_t(-1));
+        query.aggregate_internal(act_FindAll, ColumnTypeTraits<int64_t>::id, false, query.root_node(), &st, begin,
+                                 end, nullptr); // Throws
+        part_builders[part]->add_rows(&rows, 0, rows.size()); // Throws
+    };
+    auto merge = [&](size_t part, size_t) {
+        builder.merge(*part_builders[part]); // Throws
+        return true;
+    };
+    util::run_ordered_pipeline(part_count, part_count > 0 ? part_count - 1 : 0, build, merge); // Throws
+    builder.finalize();
+    return result;
+}
@@ -0,0 +1,176 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_GROUP_BY_HPP
+#define REALM_GROUP_BY_HPP
+
+#include <string>
+#include <vector>
+
+#include <realm/mixed.hpp>
+#include <realm/table.hpp>
+
+namespace realm {
+
+/// One aggregate computed by Table::group_by(): `op` applied to the values of
+/// column `column_ndx` in each group. Null values are skipped. For
+/// Table::aggr_count, the column is ignored and the rows of the group are
+/// counted.
+struct GroupByAggregate {
+    Table::AggrType op;
+    size_t column_ndx;
+};
+
+/// The result of Table::group_by(), TableViewBase::group_by() and
+/// Query::group_by(), stored column by column. Group `i` has the key values
+/// `get_key(k, i)` for each key column `k`, and the result of aggregate `a` is
+/// `get_int(a, i)`, `get_double(a, i)` or `get_timestamp(a, i)`, according to
+/// get_aggregate_type(). Groups are ordered by their first row. String and
+/// binary keys are copied, so the result stays valid when the table changes.
+class GroupByResult {
+public:
+    /// The number of groups
+    size_t size() const noexcept;
+
+    size_t get_key_count() const noexcept;
+    DataType get_key_type(size_t key) const noexcept;
+    bool is_key_null(size_t key, size_t group) const noexcept;
+    Mixed get_key(size_t key, size_t group) const noexcept;
+
+    /// `type_Int` for counts, and for sums, minimums and maximums of integers,
+    /// `type_Timestamp` for minimums and maximums of timestamps, and
+    /// `type_Double` for everything else.
+    size_t get_aggregate_count() const noexcept;
+    DataType get_aggregate_type(size_t aggr) const noexcept;
+
+    /// True for minimums, maximums and averages of groups without any non-null
+    /// values in the aggregated column.
+    bool is_null(size_t aggr, size_t group) const noexcept;
+
+    int64_t get_int(size_t aggr, size_t group) const noexcept;
+    double get_double(size_t aggr, size_t group) const noexcept;
+    Timestamp get_timestamp(size_t aggr, size_t group) const noexcept;
+
+private:
+    struct KeyColumn {
+        DataType type;
+        std::vector<Mixed> values;       // All but strings and binaries
+        std::vector<std::string> blobs; // Strings and binaries
+        std::vector<bool> nulls;
+    };
+
+    struct AggregateColumn {
+        Table::AggrType op;
+        DataType type;
+        std::vector<int64_t> ints;
+        std::vector<double> doubles;
+        std::vector<Timestamp> timestamps;
+        std::vector<size_t> counts; // Number of non-null values in each group
+    };
+
+    std::vector<KeyColumn> m_keys;
+    std::vector<AggregateColumn> m_aggregates;
+    size_t m_size = 0;
+
+    class Builder;
+    friend class Table;
+    friend class Query;
+};
+
+
+// Implementation:
+
+inline size_t GroupByResult::size() const noexcept
+{
+    return m_size;
+}
+
+inline size_t GroupByResult::get_key_count() const noexcept
+{
+    return m_keys.size();
+}
+
+inline DataType GroupByResult::get_key_type(size_t key) const noexcept
+{
+    return m_keys[key].type;
+}
+
+inline bool GroupByResult::is_key_null(size_t key, size_t group) const noexcept
+{
+    return m_keys[key].nulls[group];
+}
+
+inline Mixed GroupByResult::get_key(size_t key, size_t group) const noexcept
+{
+    const KeyColumn& column = m_keys[key];
+    if (column.type == type_String)
+        return Mixed(StringData(column.blobs[group]));
+    if (column.type == type_Binary)
+        return Mixed(BinaryData(column.blobs[group]));
+    return column.values[group];
+}
+
+inline size_t GroupByResult::get_aggregate_count() const noexcept
+{
+    return m_aggregates.size();
+}
+
+inline DataType GroupByResult::get_aggregate_type(size_t aggr) const noexcept
+{
+    return m_aggregates[aggr].type;
+}
+
+inline bool GroupByResult::is_null(size_t aggr, size_t group) const noexcept
+{
+    const AggregateColumn& column = m_aggregates[aggr];
+    switch (column.op) {
+        case Table::aggr_min:
+        case Table::aggr_max:
+        case Table::aggr_avg:
+            return column.counts[group] == 0;
+        case Table::aggr_count:
+        case Table::aggr_sum:
+            break;
+    }
+    return false;
+}
+
+inline int64_t GroupByResult::get_int(size_t aggr, size_t group) const noexcept
+{
+    const AggregateColumn& column = m_aggregates[aggr];
+    REALM_ASSERT_DEBUG(column.type == type_Int);
+    if (column.op == Table::aggr_count)
+        return int64_t(column.counts[group]);
+    return column.ints[group];
+}
+
+inline double GroupByResult::get_double(size_t aggr, size_t group) const noexcept
+{
+    REALM_ASSERT_DEBUG(m_aggregates[aggr].type == type_Double);
+    return m_aggregates[aggr].doubles[group];
+}
+
+inline Timestamp GroupByResult::get_timestamp(size_t aggr, size_t group) const noexcept
+{
+    REALM_ASSERT_DEBUG(m_aggregates[aggr].type == type_Timestamp);
+    return m_aggregates[aggr].timestamps[group];
+}
+
+} // namespace realm
+
+#endif // REALM_GROUP_BY_HPP
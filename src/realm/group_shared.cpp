@@ -1668,6 +1668,164 @@ void SharedGroup::unpin_version(VersionID token)
 }
 
 
+namespace {
+
+// An increment is this, followed by the file header, the size of the file, and
+// then records of the ref and size of a number of consecutive arrays followed
+// by their bytes. A record with a size of zero ends the increment.
+const char increment_magic[8] = {'T', '-', 'D', 'B', 'I', 'N', 'C', '1'};
+
+REALM_NORETURN void bad_increment()
+{
+    throw std::runtime_error("Bad Realm increment");
+}
+
+} // anonymous namespace
+
+
+void SharedGroup::write_increment(std::ostream& out, util::Optional<VersionID> base)
+{
+    if (m_transact_stage != transact_Reading)
+        throw LogicError(LogicError::wrong_transact_state);
+    if (m_key)
+        throw std::runtime_error(m_db_path + ": increments cannot be written for encrypted files");
+
+    SlabAlloc& alloc = m_group.m_alloc;
+
+    // The space in use by `base` is everything before its logical file size
+    // except its free space
+    size_t base_size = 0;
+    std::vector<std::pair<ref_type, size_t>> base_free_space;
+    if (base) {
+        ReadLockInfo base_lock;
+        grab_read_lock(base_lock, *base); // Throws
+        ReadLockUnlockGuard g(*this, base_lock);
+        if (base_lock.m_version > m_read_lock.m_version)
+            throw LogicError(LogicError::bad_version);
+        if (base_lock.m_top_ref != 0) {
+            Array top(alloc);
+            top.init_from_ref(base_lock.m_top_ref);
+            base_size = size_t(top.get_as_ref_or_tagged(2).get_as_int());
+            if (top.size() > 4) {
+                Array positions(alloc), lengths(alloc);
+                positions.init_from_ref(top.get_as_ref(3));
+                lengths.init_from_ref(top.get_as_ref(4));
+                for (size_t i = 0; i < positions.size(); ++i)
+                    base_free_space.emplace_back(to_ref(positions.get(i)), to_size_t(lengths.get(i))); // Throws
+                std::sort(base_free_space.begin(), base_free_space.end());
+            }
+        }
+    }
+    auto in_base = [&](ref_type ref) {
+        if (ref >= base_size)
+            return false;
+        auto i = std::upper_bound(base_free_space.begin(), base_free_space.end(),
+                                  std::make_pair(ref, std::numeric_limits<size_t>::max()));
+        return i == base_free_space.begin() || ref >= (i - 1)->first + (i - 1)->second;
+    };
+
+    // The arrays that are not in `base`. The children of an array that is in
+    // `base` are also in `base`, as it has not changed since.
+    std::vector<std::pair<ref_type, size_t>> arrays;
+    std::vector<ref_type> unvisited;
+    if (m_read_lock.m_top_ref != 0)
+        unvisited.push_back(m_read_lock.m_top_ref);
+    while (!unvisited.empty()) {
+        ref_type ref = unvisited.back();
+        unvisited.pop_back();
+        if (in_base(ref))
+            continue;
+        Array array(alloc);
+        array.init_from_ref(ref);
+        arrays.emplace_back(ref, array.get_byte_size()); // Throws
+        if (array.has_refs()) {
+            for (size_t i = 0; i < array.size(); ++i) {
+                int_fast64_t value = array.get(i);
+                if (value != 0 && value % 2 == 0)
+                    unvisited.push_back(to_ref(value)); // Throws
+            }
+        }
+    }
+    std::sort(arrays.begin(), arrays.end());
+
+    SlabAlloc::Header header = SlabAlloc::empty_file_header;
+    header.m_top_ref[0] = m_read_lock.m_top_ref;
+    header.m_file_format[0] = uint8_t(alloc.get_file_format_version());
+    uint64_t file_size = m_read_lock.m_file_size;
+    out.write(increment_magic, sizeof increment_magic);                    // Throws
+    out.write(reinterpret_cast<const char*>(&header), sizeof header);      // Throws
+    out.write(reinterpret_cast<const char*>(&file_size), sizeof file_size); // Throws
+
+    // Arrays that follow each other in the file share a record
+    for (size_t begin = 0; begin < arrays.size();) {
+        size_t end = begin + 1;
+        uint64_t record[2] = {arrays[begin].first, arrays[begin].second};
+        while (end < arrays.size() && arrays[end].first == record[0] + record[1]) {
+            record[1] += arrays[end].second;
+            ++end;
+        }
+        out.write(reinterpret_cast<const char*>(record), sizeof record); // Throws
+        for (; begin < end; ++begin)
+            out.write(alloc.translate(arrays[begin].first), std::streamsize(arrays[begin].second)); // Throws
+    }
+    uint64_t last_record[2] = {0, 0};
+    out.write(reinterpret_cast<const char*>(last_record), sizeof last_record); // Throws
+}
+
+
+void SharedGroup::apply_increment(std::istream& in, const std::string& path)
+{
+    auto read = [&](void* data, size_t size) {
+        in.read(static_cast<char*>(data), std::streamsize(size)); // Throws
+        if (size_t(in.gcount()) != size)
+            bad_increment();
+    };
+    char magic[sizeof increment_magic];
+    SlabAlloc::Header header;
+    uint64_t file_size;
+    read(magic, sizeof magic);
+    if (!std::equal(magic, magic + sizeof magic, increment_magic))
+        bad_increment();
+    read(&header, sizeof header);
+    read(&file_size, sizeof file_size);
+    if (file_size < sizeof header || header.m_top_ref[0] >= file_size)
+        bad_increment();
+
+    File file;
+    file.open(path, File::access_ReadWrite, File::create_Auto, 0); // Throws
+    if (uint64_t(file.get_size()) < file_size)
+        file.resize(File::SizeType(file_size)); // Throws
+
+    std::unique_ptr<char[]> buffer(new char[1024 * 1024]); // Throws
+    for (;;) {
+        uint64_t record[2];
+        read(record, sizeof record);
+        uint64_t ref = record[0], size = record[1];
+        if (size == 0)
+            break;
+        if (ref < sizeof header || ref > file_size || size > file_size - ref)
+            bad_increment();
+        file.seek(File::SizeType(ref)); // Throws
+        while (size > 0) {
+            size_t chunk_size = size_t(std::min<uint64_t>(size, 1024 * 1024));
+            read(buffer.get(), chunk_size);
+            file.write(buffer.get(), chunk_size); // Throws
+            size -= chunk_size;
+        }
+    }
+
+    // Make sure that the arrays are on stable storage before the header
+    // selects them
+    bool disable_sync = get_disable_sync_to_disk();
+    if (!disable_sync)
+        file.sync(); // Throws
+    file.seek(0);                                                      // Throws
+    file.write(reinterpret_cast<const char*>(&header), sizeof header); // Throws
+    if (!disable_sync)
+        file.sync(); // Throws
+}
+
+
 void SharedGroup::do_begin_read(VersionID version_id, bool writable)
 {
     // FIXME: BadVersion must be thrown in every case where the specified
@@ -26,6 +26,7 @@
 #include <functional>
 #include <limits>
 #include <realm/util/features.h>
+#include <realm/util/optional.hpp>
 #include <realm/util/thread.hpp>
 #ifndef _WIN32
 #include <realm/util/interprocess_condvar.hpp>
@@ -501,6 +502,29 @@ public:
     // Release pinned version (not thread safe)
     void unpin_version(VersionID version);
 
+    /// Write the arrays of the version of the current read transaction that
+    /// are not part of version `base` to `out`, as an increment that
+    /// apply_increment() can apply to a copy of the file as it was at `base`
+    /// to bring it to the current version. If `base` is none, all arrays are
+    /// written, and the increment can be applied to an empty file.
+    ///
+    /// Only the subtrees whose roots lie in space that was free in `base`, or
+    /// beyond its end, are visited, so the time and size of the increment
+    /// depend only on how much has changed. This requires that no space used
+    /// by `base` has been reused, so `base` must be pinned, see pin_version(),
+    /// from when it was the current version until the increment is written.
+    /// An incremental backup thus pins the version it writes, and unpins the
+    /// previous one.
+    ///
+    /// Increments cannot be written for encrypted files.
+    void write_increment(std::ostream& out, util::Optional<VersionID> base = util::none);
+
+    /// Apply an increment written by write_increment() to the file at `path`,
+    /// which is created if it does not exist. The arrays are written before
+    /// the file header, so if this fails, the file is still a valid copy of the
+    /// base version. Throws std::runtime_error if `in` is not an increment.
+    static void apply_increment(std::istream& in, const std::string& path);
+
 private:
     struct SharedInfo;
     struct ReadCount;
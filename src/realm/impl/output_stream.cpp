@@ -16,10 +16,14 @@
  *
  **************************************************************************/
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <stdexcept>
 
+#include <realm/array.hpp>
 #include <realm/util/safe_int_ops.hpp>
+#include <realm/util/thread.hpp>
 #include <realm/impl/output_stream.hpp>
 
 using namespace realm;
@@ -46,11 +50,22 @@ ref_type OutputStream::write_array(const char* data, size_t size, uint32_t check
     size_t size_1 = size;
 
     const char* cksum_bytes = reinterpret_cast<const char*>(&checksum);
-    m_out.write(cksum_bytes, 4); // Throws
     data_1 += 4;
     size_1 -= 4;
 
-    do_write(data_1, size_1); // Throws
+    if (m_snapshot) {
+        m_snapshot->append(cksum_bytes, 4); // Throws
+        if (m_borrow_arrays && !Array::get_hasrefs_from_header(data)) {
+            m_snapshot->append_borrowed(data_1, size_1); // Throws
+        }
+        else {
+            m_snapshot->append(data_1, size_1); // Throws
+        }
+    }
+    else {
+        m_out->write(cksum_bytes, 4); // Throws
+        do_write(data_1, size_1);     // Throws
+    }
 
     ref_type ref = m_next_ref;
     if (int_add_with_overflow_detect(m_next_ref, size))
@@ -62,6 +77,11 @@ ref_type OutputStream::write_array(const char* data, size_t size, uint32_t check
 
 void OutputStream::do_write(const char* data, size_t size)
 {
+    if (m_snapshot) {
+        m_snapshot->append(data, size); // Throws
+        return;
+    }
+
     const char* data_1 = data;
     size_t size_1 = size;
 
@@ -71,10 +91,90 @@ void OutputStream::do_write(const char* data, size_t size)
     if (int_less_than(max_streamsize, max_put))
         max_put = size_t(max_streamsize);
     while (max_put < size_1) {
-        m_out.write(data_1, max_put); // Throws
+        m_out->write(data_1, max_put); // Throws
         data_1 += max_put;
         size_1 -= max_put;
     }
 
-    m_out.write(data_1, size_1); // Throws
+    m_out->write(data_1, size_1); // Throws
+}
+
+
+void StreamSnapshot::copy_to(std::ostream& out) const
+{
+    for (const Piece& piece : m_pieces) {
+        const char* data = piece.data ? piece.data : m_owned.data() + piece.owned_offset;
+        out.write(data, std::streamsize(piece.size)); // Throws
+    }
+}
+
+
+void StreamSnapshot::copy_to(char* buffer, size_t thread_count) const
+{
+    // Parts whose thread cannot be started are copied by the calling thread
+    size_t part_count = std::max(std::min(thread_count, m_size / 4096), size_t(1));
+    size_t part_size = (m_size + part_count - 1) / part_count;
+    auto copy = [=](size_t part) noexcept {
+        size_t begin = std::min(part * part_size, m_size);
+        copy_part(buffer, begin, std::min(begin + part_size, m_size));
+    };
+    std::vector<Thread> threads(part_count - 1);
+    size_t started = 0;
+    try {
+        while (started < threads.size()) {
+            size_t part = started + 1;
+            threads[started].start([&copy, part] { copy(part); }); // Throws
+            ++started;
+        }
+    }
+    catch (...) {
+    }
+    for (size_t part = started + 1; part < part_count; ++part)
+        copy(part);
+    copy(0);
+    for (size_t i = 0; i < started; ++i)
+        threads[i].join();
+}
+
+
+void StreamSnapshot::append(const char* data, size_t size)
+{
+    if (size == 0)
+        return;
+    if (int_add_with_overflow_detect(m_size, size))
+        throw std::runtime_error("Stream size overflow");
+    // Consecutive owned bytes form a single piece
+    if (!m_pieces.empty() && !m_pieces.back().data) {
+        m_pieces.back().size += size;
+    }
+    else {
+        m_pieces.push_back(Piece{nullptr, m_owned.size(), size}); // Throws
+        m_offsets.push_back(m_size - size);                       // Throws
+    }
+    m_owned.append(data, size); // Throws
+}
+
+
+void StreamSnapshot::append_borrowed(const char* data, size_t size)
+{
+    if (size == 0)
+        return;
+    if (int_add_with_overflow_detect(m_size, size))
+        throw std::runtime_error("Stream size overflow");
+    m_pieces.push_back(Piece{data, 0, size}); // Throws
+    m_offsets.push_back(m_size - size);       // Throws
+}
+
+
+void StreamSnapshot::copy_part(char* buffer, size_t begin, size_t end) const noexcept
+{
+    // The last piece that starts at or before `begin`
+    size_t i = size_t(std::upper_bound(m_offsets.begin(), m_offsets.end(), begin) - m_offsets.begin()) - 1;
+    for (; i < m_pieces.size() && m_offsets[i] < end; ++i) {
+        const Piece& piece = m_pieces[i];
+        const char* data = piece.data ? piece.data : m_owned.data() + piece.owned_offset;
+        size_t piece_begin = std::max(m_offsets[i], begin);
+        size_t piece_end = std::min(m_offsets[i] + piece.size, end);
+        std::memcpy(buffer + piece_begin, data + (piece_begin - m_offsets[i]), piece_end - piece_begin);
+    }
 }
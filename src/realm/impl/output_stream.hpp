@@ -21,6 +21,8 @@
 
 #include <cstddef>
 #include <ostream>
+#include <string>
+#include <vector>
 
 #include <cstdint>
 
@@ -32,20 +34,77 @@ namespace realm {
 namespace _impl {
 
 
+/// The bytes written through an OutputStream that writes to a snapshot, see
+/// OutputStream::OutputStream(StreamSnapshot&), in a form that can be copied to
+/// their destination in parts.
+///
+/// Arrays that are borrowed, see OutputStream::set_borrow_arrays(), are not
+/// copied into the snapshot, but referred to where they are, so they must
+/// neither change nor move until the snapshot has been copied.
+class StreamSnapshot {
+public:
+    StreamSnapshot() noexcept;
+    ~StreamSnapshot() noexcept;
+
+    /// The number of bytes written to the snapshot.
+    size_t size() const noexcept;
+
+    void copy_to(std::ostream&) const;
+
+    /// Copy the bytes to `buffer`, which must have room for size() bytes. The
+    /// copy is split into `thread_count` parts of equal size that are copied at
+    /// the same time, one by the calling thread, and each by a thread of its
+    /// own.
+    void copy_to(char* buffer, size_t thread_count = 1) const;
+
+private:
+    // A part of the snapshot, which is either `size` bytes at `data`, or if
+    // `data` is null, `size` bytes at `owned_offset` in `m_owned`
+    struct Piece {
+        const char* data;
+        size_t owned_offset;
+        size_t size;
+    };
+
+    std::vector<Piece> m_pieces;
+    std::vector<size_t> m_offsets; // Offset of each piece in the snapshot
+    std::string m_owned;
+    size_t m_size;
+
+    void append(const char* data, size_t size);
+    void append_borrowed(const char* data, size_t size);
+    void copy_part(char* buffer, size_t begin, size_t end) const noexcept;
+
+    friend class OutputStream;
+};
+
+
 class OutputStream : public ArrayWriterBase {
 public:
     OutputStream(std::ostream&);
+
+    /// Write to `snapshot` instead of a stream.
+    OutputStream(StreamSnapshot& snapshot);
+
     ~OutputStream() noexcept;
 
     ref_type get_ref_of_next_array() const noexcept;
 
+    /// When writing to a snapshot, borrow the arrays without refs that are
+    /// written from now on instead of copying them, see StreamSnapshot. Arrays
+    /// with refs are always copied, as Array::write() writes new versions of
+    /// them from temporary memory.
+    void set_borrow_arrays(bool value) noexcept;
+
     void write(const char* data, size_t size);
 
     ref_type write_array(const char* data, size_t size, uint32_t checksum) override;
 
 private:
     ref_type m_next_ref;
-    std::ostream& m_out;
+    std::ostream* m_out;
+    StreamSnapshot* m_snapshot;
+    bool m_borrow_arrays;
 
     void do_write(const char* data, size_t size);
 };
@@ -53,9 +112,33 @@ private:
 
 // Implementation:
 
+inline StreamSnapshot::StreamSnapshot() noexcept
+    : m_size(0)
+{
+}
+
+inline StreamSnapshot::~StreamSnapshot() noexcept
+{
+}
+
+inline size_t StreamSnapshot::size() const noexcept
+{
+    return m_size;
+}
+
 inline OutputStream::OutputStream(std::ostream& out)
     : m_next_ref(0)
-    , m_out(out)
+    , m_out(&out)
+    , m_snapshot(nullptr)
+    , m_borrow_arrays(false)
+{
+}
+
+inline OutputStream::OutputStream(StreamSnapshot& snapshot)
+    : m_next_ref(0)
+    , m_out(nullptr)
+    , m_snapshot(&snapshot)
+    , m_borrow_arrays(false)
 {
 }
 
@@ -68,6 +151,11 @@ inline size_t OutputStream::get_ref_of_next_array() const noexcept
     return m_next_ref;
 }
 
+inline void OutputStream::set_borrow_arrays(bool value) noexcept
+{
+    m_borrow_arrays = value;
+}
+
 
 } // namespace _impl
 } // namespace realm
@@ -18,6 +18,8 @@
 
 // Test tool in test/test_csv/test.pl
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <limits>
 #include <sstream>
@@ -25,6 +27,9 @@
 #include <vector>
 
 #include <realm/util/assert.hpp>
+#include <realm/util/file.hpp>
+#include <realm/util/ordered_pipeline.hpp>
+#include <realm/column_string.hpp>
 #include <realm/importer.hpp>
 
 using namespace realm;
@@ -127,12 +132,119 @@ bool is_null(const char* v)
     return false;
 }
 
+// Returns the first separator or line break in [begin, end), or `end` if there is none. Eight bytes are tested at a
+// time, using that `(x - 0x01..01) & ~x & 0x80..80` is non-zero if and only if one of the bytes of `x` is zero.
+const char* find_field_end(const char* begin, const char* end, char separator)
+{
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    const uint64_t separators = ones * static_cast<unsigned char>(separator);
+    const uint64_t line_feeds = ones * 0xa;
+    const uint64_t carriage_returns = ones * 0xd;
+    auto has_zero = [&](uint64_t x) { return (x - ones) & ~x & highs; };
+
+    const char* p = begin;
+    while (end - p >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        if (has_zero(word ^ separators) | has_zero(word ^ line_feeds) | has_zero(word ^ carriage_returns))
+            break;
+        p += 8;
+    }
+    while (p != end && *p != separator && *p != 0xd && *p != 0xa)
+        ++p;
+    return p;
+}
+
+// Returns the end of the first line break that is not inside a quoted field, at least `size` bytes after `begin`, or
+// `end` if there is none. The quotes up to that point are counted first, so that the search for a line break can
+// start in the middle of the data. `begin` must not be inside a quoted field.
+//
+// The split point is only a guess. Quote parity is wrong if a double-quote occurs inside a non-quoted field, and a
+// non-quoted line break does not always end a record, so a split point may fall inside a record. The importer
+// detects this, and splits the rest of the data again from where the previous record actually ended.
+const char* find_split(const char* begin, const char* end, size_t size)
+{
+    if (size_t(end - begin) <= size)
+        return end;
+    const char* p = begin + size;
+    bool in_quotes = (std::count(begin, p, '"') & 1) != 0;
+    while (p != end && (in_quotes || (*p != 0xd && *p != 0xa))) {
+        if (*p == '"')
+            in_quotes = !in_quotes;
+        ++p;
+    }
+    if (p == end)
+        return end;
+    ++p;
+    if (p != end && (*p == 0xd || *p == 0xa))
+        ++p;
+    return p;
+}
+
 } // anonymous namespace
 
 
+// The values of the fields of a piece of a csv file, parsed by one thread
+struct Importer::Chunk {
+    struct Column {
+        std::vector<int64_t> ints; // Also bools
+        std::vector<float> floats;
+        std::vector<double> doubles;
+        std::string strings;             // String values back to back
+        std::vector<size_t> string_ends; // End of each value in `strings`
+    };
+
+    // The records that start in [begin, end) are parsed. The last one may continue beyond `end`, so parse_chunk()
+    // sets `end` to where the last record parsed actually ends.
+    const char* begin;
+    const char* end;
+    size_t row_count;
+    std::vector<Column> columns;
+
+    // The first row that could not be imported. Either field `failed_column` could not be parsed as the type of its
+    // column, or the record that begins at `failed_record` has the wrong number of fields.
+    size_t failed_row;
+    size_t failed_column;
+    std::string failed_field;
+    const char* failed_record;
+
+    void reset(size_t column_count)
+    {
+        row_count = 0;
+        columns.resize(column_count);
+        for (Column& column : columns) {
+            column.ints.clear();
+            column.floats.clear();
+            column.doubles.clear();
+            column.strings.clear();
+            column.string_ends.clear();
+        }
+        failed_row = size_t(-1);
+        failed_record = nullptr;
+    }
+};
+
+
+size_t Importer::read(char* buffer, size_t size)
+{
+    if (m_file)
+        return fread(buffer, 1, size, m_file);
+
+    size = std::min(size, size_t(m_input_end - m_input_pos));
+    std::memcpy(buffer, m_input_pos, size);
+    m_input_pos += size;
+    return size;
+}
+
 Importer::Importer()
     : Quiet(false)
     , Separator(',')
+    , Threads(1)
+    , m_file(nullptr)
+    , m_input(nullptr)
+    , m_input_pos(nullptr)
+    , m_input_end(nullptr)
 {
 }
 
@@ -444,7 +556,7 @@ nextrecord:
     if (m_top - m_curpos < chunk_size / 2) {
         memmove(src, src + m_curpos, m_top - m_curpos);
         m_top -= m_curpos;
-        size_t r = fread(src + m_top, 1, chunk_size / 2, m_file);
+        size_t r = read(src + m_top, chunk_size / 2);
         m_top += r;
         m_curpos = 0;
         if (r != chunk_size / 2) {
@@ -549,6 +661,40 @@ end:
     return payload.size() - original_size;
 }
 
+void Importer::parse_error(Table& table, const std::vector<DataType>& scheme, size_t col, size_t row,
+                           const std::string& field, size_t type_detection_rows)
+{
+    // Remove all columns so that user can call csv_import() on it again
+    table.clear();
+
+    for (size_t t = 0; t < table.get_column_count(); t++)
+        table.remove_column(0);
+
+    std::stringstream sstm;
+
+    if (type_detection_rows > 0) {
+        if (scheme[col] != type_String && is_null(field.c_str()) && Empty_as_string)
+            sstm << "Column " << col << " was auto detected to be of type " << DataTypeToText(scheme[col])
+                 << " using the first " << type_detection_rows << " rows of CSV file, but in row " << row
+                 << " of cvs file the field contained the NULL value '" << field.c_str()
+                 << "'. Please increase the 'type_detection_rows' argument or set "
+                 << "Empty_as_string = false/void the -e flag to convert such fields to 0, 0.0 or "
+                    "false";
+        else
+            sstm << "Column " << col << " was auto detected to be of type " << DataTypeToText(scheme[col])
+                 << " using the first " << type_detection_rows << " rows of CSV file, but in row " << row
+                 << " of cvs file the field contained '" << field.c_str()
+                 << "' which is of another type. Please increase the 'type_detection_rows' argument";
+    }
+    else
+        sstm << "Column " << col << " was specified to be of type " << DataTypeToText(scheme[col]) << ", but in row "
+             << row << " of cvs file,"
+             << "the field contained '" << field.c_str() << "' which is of another type";
+
+    throw std::runtime_error(sstm.str());
+}
+
+// Reads from `file`, or from the memory mapped file set up by import_csv(path, ...) if `file` is null
 size_t Importer::import_csv(FILE* file, Table& table, std::vector<DataType>* import_scheme,
                             std::vector<std::string>* column_names, size_t type_detection_rows,
                             size_t skip_first_rows, size_t import_rows)
@@ -657,6 +803,9 @@ size_t Importer::import_csv(FILE* file, Table& table, std::vector<DataType>* imp
         payload.clear();
     }
 
+    if (!m_file)
+        return import_chunks(table, scheme, payload, type_detection_rows, import_rows);
+
     do {
         for (size_t row = 0; row < payload.size(); row++) {
 
@@ -686,38 +835,8 @@ size_t Importer::import_csv(FILE* file, Table& table, std::vector<DataType>* imp
                 else
                     REALM_ASSERT(false);
 
-                if (!success) {
-                    // Remove all columns so that user can call csv_import() on it again
-                    table.clear();
-
-                    for (size_t t = 0; t < table.get_column_count(); t++)
-                        table.remove_column(0);
-
-                    std::stringstream sstm;
-
-                    if (type_detection_rows > 0) {
-                        if (scheme[col] != type_String && is_null(payload[row][col].c_str()) && Empty_as_string)
-                            sstm << "Column " << col << " was auto detected to be of type "
-                                 << DataTypeToText(scheme[col]) << " using the first " << type_detection_rows
-                                 << " rows of CSV file, but in row " << imported_rows
-                                 << " of cvs file the field contained the NULL value '" << payload[row][col].c_str()
-                                 << "'. Please increase the 'type_detection_rows' argument or set "
-                                 << "Empty_as_string = false/void the -e flag to convert such fields to 0, 0.0 or "
-                                    "false";
-                        else
-                            sstm << "Column " << col << " was auto detected to be of type "
-                                 << DataTypeToText(scheme[col]) << " using the first " << type_detection_rows
-                                 << " rows of CSV file, but in row " << imported_rows
-                                 << " of cvs file the field contained '" << payload[row][col].c_str()
-                                 << "' which is of another type. Please increase the 'type_detection_rows' argument";
-                    }
-                    else
-                        sstm << "Column " << col << " was specified to be of type " << DataTypeToText(scheme[col])
-                             << ", but in row " << imported_rows << " of cvs file,"
-                             << "the field contained '" << payload[row][col].c_str() << "' which is of another type";
-
-                    throw std::runtime_error(sstm.str());
-                }
+                if (!success)
+                    parse_error(table, scheme, col, imported_rows, payload[row][col], type_detection_rows);
             }
 
 
@@ -747,3 +866,306 @@ size_t Importer::import_csv_manual(FILE* file, Table& table, std::vector<DataTyp
 {
     return import_csv(file, table, &scheme, &column_names, 0, skip_first_rows, import_rows);
 }
+
+size_t Importer::import_csv_auto(const std::string& path, Table& table, size_t type_detection_rows,
+                                 size_t import_rows)
+{
+    return import_csv(path, table, nullptr, nullptr, type_detection_rows, 0, import_rows);
+}
+
+size_t Importer::import_csv_manual(const std::string& path, Table& table, std::vector<DataType> scheme,
+                                   std::vector<std::string> column_names, size_t skip_first_rows, size_t import_rows)
+{
+    return import_csv(path, table, &scheme, &column_names, 0, skip_first_rows, import_rows);
+}
+
+size_t Importer::import_csv(const std::string& path, Table& table, std::vector<DataType>* import_scheme,
+                            std::vector<std::string>* column_names, size_t type_detection_rows,
+                            size_t skip_first_rows, size_t import_rows)
+{
+    util::File file(path, util::File::mode_Read);
+    size_t size = size_t(file.get_size());
+    if (size == 0)
+        throw std::runtime_error("The csv file '" + path + "' is empty");
+
+    util::File::Map<char> map(file, util::File::access_ReadOnly, size);
+    m_input = map.get_addr();
+    m_input_pos = m_input;
+    m_input_end = m_input + size;
+    return import_csv(nullptr, table, import_scheme, column_names, type_detection_rows, skip_first_rows,
+                      import_rows);
+}
+
+bool Importer::parse_field(Chunk& chunk, size_t col, DataType type, const std::string& field)
+{
+    Chunk::Column& column = chunk.columns[col];
+    bool success = true;
+    switch (type) {
+        case type_String:
+            column.strings.append(field);
+            column.string_ends.push_back(column.strings.size());
+            break;
+        case type_Int:
+            column.ints.push_back(parse_integer<true>(field.c_str(), &success));
+            break;
+        case type_Bool:
+            column.ints.push_back(parse_bool<true>(field.c_str(), &success));
+            break;
+        case type_Float:
+            column.floats.push_back(parse_float<true>(field.c_str(), &success));
+            break;
+        case type_Double:
+            column.doubles.push_back(parse_double<true>(field.c_str(), &success));
+            break;
+        default:
+            REALM_ASSERT(false);
+    }
+    if (!success) {
+        chunk.failed_row = chunk.row_count;
+        chunk.failed_column = col;
+        chunk.failed_field = field;
+    }
+    return success;
+}
+
+// Tokenizes the records that start in [chunk.begin, chunk.end) like tokenize() does, and parses their fields. If
+// `chunk.begin` is the start of a record, the result is the same as that of the FILE* path. Stops at the first record
+// that cannot be imported.
+void Importer::parse_chunk(Chunk& chunk, const std::vector<DataType>& scheme)
+{
+    size_t column_count = scheme.size();
+    chunk.reset(column_count);
+
+    std::string field;
+    const char* p = chunk.begin;
+    const char* end = m_input_end;
+    while (p < chunk.end) {
+        const char* record = p;
+        size_t fields = 0;
+        for (;;) {
+            field.clear();
+            while (p != end && *p == ' ')
+                ++p;
+
+            if (p != end && *p == '"') {
+                // Field in quotes - can only end with another quote
+                ++p;
+                for (;;) {
+                    const char* quote = static_cast<const char*>(std::memchr(p, '"', size_t(end - p)));
+                    if (!quote) {
+                        field.append(p, end);
+                        p = end;
+                        break;
+                    }
+                    field.append(p, quote);
+                    p = quote + 1;
+                    if (p == end || *p != '"')
+                        break;
+                    // Double-quote
+                    field.push_back('"');
+                    ++p;
+                }
+                while (p != end && *p == ' ')
+                    ++p;
+            }
+            else {
+                // Field not in quotes. Line breaks are part of the field as long as the record has too few fields
+                const char* field_end = find_field_end(p, end, Separator);
+                while (field_end != end && *field_end != Separator && m_fields != size_t(-1) &&
+                       fields + 1 < m_fields)
+                    field_end = find_field_end(field_end + 1, end, Separator);
+                field.append(p, field_end);
+                p = field_end;
+            }
+
+            if (fields < column_count && !parse_field(chunk, fields, scheme[fields], field))
+                return;
+            ++fields;
+
+            if (p == end || *p == 0xd || *p == 0xa)
+                break;
+            if (*p == Separator)
+                ++p;
+        }
+
+        if (p != end) {
+            ++p;
+            if (p != end && (*p == 0xd || *p == 0xa))
+                ++p;
+        }
+
+        if (fields != column_count) {
+            chunk.failed_row = chunk.row_count;
+            chunk.failed_record = record;
+            return;
+        }
+        ++chunk.row_count;
+    }
+    chunk.end = p;
+}
+
+// Appends the rows of `chunk` to the table, column by column, and returns the number of rows appended. If the table
+// is not replicated, the values are set directly in the columns.
+size_t Importer::append_chunk(Table& table, const std::vector<DataType>& scheme, const Chunk& chunk,
+                              size_t imported_rows, size_t type_detection_rows, size_t import_rows)
+{
+    size_t row_count = std::min(chunk.row_count, import_rows - imported_rows);
+    if (chunk.failed_row < import_rows - imported_rows) {
+        if (chunk.failed_record) {
+            const char* record = chunk.failed_record;
+            size_t line = 1 + size_t(std::count(m_input, record, 0xa));
+            char buf[500];
+            std::string s(record, std::min(find_field_end(record, m_input_end, Separator), record + 100));
+            sprintf(buf, "Wrong number of delimitors around line %lld (+|- 3) in csv file. First few characters "
+                         "of line: %s",
+                    static_cast<unsigned long long>(line), s.c_str());
+            throw std::runtime_error(buf);
+        }
+        parse_error(table, scheme, chunk.failed_column, imported_rows + chunk.failed_row, chunk.failed_field,
+                    type_detection_rows);
+    }
+
+    size_t first_row = table.size();
+    table.add_empty_row(row_count);
+    bool direct = !_impl::TableFriend::get_repl(table);
+    for (size_t col = 0; col < scheme.size(); col++) {
+        const Chunk::Column& values = chunk.columns[col];
+        ColumnBase& column = _impl::TableFriend::get_column(table, col);
+        switch (scheme[col]) {
+            case type_String: {
+                StringColumn& strings = static_cast<StringColumn&>(column);
+                size_t begin = 0;
+                for (size_t i = 0; i < row_count; ++i) {
+                    size_t end = values.string_ends[i];
+                    StringData value(values.strings.data() + begin, end - begin);
+                    if (direct)
+                        strings.set(first_row + i, value);
+                    else
+                        table.set_string(col, first_row + i, value);
+                    begin = end;
+                }
+                break;
+            }
+            case type_Int:
+                for (size_t i = 0; i < row_count; ++i) {
+                    if (direct)
+                        static_cast<IntegerColumn&>(column).set(first_row + i, values.ints[i]);
+                    else
+                        table.set_int(col, first_row + i, values.ints[i]);
+                }
+                break;
+            case type_Bool:
+                for (size_t i = 0; i < row_count; ++i) {
+                    if (direct)
+                        static_cast<IntegerColumn&>(column).set(first_row + i, values.ints[i]);
+                    else
+                        table.set_bool(col, first_row + i, values.ints[i] != 0);
+                }
+                break;
+            case type_Float:
+                for (size_t i = 0; i < row_count; ++i) {
+                    if (direct)
+                        static_cast<FloatColumn&>(column).set(first_row + i, values.floats[i]);
+                    else
+                        table.set_float(col, first_row + i, values.floats[i]);
+                }
+                break;
+            case type_Double:
+                for (size_t i = 0; i < row_count; ++i) {
+                    if (direct)
+                        static_cast<DoubleColumn&>(column).set(first_row + i, values.doubles[i]);
+                    else
+                        table.set_double(col, first_row + i, values.doubles[i]);
+                }
+                break;
+            default:
+                REALM_ASSERT(false);
+        }
+    }
+
+    if (!Quiet) {
+        for (size_t row = imported_rows; row < imported_rows + row_count && row <= 11; ++row) {
+            if (row < 10)
+                print_row(table, first_row + row - imported_rows);
+            else if (row == 11)
+                std::cout << "\nOnly showing first few rows...\n";
+        }
+        std::cout << imported_rows + row_count << " rows\r";
+    }
+    return row_count;
+}
+
+// Imports the rows already tokenized in `payload`, followed by the rest of the memory mapped file. The rest is split
+// into chunks, which are parsed by worker threads while the calling thread appends them to the table in order, see
+// util::run_ordered_pipeline().
+//
+// A chunk is only appended if it begins where the previous one ended. Otherwise it was split inside a record, and the
+// rest of the data is split again from the end of the previous one, so that the result is always the same as that of
+// the FILE* path.
+size_t Importer::import_chunks(Table& table, const std::vector<DataType>& scheme,
+                               const std::vector<std::vector<std::string>>& payload, size_t type_detection_rows,
+                               size_t import_rows)
+{
+    size_t imported_rows = 0;
+    {
+        Chunk chunk;
+        chunk.reset(scheme.size());
+        for (const std::vector<std::string>& record : payload) {
+            bool success = true;
+            for (size_t col = 0; col < scheme.size() && success; col++)
+                success = parse_field(chunk, col, scheme[col], record[col]);
+            if (!success)
+                break;
+            ++chunk.row_count;
+        }
+        imported_rows += append_chunk(table, scheme, chunk, imported_rows, type_detection_rows, import_rows);
+    }
+
+    // Bytes left in the tokenizer buffer have not been imported yet
+    const char* record = m_input_pos - (m_top - m_curpos); // Where the next record to be appended begins
+    size_t thread_count = std::max(Threads, size_t(1));
+
+    if (thread_count == 1) {
+        Chunk chunk;
+        while (record != m_input_end && imported_rows < import_rows) {
+            chunk.begin = record;
+            chunk.end = find_split(record, m_input_end, parallel_chunk_size);
+            parse_chunk(chunk, scheme);
+            imported_rows += append_chunk(table, scheme, chunk, imported_rows, type_detection_rows, import_rows);
+            record = chunk.end;
+        }
+        return imported_rows;
+    }
+
+    // Each round splits the data from `record` as the chunks are claimed, and ends at the first chunk that does not
+    // begin where the previous one ended. No chunk is smaller than `parallel_chunk_size`, except the last one, so
+    // `chunk_count` is enough to cover the data. Chunks beyond its end are empty.
+    std::vector<Chunk> slots(util::get_pipeline_slot_count(thread_count));
+    std::vector<const char*> splits;
+    util::Mutex splits_mutex;
+    auto parse = [&](size_t chunk_ndx, size_t slot) {
+        Chunk& chunk = slots[slot];
+        {
+            util::LockGuard lock(splits_mutex);
+            while (splits.size() < chunk_ndx + 2)
+                splits.push_back(find_split(splits.back(), m_input_end, parallel_chunk_size));
+            chunk.begin = splits[chunk_ndx];
+            chunk.end = splits[chunk_ndx + 1];
+        }
+        parse_chunk(chunk, scheme);
+    };
+    auto append = [&](size_t, size_t slot) {
+        const Chunk& chunk = slots[slot];
+        if (chunk.begin != record)
+            return false;
+        imported_rows += append_chunk(table, scheme, chunk, imported_rows, type_detection_rows, import_rows);
+        record = chunk.end;
+        return imported_rows < import_rows;
+    };
+    while (record != m_input_end && imported_rows < import_rows) {
+        splits.assign(1, record);
+        size_t chunk_count = (size_t(m_input_end - record) + parallel_chunk_size - 1) / parallel_chunk_size;
+        util::run_ordered_pipeline(chunk_count, std::min(thread_count, chunk_count), parse, append);
+    }
+    return imported_rows;
+}
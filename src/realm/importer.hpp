@@ -65,6 +65,14 @@ import_csv(csv file handle, realm table)
         rows and columns of the chunk payload
     Calls parse_float(), parse_bool(), etc, which tests for type and returns converted values
     Calls table.add_empty_row(), table.set_float(), table.set_bool()
+
+import_csv(path of csv file, realm table)
+    Memory maps the file and detects the header and scheme like above, from the first rows only. The rest of the
+    file is split into pieces of about parallel_chunk_size bytes that end at line breaks outside of quoted fields.
+    The pieces are tokenized and parsed on `Threads` threads into one vector of values per column, and appended to
+    the table in order, column by column. The split points are found by counting double-quotes, which is wrong if
+    a non-quoted field contains a double-quote or a line break. A piece that does not begin where the previous one
+    ended is therefore parsed again, so the result is always the same as when importing from a FILE*.
 */
 
 #include <cstddef>
@@ -79,6 +87,10 @@ static const size_t chunk_size = 32 * 1024;
 // Number of rows to csv-parse + insert into realm in each iteration.
 static const size_t record_chunks = 100;
 
+// Size of the pieces a memory mapped csv file is split into for parsing on multiple threads. Each piece ends at the
+// end of a record.
+static const size_t parallel_chunk_size = 1024 * 1024;
+
 // Width of each column when printing them on screen (non-Quiet mode)
 const size_t print_width = 25;
 
@@ -97,14 +109,38 @@ public:
                              std::vector<std::string> column_names, size_t skip_first_rows = 0,
                              size_t import_rows = static_cast<size_t>(-1));
 
+    // Import the csv file at `path`, using `Threads` threads
+    size_t import_csv_auto(const std::string& path, Table& table, size_t type_detection_rows = 1000,
+                           size_t import_rows = static_cast<size_t>(-1));
+
+    size_t import_csv_manual(const std::string& path, Table& table, std::vector<DataType> scheme,
+                             std::vector<std::string> column_names, size_t skip_first_rows = 0,
+                             size_t import_rows = static_cast<size_t>(-1));
+
     bool Quiet;           // Quiet mode, only print to screen upon errors
     char Separator;       // csv delimitor/separator
     bool Empty_as_string; // Import columns that have occurences of empty strings as String type column
+    size_t Threads;       // Number of threads parsing a csv file that is imported from a path
 
 private:
+    struct Chunk;
+
     size_t import_csv(FILE* file, Table& table, std::vector<DataType>* import_scheme,
                       std::vector<std::string>* column_names, size_t type_detection_rows, size_t skip_first_rows,
                       size_t import_rows);
+    size_t import_csv(const std::string& path, Table& table, std::vector<DataType>* import_scheme,
+                      std::vector<std::string>* column_names, size_t type_detection_rows, size_t skip_first_rows,
+                      size_t import_rows);
+    size_t import_chunks(Table& table, const std::vector<DataType>& scheme,
+                         const std::vector<std::vector<std::string>>& payload, size_t type_detection_rows,
+                         size_t import_rows);
+    void parse_chunk(Chunk& chunk, const std::vector<DataType>& scheme);
+    bool parse_field(Chunk& chunk, size_t col, DataType type, const std::string& field);
+    size_t append_chunk(Table& table, const std::vector<DataType>& scheme, const Chunk& chunk, size_t imported_rows,
+                        size_t type_detection_rows, size_t import_rows);
+    REALM_NORETURN void parse_error(Table& table, const std::vector<DataType>& scheme, size_t col, size_t row,
+                                    const std::string& field, size_t type_detection_rows);
+    size_t read(char* buffer, size_t size);
     template <bool can_fail>
     float parse_float(const char* col, bool* success = nullptr);
     template <bool can_fail>
@@ -121,7 +157,10 @@ private:
     char src[2 * chunk_size]; // .csv input buffer
     size_t m_top;             // points at top of buffer
     size_t m_curpos;          // points at next byte to parse
-    FILE* m_file;             // handle to .csv file
+    FILE* m_file;             // handle to .csv file, or null if reading from a memory mapped file
+    const char* m_input;      // start of memory mapped .csv file
+    const char* m_input_pos;  // next byte to read from memory mapped .csv file
+    const char* m_input_end;  // end of memory mapped .csv file
     size_t m_fields;          // number of fields in each row
     size_t m_row;             // current row in .csv file, including field-embedded line breaks. Used for err msg only
 };
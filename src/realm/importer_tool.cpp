@@ -26,6 +26,7 @@
 #include <realm/utilities.hpp>
 #include <realm/importer.hpp>
 #include <cstdarg>
+#include <thread>
 
 using namespace realm;
 
@@ -39,13 +40,14 @@ char separator_flag = ',';
 bool force_flag = false;
 bool quiet_flag = false;
 bool empty_as_string_flag = false;
+size_t threads_flag = 0;
 
 const char* legend =
     "Simple auto-import (works in most cases):\n"
     "  csv <.csv file | -stdin> <.realm file>\n"
     "\n"
     "Advanced auto-detection of scheme:\n"
-    "  csv [-a=N] [-n=N] [-e] [-f] [-q] [-l tablename] <.csv file | -stdin> <.realm file>\n"
+    "  csv [-a=N] [-n=N] [-j=N] [-e] [-f] [-q] [-l tablename] <.csv file | -stdin> <.realm file>\n"
     "\n"
     "Manual specification of scheme:\n"
     "  csv -t={s|i|b|f|d}{s|i|b|f|d}... name1 name2 ... [-s=N] [-n=N] <.csv file | -stdin> <.realm file>\n"
@@ -54,6 +56,7 @@ const char* legend =
     " -e: Realm does not support null values. Set the -e flag to import a column as a String type column if\n"
     "     it has occurences of empty fields. Otherwise empty fields may be converted to 0, 0.0 or false\n"
     " -n: Only import first N rows of payload\n"
+    " -j: Parse the .csv file on N threads (default is the number of cores). Ignored with -stdin\n"
     " -t: List of column types where s=string, i=integer, b=bool, f=float, d=double\n"
     " -s: Skip first N rows (can be used to skip headers)\n"
     " -q: Quiet, only print upon errors\n"
@@ -123,6 +126,10 @@ int main(int argc, char* argv[])
             skip_rows_flag = atoi(&argv[a][3]);
             abort2(skip_rows_flag == 0, "Invalid value for -s flag");
         }
+        else if (strncmp(argv[a], "-j", 2) == 0) {
+            threads_flag = atoi(&argv[a][3]);
+            abort2(threads_flag == 0, "Invalid value for -j flag");
+        }
         else if (strncmp(argv[a], "-e", 2) == 0)
             empty_as_string_flag = true;
         else if (strncmp(argv[a], "-f", 2) == 0)
@@ -176,7 +183,9 @@ int main(int argc, char* argv[])
     if (util::File::exists(argv[argc - 1]))
         util::File::try_remove(argv[argc - 1]);
 
-    in_file = open_files(argv[argc - 2]);
+    bool from_stdin = strcmp(argv[argc - 2], "-stdin") == 0;
+    if (from_stdin)
+        in_file = open_files(argv[argc - 2]);
     std::string path = argv[argc - 1];
     Group group;
     TableRef table2 = group.add_table(tablename);
@@ -188,19 +197,28 @@ int main(int argc, char* argv[])
     importer.Quiet = quiet_flag;
     importer.Separator = ',';
     importer.Empty_as_string = empty_as_string_flag;
+    importer.Threads = threads_flag ? threads_flag : std::max(std::thread::hardware_concurrency(), 1u);
 
     try {
         if (scheme.size() > 0) {
             // Manual specification of scheme
-            imported_rows = importer.import_csv_manual(in_file, table, scheme, column_names, skip_rows_flag,
-                                                       import_rows_flag ? import_rows_flag : static_cast<size_t>(-1));
+            size_t import_rows = import_rows_flag ? import_rows_flag : static_cast<size_t>(-1);
+            if (from_stdin)
+                imported_rows =
+                    importer.import_csv_manual(in_file, table, scheme, column_names, skip_rows_flag, import_rows);
+            else
+                imported_rows = importer.import_csv_manual(argv[argc - 2], table, scheme, column_names,
+                                                           skip_rows_flag, import_rows);
         }
         else if (argc >= 3) {
             // Auto detection
             abort2(skip_rows_flag > 0, "-s flag cannot be used in Simple auto-import mode");
-            imported_rows =
-                importer.import_csv_auto(in_file, table, auto_detection_flag ? auto_detection_flag : 10000,
-                                         import_rows_flag ? import_rows_flag : static_cast<size_t>(-1));
+            size_t detection_rows = auto_detection_flag ? auto_detection_flag : 10000;
+            size_t import_rows = import_rows_flag ? import_rows_flag : static_cast<size_t>(-1);
+            if (from_stdin)
+                imported_rows = importer.import_csv_auto(in_file, table, detection_rows, import_rows);
+            else
+                imported_rows = importer.import_csv_auto(argv[argc - 2], table, detection_rows, import_rows);
         }
         else {
         }
@@ -16,6 +16,7 @@
  *
  **************************************************************************/
 
+#include <algorithm>
 #include <cstdio>
 #include <iomanip>
 
@@ -28,6 +29,7 @@
 #include <realm/column.hpp>
 #include <realm/column_string.hpp>
 #include <realm/column_timestamp.hpp> // Timestamp
+#include <realm/unicode.hpp>
 
 using namespace realm;
 using namespace realm::util;
@@ -41,6 +43,12 @@ void get_child(Array& parent, size_t child_ref_ndx, Array& child) noexcept
     child.set_parent(&parent, child_ref_ndx);
 }
 
+// The number of bytes skipped by a prefix node is stored as a tagged integer
+size_t get_prefix_size(const char* prefix_node_header) noexcept
+{
+    return size_t(uint64_t(Array::get(prefix_node_header, 0)) >> 1);
+}
+
 } // anonymous namespace
 
 namespace realm {
@@ -280,6 +288,16 @@ size_t IndexArray::index_string(StringData value, IntegerColumn& result, Interna
         }
 
         const char* sub_header = m_alloc.translate(to_ref(ref));
+
+        // Skip the bytes that all rows behind a prefix node have in common. If
+        // `value` does not share them, the final comparison against the target
+        // column will tell.
+        size_t prefix_size = 0;
+        if (StringIndex::is_prefix_node(sub_header)) {
+            prefix_size = get_prefix_size(sub_header);
+            sub_header = m_alloc.translate(to_ref(Array::get(sub_header, 1)));
+        }
+
         const bool sub_isindex = get_context_flag_from_header(sub_header);
 
         // List of row indices with common prefix up to this point, in sorted order.
@@ -298,6 +316,7 @@ size_t IndexArray::index_string(StringData value, IntegerColumn& result, Interna
             stringoffset += 4;
         else
             stringoffset += value.size() - stringoffset + 1;
+        stringoffset += prefix_size;
 
         // Update 4 byte index key
         key = StringIndex::create_key(value, stringoffset);
@@ -369,6 +388,68 @@ StringIndex::key_type StringIndex::get_last_key() const
 }
 
 
+bool StringIndex::is_prefix_node(const char* header) noexcept
+{
+    return Array::get_hasrefs_from_header(header) && !Array::get_context_flag_from_header(header) &&
+           !Array::get_is_inner_bptree_node_from_header(header);
+}
+
+
+size_t StringIndex::get_common_prefix_size(StringData a, StringData b, size_t offset) noexcept
+{
+    if (offset >= a.size() || offset >= b.size())
+        return 0;
+    const char* begin = a.data() + offset;
+    const char* end = begin + (std::min(a.size(), b.size()) - offset);
+    size_t size = size_t(std::mismatch(begin, end, b.data() + offset).first - begin);
+    return size - size % s_index_key_length;
+}
+
+
+ref_type StringIndex::create_prefix_node(size_t prefix_size, ref_type subindex_ref, Allocator& alloc)
+{
+    if (prefix_size == 0)
+        return subindex_ref;
+
+    Array prefix_node(alloc);
+    prefix_node.create(Array::type_HasRefs);                    // Throws
+    prefix_node.add(RefOrTagged::make_tagged(prefix_size));     // Throws
+    prefix_node.add(RefOrTagged::make_ref(subindex_ref));       // Throws
+    return prefix_node.get_ref();
+}
+
+
+size_t StringIndex::get_skippable_prefix_size(StringData a, StringData b, size_t offset) const noexcept
+{
+    if (m_array->get_alloc().get_file_format_version() < 7)
+        return 0;
+    return get_common_prefix_size(a, b, offset);
+}
+
+
+size_t StringIndex::get_any_row(ref_type ref) const
+{
+    Allocator& alloc = m_array->get_alloc();
+    for (;;) {
+        const char* header = alloc.translate(ref);
+        if (is_prefix_node(header)) {
+            ref = to_ref(Array::get(header, 1));
+            continue;
+        }
+        if (!Array::get_context_flag_from_header(header)) {
+            // List of row indexes
+            const IntegerColumn sub(alloc, ref); // Throws
+            return to_size_t(sub.get(0));
+        }
+        // First child of an inner node or of a leaf of a subindex
+        int64_t value = Array::get(header, 1);
+        if ((value & 1) != 0)
+            return to_size_t(uint64_t(value) >> 1);
+        ref = to_ref(value);
+    }
+}
+
+
 void StringIndex::insert_with_offset(size_t row_ndx, StringData value, size_t offset)
 {
     // Create 4 byte index key
@@ -735,7 +816,8 @@ bool StringIndex::leaf_insert(size_t row_ndx, key_type key, size_t offset, Strin
             m_array->set(ins_pos_refs, row_list.get_ref());
         }
         else {
-            if (suboffset > s_max_offset) {
+            size_t prefix_size = get_skippable_prefix_size(value, v2, suboffset);
+            if (suboffset + prefix_size > s_max_offset) {
                 // These strings have the same prefix up to this point but we
                 // don't want to recurse further, create a list in sorted order.
                 bool row_ndx_first = value < v2;
@@ -747,13 +829,16 @@ bool StringIndex::leaf_insert(size_t row_ndx, key_type key, size_t offset, Strin
             }
             else {
                 // These strings have the same prefix up to this point but they
-                // are actually not equal. Extend the tree recursivly until the
-                // prefix of these strings is different.
+                // are actually not equal. Extend the tree with a subindex at
+                // the first key where they differ, and skip the keys in
+                // between with a prefix node.
+                size_t suboffset_2 = suboffset + prefix_size;
                 StringIndex subindex(m_target_column, m_array->get_alloc());
-                subindex.insert_with_offset(row_ndx2, v2, suboffset);
-                subindex.insert_with_offset(row_ndx, value, suboffset);
-                // Join the string of SubIndices to the current position of m_array
-                m_array->set(ins_pos_refs, subindex.get_ref());
+                subindex.insert_with_offset(row_ndx2, v2, suboffset_2);
+                subindex.insert_with_offset(row_ndx, value, suboffset_2);
+                // Join the subindex to the current position of m_array
+                ref_type ref = create_prefix_node(prefix_size, subindex.get_ref(), alloc); // Throws
+                m_array->set(ins_pos_refs, ref);
             }
         }
         return true;
@@ -763,6 +848,45 @@ bool StringIndex::leaf_insert(size_t row_ndx, key_type key, size_t offset, Strin
     // or it has to be split into a subindex
     ref_type ref = to_ref(slot_value);
     char* header = alloc.translate(ref);
+    if (is_prefix_node(header)) {
+        Array prefix_node(alloc);
+        prefix_node.init_from_mem(MemRef(header, ref, alloc));
+        prefix_node.set_parent(m_array.get(), ins_pos_refs);
+        size_t prefix_size = get_prefix_size(header);
+        ref_type subindex_ref = prefix_node.get_as_ref(1);
+
+        // All rows behind the prefix node share the skipped bytes, so any one
+        // of them tells us whether the new value does too.
+        StringConversionBuffer buffer;
+        StringData v2 = get(get_any_row(subindex_ref), buffer);
+        size_t common_prefix_size = get_common_prefix_size(value, v2, suboffset);
+        if (common_prefix_size >= prefix_size) {
+            StringIndex subindex(subindex_ref, &prefix_node, 1, m_target_column, m_deny_duplicate_values, alloc);
+            subindex.insert_with_offset(row_ndx, value, suboffset + prefix_size);
+            return true;
+        }
+
+        // The new value differs from the rows behind the prefix node within the
+        // skipped bytes. Split the prefix node at the first key where they
+        // differ, and keep what remains of it below the new subindex.
+        size_t suboffset_2 = suboffset + common_prefix_size;
+        size_t remaining_prefix_size = prefix_size - common_prefix_size - s_index_key_length;
+        ref_type remaining_ref = subindex_ref;
+        if (remaining_prefix_size == 0) {
+            prefix_node.destroy();
+        }
+        else {
+            prefix_node.set(0, RefOrTagged::make_tagged(remaining_prefix_size)); // Throws
+            remaining_ref = prefix_node.get_ref();
+        }
+        StringIndex subindex(m_target_column, alloc);
+        subindex.insert_row_list(remaining_ref, suboffset_2, v2);
+        subindex.insert_with_offset(row_ndx, value, suboffset_2);
+        ref_type new_ref = create_prefix_node(common_prefix_size, subindex.get_ref(), alloc); // Throws
+        m_array->set(ins_pos_refs, new_ref);
+        return true;
+    }
+
     if (!Array::get_context_flag_from_header(header)) {
         IntegerColumn sub(alloc, ref); // Throws
         sub.set_parent(m_array.get(), ins_pos_refs);
@@ -788,40 +912,27 @@ bool StringIndex::leaf_insert(size_t row_ndx, key_type key, size_t offset, Strin
             insert_to_existing_list_at_lower(row_ndx, value, sub, lower);
         }
         else {
-            if (suboffset > s_max_offset) {
+            // A list that does not only store duplicates holds strings that
+            // share a prefix reaching beyond `s_max_offset`. If the new value
+            // shares that prefix too, we must insert it into the existing
+            // list. Otherwise we are free to branch and create a sub index
+            // with this existing list as one of the leafs, at the first key
+            // where the new value differs from the strings of the list.
+            size_t row_of_any = to_size_t(sub.get(0));
+            // The buffer is needed for when this is an integer index.
+            StringConversionBuffer buffer;
+            StringData v2 = get(row_of_any, buffer);
+            size_t prefix_size = get_skippable_prefix_size(value, v2, suboffset);
+            if (suboffset + prefix_size > s_max_offset) {
                 insert_to_existing_list(row_ndx, value, sub);
             }
             else {
-#ifdef REALM_DEBUG
-                bool contains_only_duplicates = true;
-                if (sub.size() > 1) {
-                    size_t first_ref = to_size_t(sub.get(0));
-                    size_t last_ref = to_size_t(sub.back());
-                    StringIndex::StringConversionBuffer first_buffer, last_buffer;
-                    StringData first_str = get(first_ref, first_buffer);
-                    StringData last_str = get(last_ref, last_buffer);
-                    // Since the list is kept in sorted order, the first and
-                    // last values will be the same only if the whole list is
-                    // storing duplicate values.
-                    if (first_str != last_str) {
-                        contains_only_duplicates = false; // LCOV_EXCL_LINE
-                    }
-                }
-                REALM_ASSERT_DEBUG(contains_only_duplicates);
-#endif
-                // If the list only stores duplicates we are free to branch and
-                // and create a sub index with this existing list as one of the
-                // leafs, but if the list doesn't only contain duplicates we
-                // must respect that we store a common key prefix up to this
-                // point and insert into the existing list.
-                size_t row_of_any_dup = to_size_t(sub.get(0));
-                // The buffer is needed for when this is an integer index.
-                StringConversionBuffer buffer;
-                StringData v2 = get(row_of_any_dup, buffer);
+                size_t suboffset_2 = suboffset + prefix_size;
                 StringIndex subindex(m_target_column, m_array->get_alloc());
-                subindex.insert_row_list(sub.get_ref(), suboffset, v2);
-                subindex.insert_with_offset(row_ndx, value, suboffset);
-                m_array->set(ins_pos_refs, subindex.get_ref());
+                subindex.insert_row_list(sub.get_ref(), suboffset_2, v2);
+                subindex.insert_with_offset(row_ndx, value, suboffset_2);
+                ref_type new_ref = create_prefix_node(prefix_size, subindex.get_ref(), alloc); // Throws
+                m_array->set(ins_pos_refs, new_ref);
             }
         }
         return true;
@@ -860,7 +971,12 @@ void StringIndex::distinct(IntegerColumn& result) const
             else {
                 // A real ref either points to a list or a subindex
                 char* header = alloc.translate(to_ref(ref));
-                if (Array::get_context_flag_from_header(header)) {
+                if (is_prefix_node(header)) {
+                    ref_type subindex_ref = to_ref(Array::get(header, 1));
+                    StringIndex ndx(subindex_ref, nullptr, 0, m_target_column, m_deny_duplicate_values, alloc);
+                    ndx.distinct(result);
+                }
+                else if (Array::get_context_flag_from_header(header)) {
                     StringIndex ndx(to_ref(ref), m_array.get(), i, m_target_column, m_deny_duplicate_values, alloc);
                     ndx.distinct(result);
                 }
@@ -888,6 +1004,168 @@ void StringIndex::distinct(IntegerColumn& result) const
     }
 }
 
+namespace {
+
+// The bytes that each byte of a key must equal, in one case or the other, for
+// the key to be part of a case insensitive match of a value at the specified
+// offset. See StringIndex::create_key(StringData, size_t).
+struct CaseInsensitiveKey {
+    unsigned char bytes_1[StringIndex::s_index_key_length];
+    unsigned char bytes_2[StringIndex::s_index_key_length];
+
+    CaseInsensitiveKey(StringData value, const char* upper, const char* lower, size_t offset) noexcept
+    {
+        for (size_t i = 0; i != StringIndex::s_index_key_length; ++i) {
+            size_t pos = offset + i;
+            if (offset > value.size()) {
+                bytes_1[i] = bytes_2[i] = 0;
+            }
+            else if (pos < value.size()) {
+                bytes_1[i] = static_cast<unsigned char>(upper[pos]);
+                bytes_2[i] = static_cast<unsigned char>(lower[pos]);
+            }
+            else {
+                bytes_1[i] = bytes_2[i] = (pos == value.size() ? 'X' : 0);
+            }
+        }
+    }
+
+    /// Stores the distinct keys that consist of one of the two bytes at each
+    /// position in \a keys, in ascending order, and returns their number, which
+    /// is at most `s_max_case_variants`.
+    size_t get_variants(StringIndex::key_type* keys) const noexcept
+    {
+        uint_least32_t variants[StringIndex::s_max_case_variants] = {0};
+        size_t count = 1;
+        for (size_t i = 0; i != StringIndex::s_index_key_length; ++i) {
+            size_t n = count;
+            for (size_t j = 0; j != n; ++j) {
+                if (bytes_2[i] != bytes_1[i])
+                    variants[count++] = (variants[j] << 8) | bytes_2[i];
+                variants[j] = (variants[j] << 8) | bytes_1[i];
+            }
+        }
+        for (size_t j = 0; j != count; ++j)
+            keys[j] = StringIndex::key_type(variants[j]);
+        std::sort(keys, keys + count);
+        return count;
+    }
+};
+
+bool equal_case_insensitive(StringData value, const char* upper, const char* lower, StringData str)
+{
+    return !str.is_null() && str.size() == value.size() && equal_case_fold(str, upper, lower);
+}
+
+} // anonymous namespace
+
+
+size_t StringIndex::find_all_case_insensitive(IntegerColumn& result, StringData value, const char* upper,
+                                              const char* lower) const
+{
+    if (value.is_null()) {
+        find_all(result, value);
+        return 0;
+    }
+
+    std::vector<size_t> rows;
+    size_t looked_up = find_all_case_insensitive(rows, get_ref(), 0, value, upper, lower); // Throws
+    std::sort(rows.begin(), rows.end());
+    for (size_t row : rows)
+        result.add(row); // Throws
+    return looked_up;
+}
+
+
+size_t StringIndex::find_all_case_insensitive(std::vector<size_t>& result, ref_type ref, size_t offset,
+                                              StringData value, const char* upper, const char* lower) const
+{
+    key_type keys[s_max_case_variants];
+    size_t count = CaseInsensitiveKey(value, upper, lower, offset).get_variants(keys);
+    return find_all_case_insensitive(result, ref, offset, keys, keys + count, value, upper, lower); // Throws
+}
+
+
+size_t StringIndex::find_all_case_insensitive(std::vector<size_t>& result, ref_type ref, size_t offset,
+                                              const key_type* keys_begin, const key_type* keys_end,
+                                              StringData value, const char* upper, const char* lower) const
+{
+    Allocator& alloc = m_array->get_alloc();
+    Array node(alloc);
+    node.init_from_ref(ref);
+    Array keys(alloc);
+    get_child(node, 0, keys);
+
+    bool is_inner_node = node.is_inner_bptree_node();
+    size_t looked_up = 0;
+    StringConversionBuffer buffer;
+
+    const key_type* k = keys_begin;
+    while (k != keys_end) {
+        size_t pos = keys.lower_bound_int(*k);
+        ++looked_up;
+        if (pos == keys.size())
+            break; // All remaining keys are greater than those of this node
+        key_type key = key_type(keys.get(pos));
+        size_t pos_refs = pos + 1; // first entry in refs points to offsets
+
+        if (is_inner_node) {
+            // The child holds the keys up to, and including `key`
+            const key_type* k_end = std::upper_bound(k, keys_end, key);
+            looked_up += find_all_case_insensitive(result, node.get_as_ref(pos_refs), offset, k, k_end, value,
+                                                   upper, lower); // Throws
+            k = k_end;
+            continue;
+        }
+
+        if (key != *k++)
+            continue;
+
+        int64_t slot_value = node.get(pos_refs);
+
+        // low bit set indicate literal ref (shifted)
+        if ((slot_value & 1) != 0) {
+            size_t row = to_size_t(uint64_t(slot_value) >> 1);
+            if (equal_case_insensitive(value, upper, lower, get(row, buffer)))
+                result.push_back(row); // Throws
+            continue;
+        }
+
+        ref_type sub_ref = to_ref(slot_value);
+        const char* sub_header = alloc.translate(sub_ref);
+        size_t prefix_size = 0;
+        if (is_prefix_node(sub_header)) {
+            prefix_size = get_prefix_size(sub_header);
+            sub_ref = to_ref(Array::get(sub_header, 1));
+            sub_header = alloc.translate(sub_ref);
+        }
+
+        if (Array::get_context_flag_from_header(sub_header)) {
+            size_t suboffset = offset + s_index_key_length + prefix_size;
+            looked_up += find_all_case_insensitive(result, sub_ref, suboffset, value, upper, lower); // Throws
+            continue;
+        }
+
+        // The list is sorted, so only the first row of each group of
+        // duplicates needs to be compared.
+        IntegerColumn sub(alloc, sub_ref); // Throws
+        IntegerColumn::const_iterator it = sub.cbegin();
+        IntegerColumn::const_iterator it_end = sub.cend();
+        SortedListComparator slc(*m_target_column);
+        while (it != it_end) {
+            StringData str = get(to_size_t(*it), buffer);
+            IntegerColumn::const_iterator next = std::upper_bound(it, it_end, str, slc);
+            if (equal_case_insensitive(value, upper, lower, str)) {
+                for (; it != next; ++it)
+                    result.push_back(to_size_t(*it)); // Throws
+            }
+            it = next;
+        }
+    }
+    return looked_up;
+}
+
+
 StringData StringIndex::get(size_t ndx, StringConversionBuffer& buffer) const
 {
     return m_target_column->get_index_data(ndx, buffer);
@@ -922,7 +1200,15 @@ void StringIndex::adjust_row_indexes(size_t min_row_ndx, int diff)
             else {
                 // A real ref either points to a list or a subindex
                 char* header = alloc.translate(to_ref(ref));
-                if (Array::get_context_flag_from_header(header)) {
+                if (is_prefix_node(header)) {
+                    Array prefix_node(alloc);
+                    prefix_node.init_from_mem(MemRef(header, to_ref(ref), alloc));
+                    prefix_node.set_parent(m_array.get(), i);
+                    StringIndex ndx(prefix_node.get_as_ref(1), &prefix_node, 1, m_target_column,
+                                    m_deny_duplicate_values, alloc);
+                    ndx.adjust_row_indexes(min_row_ndx, diff);
+                }
+                else if (Array::get_context_flag_from_header(header)) {
                     StringIndex ndx(to_ref(ref), m_array.get(), i, m_target_column, m_deny_duplicate_values, alloc);
                     ndx.adjust_row_indexes(min_row_ndx, diff);
                 }
@@ -994,7 +1280,22 @@ void StringIndex::do_delete(size_t row_ndx, StringData value, size_t offset)
         else {
             // A real ref either points to a list or a subindex
             char* header = alloc.translate(to_ref(ref));
-            if (Array::get_context_flag_from_header(header)) {
+            if (is_prefix_node(header)) {
+                Array prefix_node(alloc);
+                prefix_node.init_from_mem(MemRef(header, to_ref(ref), alloc));
+                prefix_node.set_parent(m_array.get(), pos_refs);
+                size_t prefix_size = get_prefix_size(header);
+                StringIndex subindex(prefix_node.get_as_ref(1), &prefix_node, 1, m_target_column,
+                                     m_deny_duplicate_values, alloc);
+                subindex.do_delete(row_ndx, value, offset + s_index_key_length + prefix_size);
+
+                if (subindex.is_empty()) {
+                    values.erase(pos);
+                    m_array->erase(pos_refs);
+                    prefix_node.destroy_deep();
+                }
+            }
+            else if (Array::get_context_flag_from_header(header)) {
                 StringIndex subindex(to_ref(ref), m_array.get(), pos_refs, m_target_column, m_deny_duplicate_values,
                                      alloc);
                 subindex.do_delete(row_ndx, value, offset + s_index_key_length);
@@ -1054,7 +1355,16 @@ void StringIndex::do_update_ref(StringData value, size_t row_ndx, size_t new_row
         else {
             // A real ref either points to a list or a subindex
             char* header = alloc.translate(to_ref(ref));
-            if (Array::get_context_flag_from_header(header)) {
+            if (is_prefix_node(header)) {
+                Array prefix_node(alloc);
+                prefix_node.init_from_mem(MemRef(header, to_ref(ref), alloc));
+                prefix_node.set_parent(m_array.get(), pos_refs);
+                size_t prefix_size = get_prefix_size(header);
+                StringIndex subindex(prefix_node.get_as_ref(1), &prefix_node, 1, m_target_column,
+                                     m_deny_duplicate_values, alloc);
+                subindex.do_update_ref(value, row_ndx, new_row_ndx, offset + s_index_key_length + prefix_size);
+            }
+            else if (Array::get_context_flag_from_header(header)) {
                 StringIndex subindex(to_ref(ref), m_array.get(), pos_refs, m_target_column, m_deny_duplicate_values,
                                      alloc);
                 subindex.do_update_ref(value, row_ndx, new_row_ndx, offset + s_index_key_length);
@@ -1104,6 +1414,10 @@ bool has_duplicate_values(const Array& node, ColumnBase* target_col) noexcept
 
         ref_type ref = to_ref(value);
         child.init_from_ref(ref);
+        if (StringIndex::is_prefix_node(child.get_mem().get_addr())) {
+            ref = child.get_as_ref(1);
+            child.init_from_ref(ref);
+        }
 
         bool is_subindex = child.get_context_flag();
         if (is_subindex) {
@@ -1258,7 +1572,16 @@ void StringIndex::verify() const
             else {
                 // A real ref either points to a list or a subindex
                 char* header = alloc.translate(to_ref(ref));
-                if (Array::get_context_flag_from_header(header)) {
+                if (is_prefix_node(header)) {
+                    REALM_ASSERT_3(Array::get_size_from_header(header), ==, 2);
+                    size_t prefix_size = get_prefix_size(header);
+                    REALM_ASSERT_EX(prefix_size != 0 && prefix_size % s_index_key_length == 0, prefix_size);
+                    ref_type subindex_ref = to_ref(Array::get(header, 1));
+                    REALM_ASSERT(Array::get_context_flag_from_header(alloc.translate(subindex_ref)));
+                    StringIndex ndx(subindex_ref, nullptr, 0, m_target_column, m_deny_duplicate_values, alloc);
+                    ndx.verify();
+                }
+                else if (Array::get_context_flag_from_header(header)) {
                     StringIndex ndx(to_ref(ref), m_array.get(), i, m_target_column, m_deny_duplicate_values, alloc);
                     ndx.verify();
                 }
@@ -1362,6 +1685,11 @@ void StringIndex::dump_node_structure(const Array& node, std::ostream& out, int
                 continue;
             }
             subnode.init_from_ref(to_ref(value));
+            if (is_prefix_node(subnode.get_mem().get_addr())) {
+                out << std::setw(indent) << ""
+                    << "  Prefix node (skip: " << get_prefix_size(subnode.get_mem().get_addr()) << ")\n";
+                subnode.init_from_ref(subnode.get_as_ref(1));
+            }
             bool is_subindex = subnode.get_context_flag();
             if (is_subindex) {
                 out << std::setw(indent) << ""
@@ -1427,6 +1755,18 @@ void StringIndex::to_dot_2(std::ostream& out, StringData title) const
 
 void StringIndex::array_to_dot(std::ostream& out, const Array& array)
 {
+    if (is_prefix_node(array.get_mem().get_addr())) {
+        out << "subgraph cluster_string_index_prefix_node" << array.get_ref() << " {" << std::endl;
+        out << " label = \"Prefix node\";" << std::endl;
+        array.to_dot(out);
+        out << "}" << std::endl;
+
+        Array r(array.get_alloc());
+        get_child(const_cast<Array&>(array), 1, r);
+        array_to_dot(out, r);
+        return;
+    }
+
     if (!array.get_context_flag()) {
         IntegerColumn col(array.get_alloc(), array.get_ref()); // Throws
         col.set_parent(array.get_parent(), array.get_ndx_in_parent());
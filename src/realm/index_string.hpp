@@ -22,6 +22,7 @@
 #include <cstring>
 #include <memory>
 #include <array>
+#include <vector>
 
 #include <realm/array.hpp>
 #include <realm/column_fwd.hpp>
@@ -60,6 +61,25 @@ the same Column, but Columns may contain more than just duplicates if the depth
 long strings that have a long common prefix but differ in the last couple bytes. If a Column stores more than just
 duplicates, then the list is kept sorted in ascending order by string value and within the groups of common
 strings, the rows are sorted in ascending order.
+
+Long common prefixes are not stored as chains of subindexes with a single key each. Instead, when two strings share
+one or more whole keys beyond the current level, the subindex that tells them apart is placed behind a prefix node.
+A prefix node is an array with refs, but without the context flag, and it holds two entries: the number of bytes
+skipped (as a tagged integer, always a multiple of 4), and a reference to the subindex. The skipped bytes are not
+stored, since every search ends by comparing against the actual value in the target column. When a string that does
+not share the skipped bytes is inserted, the prefix node is split at the first key where they differ. With URL-like
+keys that share long prefixes, this keeps both the size of the index and the depth of lookups down. Prefix nodes are
+only created in files of format version 7 or later, and indexes in older files keep using chains of subindexes.
+
+       http                http
+        |                   |
+       s://        =>    (skip 8)
+        |                  /  \
+       www.              exac  exam
+       /  \               |     |
+     exac  exam           1     0
+      |     |
+      1     0
 */
 
 namespace realm {
@@ -146,6 +166,18 @@ public:
 
     void clear();
 
+    /// Find all rows whose value equals \a value when case is ignored, that
+    /// is, the rows that the case insensitive `equal()` query condition
+    /// matches. \a upper and \a lower are the upper and lower case forms of
+    /// \a value (see case_map()), and must be of the same size as it. Rows
+    /// are added to \a result in ascending order. At each level of the index,
+    /// only the keys whose bytes are either case of the corresponding bytes of
+    /// \a value (at most `s_max_case_variants` keys) are looked up. Returns
+    /// the number of key lookups, which does not depend on the size of the
+    /// index.
+    size_t find_all_case_insensitive(IntegerColumn& result, StringData value, const char* upper,
+                                     const char* lower) const;
+
     void distinct(IntegerColumn& result) const;
     bool has_duplicate_values() const noexcept;
 
@@ -171,9 +203,20 @@ public:
     // binary search of approximate complexity log2(n) from `std::lower_bound`.
     static const size_t s_max_offset = 200; // max depth * s_index_key_length
     static const size_t s_index_key_length = 4;
+    static const size_t s_max_case_variants = 1 << s_index_key_length; // Keys that only differ in case
     static key_type create_key(StringData) noexcept;
     static key_type create_key(StringData, size_t) noexcept;
 
+    /// Returns true if the specified child of a leaf is a prefix node, that
+    /// is, an array with refs, but without the context flag. Lists of row
+    /// indexes never have refs unless they are inner B+-tree nodes, and
+    /// subindexes always have the context flag.
+    static bool is_prefix_node(const char* header) noexcept;
+
+    /// Returns the number of bytes, rounded down to a whole number of keys,
+    /// that the two strings have in common from the specified offset.
+    static size_t get_common_prefix_size(StringData, StringData, size_t offset) noexcept;
+
 private:
     // m_array is a compact representation for storing the children of this StringIndex.
     // Children can be:
@@ -194,6 +237,8 @@ private:
     // type 2, or type 3 (no shifting in either case).
     // References point to a list if the context header flag is NOT set.
     // If the header flag is set, references point to a sub-StringIndex (nesting).
+    // As an exception, a reference to an array with refs, but without the
+    // context flag, is a prefix node (see is_prefix_node()).
     std::unique_ptr<IndexArray> m_array;
     ColumnBase* m_target_column;
     bool m_deny_duplicate_values;
@@ -245,6 +290,25 @@ private:
 
     StringData get(size_t ndx, StringConversionBuffer& buffer) const;
 
+    size_t find_all_case_insensitive(std::vector<size_t>& result, ref_type, size_t offset, StringData value,
+                                     const char* upper, const char* lower) const;
+    size_t find_all_case_insensitive(std::vector<size_t>& result, ref_type, size_t offset, const key_type* keys_begin,
+                                     const key_type* keys_end, StringData value, const char* upper,
+                                     const char* lower) const;
+
+    /// Returns \a subindex_ref itself if \a prefix_size is zero, and otherwise
+    /// the ref of a new prefix node that skips \a prefix_size bytes before
+    /// the subindex.
+    static ref_type create_prefix_node(size_t prefix_size, ref_type subindex_ref, Allocator&);
+
+    /// Same as get_common_prefix_size(), but returns zero if the file format
+    /// predates prefix nodes (version 7), in which case no keys may be
+    /// skipped.
+    size_t get_skippable_prefix_size(StringData, StringData, size_t offset) const noexcept;
+
+    /// Returns a row, any row, referenced from the specified child of a leaf.
+    size_t get_any_row(ref_type) const;
+
     void node_add_key(ref_type ref);
 
 #ifdef REALM_DEBUG
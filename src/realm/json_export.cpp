@@ -0,0 +1,685 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <realm/json_export.hpp>
+#include <realm/column_link.hpp>
+#include <realm/column_linklist.hpp>
+#include <realm/group.hpp>
+#include <realm/table.hpp>
+#include <realm/util/string_buffer.hpp>
+#include <realm/util/ordered_pipeline.hpp>
+
+using namespace realm;
+
+namespace {
+
+void append(util::StringBuffer& out, const char* str)
+{
+    out.append(str, std::strlen(str)); // Throws
+}
+
+void append(util::StringBuffer& out, const std::string& str)
+{
+    out.append(str.data(), str.size()); // Throws
+}
+
+void append_int(util::StringBuffer& out, int64_t value)
+{
+    char buffer[20];
+    char* end = buffer + sizeof buffer;
+    char* p = end;
+    uint64_t v = value < 0 ? 0 - uint64_t(value) : uint64_t(value);
+    do {
+        *--p = char('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    if (value < 0)
+        *--p = '-';
+    out.append(p, size_t(end - p)); // Throws
+}
+
+void append_two_digits(util::StringBuffer& out, int value)
+{
+    char buffer[2] = {char('0' + value / 10), char('0' + value % 10)};
+    out.append(buffer, 2); // Throws
+}
+
+// Scientific notation with the precision used by Table::to_json(). JSON has no
+// representation of NaN and infinity, so they become null.
+template <class T>
+void append_float(util::StringBuffer& out, T value)
+{
+    if (!std::isfinite(value)) {
+        append(out, "null"); // Throws
+        return;
+    }
+    char buffer[32];
+    int n = std::snprintf(buffer, sizeof buffer, "%.*e", std::numeric_limits<T>::digits10 + 1, double(value));
+    out.append(buffer, size_t(n)); // Throws
+}
+
+void append_string(util::StringBuffer& out, StringData str)
+{
+    if (str.is_null()) {
+        append(out, "null"); // Throws
+        return;
+    }
+    static const char hex_digits[] = "0123456789abcdef";
+    out.append("\"", 1); // Throws
+    const char* begin = str.data();
+    const char* end = begin + str.size();
+    const char* run = begin;
+    for (const char* p = begin; p != end; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        out.append(run, size_t(p - run)); // Throws
+        run = p + 1;
+        switch (c) {
+            case '"':
+                append(out, "\\\""); // Throws
+                break;
+            case '\\':
+                append(out, "\\\\"); // Throws
+                break;
+            case '\n':
+                append(out, "\\n"); // Throws
+                break;
+            case '\r':
+                append(out, "\\r"); // Throws
+                break;
+            case '\t':
+                append(out, "\\t"); // Throws
+                break;
+            default: {
+                char escape[6] = {'\\', 'u', '0', '0', hex_digits[c >> 4], hex_digits[c & 0xF]};
+                out.append(escape, 6); // Throws
+            }
+        }
+    }
+    out.append(run, size_t(end - run)); // Throws
+    out.append("\"", 1);                // Throws
+}
+
+void append_binary(util::StringBuffer& out, BinaryData bin)
+{
+    if (bin.is_null()) {
+        append(out, "null"); // Throws
+        return;
+    }
+    static const char hex_digits[] = "0123456789abcdef";
+    size_t offset = out.size();
+    out.resize(offset + 2 * bin.size() + 2); // Throws
+    char* p = out.data() + offset;
+    *p++ = '"';
+    for (size_t i = 0; i < bin.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(bin[i]);
+        *p++ = hex_digits[c >> 4];
+        *p++ = hex_digits[c & 0xF];
+    }
+    *p = '"';
+}
+
+// "YYYY-MM-DD HH:MM:SS" in UTC, as written by Table::to_json(). This does not
+// go through gmtime(), which is neither fast nor thread-safe. The conversion
+// from days to a civil date is that of the proleptic Gregorian calendar.
+void append_seconds(util::StringBuffer& out, int64_t seconds)
+{
+    int64_t days = seconds / 86400;
+    int64_t time = seconds % 86400;
+    if (time < 0) {
+        time += 86400;
+        --days;
+    }
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t day_of_era = z - era * 146097;
+    int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int64_t month_index = (5 * day_of_year + 2) / 153;
+    int day = int(day_of_year - (153 * month_index + 2) / 5 + 1);
+    int month = int(month_index < 10 ? month_index + 3 : month_index - 9);
+    int64_t year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
+
+    out.append("\"", 1); // Throws
+    // gmtime() fails for years that do not fit in an int, and to_json() then
+    // writes an empty string
+    if (year - 1900 >= std::numeric_limits<int>::min() && year - 1900 <= std::numeric_limits<int>::max()) {
+        append_int(out, year);               // Throws
+        out.append("-", 1);                  // Throws
+        append_two_digits(out, month);       // Throws
+        out.append("-", 1);                  // Throws
+        append_two_digits(out, day);         // Throws
+        out.append(" ", 1);                  // Throws
+        append_two_digits(out, int(time / 3600));      // Throws
+        out.append(":", 1);                             // Throws
+        append_two_digits(out, int(time / 60 % 60));   // Throws
+        out.append(":", 1);                             // Throws
+        append_two_digits(out, int(time % 60));        // Throws
+    }
+    out.append("\"", 1); // Throws
+}
+
+void append_timestamp(util::StringBuffer& out, Timestamp value)
+{
+    if (value.is_null()) {
+        append(out, "null"); // Throws
+        return;
+    }
+    append_seconds(out, value.get_seconds()); // Throws
+}
+
+// Calls `func(leaf, ndx_in_leaf)` for rows `begin` to `end` of `column`, one
+// leaf at a time.
+template <class ColType, class F>
+void for_each_in_leaves(const ColType& column, size_t begin, size_t end, F func)
+{
+    using LeafType = typename ColType::LeafType;
+    LeafType fallback(column.get_alloc());
+    const LeafType* leaf = nullptr;
+    size_t row = begin;
+    while (row < end) {
+        size_t ndx_in_leaf;
+        typename ColType::LeafInfo leaf_info{&leaf, &fallback};
+        column.get_leaf(row, ndx_in_leaf, leaf_info);
+        size_t leaf_end = std::min(leaf->size(), ndx_in_leaf + (end - row));
+        for (; ndx_in_leaf < leaf_end; ++ndx_in_leaf, ++row)
+            func(*leaf, ndx_in_leaf); // Throws
+    }
+}
+
+// The constant parts of the rows of a table
+struct TableLayout {
+    const Table* table;
+    std::string open;  // Written before the first row
+    std::string close; // Written after the last row
+    std::string row_begin;
+    std::string row_end;
+    std::string row_separator;
+    std::vector<std::string> keys;            // `"name":`, preceded by a comma for all but the first column
+    std::vector<std::string> link_list_begin; // `{"table": "target", "rows": [` for link list columns
+    bool is_thread_safe = true;               // False if formatting may create accessors
+
+    TableLayout(const Table&, bool ndjson, StringData group_table_name);
+};
+
+TableLayout::TableLayout(const Table& t, bool ndjson, StringData group_table_name)
+    : table(&t)
+{
+    util::StringBuffer buffer;
+    if (ndjson) {
+        row_begin = "{";
+        row_end = "}\n";
+        if (group_table_name) {
+            append(buffer, "{\"table\":");            // Throws
+            append_string(buffer, group_table_name); // Throws
+            append(buffer, ",\"row\":{");             // Throws
+            row_begin = buffer.str();
+            row_end = "}}\n";
+        }
+    }
+    else {
+        open = "[";
+        close = "]";
+        row_begin = "{";
+        row_end = "}";
+        row_separator = ",";
+    }
+
+    size_t column_count = t.get_column_count();
+    keys.resize(column_count);
+    link_list_begin.resize(column_count);
+    for (size_t col = 0; col < column_count; ++col) {
+        buffer.clear();
+        if (col > 0)
+            append(buffer, ",");                     // Throws
+        append_string(buffer, t.get_column_name(col)); // Throws
+        append(buffer, ":");                          // Throws
+        keys[col] = buffer.str();
+
+        switch (t.get_column_type(col)) {
+            case type_Table:
+            case type_Mixed:
+                is_thread_safe = false;
+                break;
+            case type_LinkList: {
+                buffer.clear();
+                append(buffer, "{\"table\": ");                          // Throws
+                append_string(buffer, t.get_link_target(col)->get_name()); // Throws
+                append(buffer, ", \"rows\": [");                           // Throws
+                link_list_begin[col] = buffer.str();
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+// Formats batches of rows. The values of a batch are formatted one column at a
+// time, so each column is traversed leaf by leaf, and are then assembled into
+// rows. The buffers are reused from one batch to the next.
+class BatchFormatter {
+public:
+    /// Append rows `begin` to `end` of the table of `layout` to `out`,
+    /// separated by TableLayout::row_separator.
+    void format(const TableLayout& layout, size_t begin, size_t end, util::StringBuffer& out);
+
+private:
+    util::StringBuffer m_values;
+    std::vector<size_t> m_value_ends; // End of value `i` of column `col` at `col * row_count + i`
+
+    void format_column(const TableLayout&, size_t col, size_t begin, size_t end);
+    void format_link_list(const LinkListColumn&, size_t row);
+    void format_subtable(const Table&);
+    void format_mixed(const Table&, size_t col, size_t row);
+
+    void end_value()
+    {
+        m_value_ends.push_back(m_values.size()); // Throws
+    }
+};
+
+void BatchFormatter::format(const TableLayout& layout, size_t begin, size_t end, util::StringBuffer& out)
+{
+    size_t row_count = end - begin;
+    size_t column_count = layout.keys.size();
+    m_values.clear();
+    m_value_ends.clear();
+    m_value_ends.reserve(row_count * column_count); // Throws
+    for (size_t col = 0; col < column_count; ++col)
+        format_column(layout, col, begin, end); // Throws
+
+    const char* values = m_values.data();
+    for (size_t i = 0; i < row_count; ++i) {
+        if (i > 0)
+            append(out, layout.row_separator); // Throws
+        append(out, layout.row_begin);         // Throws
+        for (size_t col = 0; col < column_count; ++col) {
+            size_t value_ndx = col * row_count + i;
+            size_t value_begin = value_ndx == 0 ? 0 : m_value_ends[value_ndx - 1];
+            append(out, layout.keys[col]);                                               // Throws
+            out.append(values + value_begin, m_value_ends[value_ndx] - value_begin); // Throws
+        }
+        append(out, layout.row_end); // Throws
+    }
+}
+
+void BatchFormatter::format_column(const TableLayout& layout, size_t col, size_t begin, size_t end)
+{
+    const Table& table = *layout.table;
+    const ColumnBase& column = _impl::TableFriend::get_column(table, col);
+    bool nullable = table.is_nullable(col);
+    switch (table.get_column_type(col)) {
+        case type_Int:
+            if (nullable) {
+                for_each_in_leaves(static_cast<const IntNullColumn&>(column), begin, end,
+                                   [&](const ArrayIntNull& leaf, size_t ndx) {
+                                       auto value = leaf.get(ndx);
+                                       if (value)
+                                           append_int(m_values, *value);
+                                       else
+                                           append(m_values, "null");
+                                       end_value();
+                                   }); // Throws
+            }
+            else {
+                for_each_in_leaves(static_cast<const IntegerColumn&>(column), begin, end,
+                                   [&](const Array& leaf, size_t ndx) {
+                                       append_int(m_values, leaf.get(ndx));
+                                       end_value();
+                                   }); // Throws
+            }
+            return;
+        case type_Bool:
+            if (nullable) {
+                for_each_in_leaves(static_cast<const IntNullColumn&>(column), begin, end,
+                                   [&](const ArrayIntNull& leaf, size_t ndx) {
+                                       auto value = leaf.get(ndx);
+                                       append(m_values, !value ? "null" : *value ? "true" : "false");
+                                       end_value();
+                                   }); // Throws
+            }
+            else {
+                for_each_in_leaves(static_cast<const IntegerColumn&>(column), begin, end,
+                                   [&](const Array& leaf, size_t ndx) {
+                                       append(m_values, leaf.get(ndx) ? "true" : "false");
+                                       end_value();
+                                   }); // Throws
+            }
+            return;
+        case type_Float:
+            for_each_in_leaves(static_cast<const FloatColumn&>(column), begin, end,
+                               [&](const BasicArray<float>& leaf, size_t ndx) {
+                                   if (nullable && leaf.is_null(ndx))
+                                       append(m_values, "null");
+                                   else
+                                       append_float(m_values, leaf.get(ndx));
+                                   end_value();
+                               }); // Throws
+            return;
+        case type_Double:
+            for_each_in_leaves(static_cast<const DoubleColumn&>(column), begin, end,
+                               [&](const BasicArray<double>& leaf, size_t ndx) {
+                                   if (nullable && leaf.is_null(ndx))
+                                       append(m_values, "null");
+                                   else
+                                       append_float(m_values, leaf.get(ndx));
+                                   end_value();
+                               }); // Throws
+            return;
+        case type_String:
+            for (size_t row = begin; row < end; ++row) {
+                append_string(m_values, table.get_string(col, row)); // Throws
+                end_value();                                         // Throws
+            }
+            return;
+        case type_Binary:
+            for (size_t row = begin; row < end; ++row) {
+                append_binary(m_values, table.get_binary(col, row)); // Throws
+                end_value();                                         // Throws
+            }
+            return;
+        case type_OldDateTime:
+            for (size_t row = begin; row < end; ++row) {
+                if (table.is_null(col, row))
+                    append(m_values, "null"); // Throws
+                else
+                    append_seconds(m_values, table.get_olddatetime(col, row).get_olddatetime()); // Throws
+                end_value();                                                                      // Throws
+            }
+            return;
+        case type_Timestamp:
+            for (size_t row = begin; row < end; ++row) {
+                append_timestamp(m_values, table.get_timestamp(col, row)); // Throws
+                end_value();                                               // Throws
+            }
+            return;
+        case type_Table:
+            for (size_t row = begin; row < end; ++row) {
+                format_subtable(*table.get_subtable(col, row)); // Throws
+                end_value();                                    // Throws
+            }
+            return;
+        case type_Mixed:
+            for (size_t row = begin; row < end; ++row) {
+                format_mixed(table, col, row); // Throws
+                end_value();                   // Throws
+            }
+            return;
+        case type_Link: {
+            const LinkColumn& links = static_cast<const LinkColumn&>(column);
+            for (size_t row = begin; row < end; ++row) {
+                if (links.is_null_link(row)) {
+                    append(m_values, "[]"); // Throws
+                }
+                else {
+                    append(m_values, "\"");                        // Throws
+                    append_int(m_values, int64_t(links.get_link(row))); // Throws
+                    append(m_values, "\"");                        // Throws
+                }
+                end_value(); // Throws
+            }
+            return;
+        }
+        case type_LinkList: {
+            const LinkListColumn& links = static_cast<const LinkListColumn&>(column);
+            for (size_t row = begin; row < end; ++row) {
+                append(m_values, layout.link_list_begin[col]); // Throws
+                format_link_list(links, row);                  // Throws
+                append(m_values, "]}");                        // Throws
+                end_value();                                   // Throws
+            }
+            return;
+        }
+    }
+    REALM_ASSERT(false);
+}
+
+// The target rows are read directly from the list of the row, so that no
+// LinkView accessor is created
+void BatchFormatter::format_link_list(const LinkListColumn& links, size_t row)
+{
+    ref_type ref = links.get_as_ref(row);
+    if (ref == 0)
+        return;
+    IntegerColumn targets(links.get_alloc(), ref); // Throws
+    bool first = true;
+    for_each_in_leaves(targets, 0, targets.size(), [&](const Array& leaf, size_t ndx) {
+        if (!first)
+            append(m_values, ", ");
+        append_int(m_values, leaf.get(ndx));
+        first = false;
+    }); // Throws
+}
+
+void BatchFormatter::format_subtable(const Table& subtable)
+{
+    TableLayout layout(subtable, false, StringData()); // Throws
+    BatchFormatter formatter;
+    append(m_values, "[");                                    // Throws
+    formatter.format(layout, 0, subtable.size(), m_values); // Throws
+    append(m_values, "]");                                    // Throws
+}
+
+void BatchFormatter::format_mixed(const Table& table, size_t col, size_t row)
+{
+    DataType type = table.get_mixed_type(col, row);
+    if (type == type_Table) {
+        format_subtable(*table.get_subtable(col, row)); // Throws
+        return;
+    }
+    Mixed value = table.get_mixed(col, row);
+    switch (type) {
+        case type_Int:
+            append_int(m_values, value.get_int()); // Throws
+            return;
+        case type_Bool:
+            append(m_values, value.get_bool() ? "true" : "false"); // Throws
+            return;
+        case type_Float:
+            append_float(m_values, value.get_float()); // Throws
+            return;
+        case type_Double:
+            append_float(m_values, value.get_double()); // Throws
+            return;
+        case type_String:
+            append_string(m_values, value.get_string()); // Throws
+            return;
+        case type_Binary:
+            append_binary(m_values, value.get_binary()); // Throws
+            return;
+        case type_OldDateTime:
+            append_seconds(m_values, value.get_olddatetime().get_olddatetime()); // Throws
+            return;
+        case type_Timestamp:
+            append_timestamp(m_values, value.get_timestamp()); // Throws
+            return;
+        case type_Table:
+        case type_Mixed:
+        case type_Link:
+        case type_LinkList:
+            break;
+    }
+    REALM_ASSERT(false);
+}
+
+
+// A batch of rows of one table
+struct Batch {
+    size_t table;
+    size_t begin, end;
+};
+
+class Exporter {
+public:
+    Exporter(std::ostream& out, const JsonExportConfig& config)
+        : m_out(out)
+        , m_config(config)
+    {
+    }
+
+    void add_table(const Table& table, StringData group_table_name);
+
+    /// Write the tables to the output stream, between `open` and `close`.
+    void run(const char* open, const char* close);
+
+private:
+    std::ostream& m_out;
+    const JsonExportConfig& m_config;
+    std::vector<TableLayout> m_tables;
+    std::vector<Batch> m_batches;
+
+    void run_sequential();
+    void run_parallel(size_t thread_count);
+    void write_batch(size_t batch_ndx, const util::StringBuffer& text);
+};
+
+void Exporter::add_table(const Table& table, StringData group_table_name)
+{
+    size_t table_ndx = m_tables.size();
+    m_tables.emplace_back(table, m_config.ndjson, group_table_name); // Throws
+    if (group_table_name && !m_config.ndjson) {
+        util::StringBuffer open;
+        if (table_ndx > 0)
+            append(open, ",");                   // Throws
+        append_string(open, group_table_name); // Throws
+        append(open, ":[");                    // Throws
+        m_tables.back().open = open.str();
+    }
+
+    size_t batch_size = std::max(m_config.batch_size, size_t(1));
+    size_t size = table.size();
+    for (size_t begin = 0; begin < size; begin += batch_size)
+        m_batches.push_back(Batch{table_ndx, begin, std::min(begin + batch_size, size)}); // Throws
+}
+
+void Exporter::run(const char* open, const char* close)
+{
+    m_out << open; // Throws
+    bool is_thread_safe = std::all_of(m_tables.begin(), m_tables.end(), [](const TableLayout& layout) {
+        return layout.is_thread_safe;
+    });
+    size_t thread_count = std::min(m_config.thread_count, m_batches.size());
+    if (thread_count > 1 && is_thread_safe) {
+        run_parallel(thread_count); // Throws
+    }
+    else {
+        run_sequential(); // Throws
+    }
+    // Tables after the last batch
+    size_t table_ndx = m_batches.empty() ? 0 : m_batches.back().table + 1;
+    for (; table_ndx < m_tables.size(); ++table_ndx)
+        m_out << m_tables[table_ndx].open << m_tables[table_ndx].close; // Throws
+    m_out << close;                                                      // Throws
+}
+
+// Writes the text of a batch, preceded by the tables before it and the
+// separator to the previous batch of the same table
+void Exporter::write_batch(size_t batch_ndx, const util::StringBuffer& text)
+{
+    const Batch& batch = m_batches[batch_ndx];
+    size_t table_ndx = batch_ndx == 0 ? 0 : m_batches[batch_ndx - 1].table;
+    if (batch_ndx > 0 && table_ndx == batch.table) {
+        m_out << m_tables[table_ndx].row_separator; // Throws
+    }
+    else {
+        if (batch_ndx > 0)
+            m_out << m_tables[table_ndx++].close; // Throws
+        for (; table_ndx < batch.table; ++table_ndx)
+            m_out << m_tables[table_ndx].open << m_tables[table_ndx].close; // Throws
+        m_out << m_tables[table_ndx].open;                                   // Throws
+    }
+    m_out.write(text.data(), std::streamsize(text.size())); // Throws
+    if (batch_ndx + 1 == m_batches.size())
+        m_out << m_tables[batch.table].close; // Throws
+}
+
+void Exporter::run_sequential()
+{
+    BatchFormatter formatter;
+    util::StringBuffer text;
+    for (size_t i = 0; i < m_batches.size(); ++i) {
+        const Batch& batch = m_batches[i];
+        text.clear();
+        formatter.format(m_tables[batch.table], batch.begin, batch.end, text); // Throws
+        write_batch(i, text);                                                 // Throws
+    }
+}
+
+// The batches are formatted by `thread_count` worker threads while the calling
+// thread writes them in order, see util::run_ordered_pipeline().
+void Exporter::run_parallel(size_t thread_count)
+{
+    struct Slot {
+        BatchFormatter formatter;
+        util::StringBuffer text;
+    };
+    std::vector<Slot> slots(util::get_pipeline_slot_count(thread_count)); // Throws
+
+    auto format = [&](size_t batch_ndx, size_t slot_ndx) {
+        Slot& slot = slots[slot_ndx];
+        const Batch& batch = m_batches[batch_ndx];
+        slot.text.clear();
+        slot.formatter.format(m_tables[batch.table], batch.begin, batch.end, slot.text); // Throws
+    };
+    auto write = [&](size_t batch_ndx, size_t slot_ndx) {
+        write_batch(batch_ndx, slots[slot_ndx].text); // Throws
+        return true;
+    };
+    util::run_ordered_pipeline(m_batches.size(), thread_count, format, write); // Throws
+}
+
+} // anonymous namespace
+
+
+void realm::export_json(const Table& table, std::ostream& out, const JsonExportConfig& config)
+{
+    if (!table.is_attached())
+        throw LogicError(LogicError::detached_accessor);
+
+    Exporter exporter(out, config);
+    exporter.add_table(table, StringData()); // Throws
+    exporter.run("", "");                    // Throws
+}
+
+void realm::export_json(const Group& group, std::ostream& out, const JsonExportConfig& config)
+{
+    if (!group.is_attached())
+        throw LogicError(LogicError::detached_accessor);
+
+    // The table accessors are all created here, before any worker thread is
+    // started
+    std::vector<ConstTableRef> tables;
+    Exporter exporter(out, config);
+    for (size_t i = 0; i < group.size(); ++i) {
+        tables.push_back(group.get_table(i));                      // Throws
+        exporter.add_table(*tables.back(), group.get_table_name(i)); // Throws
+    }
+    const char* open = config.ndjson ? "" : "{";
+    const char* close = config.ndjson ? "" : "}";
+    exporter.run(open, close); // Throws
+}
@@ -0,0 +1,63 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_JSON_EXPORT_HPP
+#define REALM_JSON_EXPORT_HPP
+
+#include <cstddef>
+#include <ostream>
+
+namespace realm {
+
+class Table;
+class Group;
+
+struct JsonExportConfig {
+    /// Write one JSON object per line (NDJSON) instead of a single JSON
+    /// document. For a group, each line is `{"table":<name>,"row":{...}}`.
+    bool ndjson = false;
+
+    /// The number of rows formatted at a time. The memory used by the export
+    /// is proportional to this, not to the size of the tables.
+    size_t batch_size = 1024;
+
+    /// The number of threads formatting batches. The output is the same for
+    /// any number of threads. Tables with subtable or mixed columns are always
+    /// exported by the calling thread alone.
+    size_t thread_count = 1;
+};
+
+/// Write the rows of `table` to `out` as JSON. The format is that of
+/// Table::to_json() with a link depth of 0, except that strings and column
+/// names are escaped, null values are written as `null`, and non-finite
+/// floats and doubles are written as `null`.
+///
+/// Rows are formatted column by column in batches of
+/// JsonExportConfig::batch_size rows, and the batches are written to `out` in
+/// order as soon as they are ready, so the whole output is never held in
+/// memory.
+void export_json(const Table& table, std::ostream& out, const JsonExportConfig& config = JsonExportConfig());
+
+/// Write all tables of `group` to `out` as JSON, in the format of
+/// Group::to_json(), see export_json(const Table&, ...). Batches from
+/// different tables may be formatted at the same time.
+void export_json(const Group& group, std::ostream& out, const JsonExportConfig& config = JsonExportConfig());
+
+} // namespace realm
+
+#endif // REALM_JSON_EXPORT_HPP
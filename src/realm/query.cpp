@@ -17,11 +17,13 @@
  **************************************************************************/
 
 #include <cstdio>
+#include <cstring>
 #include <algorithm>
 
 #include <realm/array.hpp>
 #include <realm/column_fwd.hpp>
 #include <realm/query.hpp>
+#include <realm/query_cache.hpp>
 #include <realm/query_engine.hpp>
 #include <realm/descriptor.hpp>
 #include <realm/table_view.hpp>
@@ -721,6 +723,14 @@ Query& Query::less(size_t column_ndx, Timestamp value)
 {
     return add_condition<Less>(column_ndx, value);
 }
+Query& Query::between(size_t column_ndx, Timestamp from, Timestamp to)
+{
+    group();
+    greater_equal(column_ndx, from);
+    less_equal(column_ndx, to);
+    end_group();
+    return *this;
+}
 
 
 // Strings, StringData()
@@ -774,6 +784,32 @@ Query& Query::like(size_t column_ndx, StringData value, bool case_sensitive)
     return *this;
 }
 
+Query& Query::in(size_t column_ndx, std::vector<int64_t> values)
+{
+    REALM_ASSERT_DEBUG(m_current_descriptor);
+    DataType type = m_current_descriptor->get_column_type(column_ndx);
+    if (type != type_Int && type != type_Bool && type != type_OldDateTime)
+        throw LogicError{LogicError::type_mismatch};
+
+    std::unique_ptr<ParentNode> node;
+    if (m_current_descriptor->is_nullable(column_ndx))
+        node.reset(new IntegerInNode<IntNullColumn>(std::move(values), column_ndx));
+    else
+        node.reset(new IntegerInNode<IntegerColumn>(std::move(values), column_ndx));
+    add_node(std::move(node));
+    return *this;
+}
+
+Query& Query::in(size_t column_ndx, const std::vector<StringData>& values)
+{
+    REALM_ASSERT_DEBUG(m_current_descriptor);
+    if (m_current_descriptor->get_column_type(column_ndx) != type_String)
+        throw LogicError{LogicError::type_mismatch};
+
+    add_node(std::unique_ptr<ParentNode>(new StringInNode(values, column_ndx)));
+    return *this;
+}
+
 
 // Aggregates =================================================================================
 
@@ -818,6 +854,21 @@ R Query::aggregate(R (ColType::*aggregateMethod)(size_t start, size_t end, size_
     }
     else {
 
+        static_assert(sizeof(R) <= sizeof(QueryCache::Result::state), "");
+        std::string key;
+        QueryCache* cache = get_result_cache(key, action, column_ndx, start, end, limit);
+        if (cache) {
+            if (const QueryCache::Result* cached = cache->find(key, m_table->get_version_counter())) {
+                if (resultcount)
+                    *resultcount = cached->match_count;
+                if (return_ndx)
+                    *return_ndx = cached->minmax_index;
+                R result;
+                std::memcpy(&result, &cached->state, sizeof(R));
+                return result;
+            }
+        }
+
         // Aggregate with criteria - goes through the nodes in the query system
         init();
         QueryState<R> st;
@@ -849,10 +900,32 @@ R Query::aggregate(R (ColType::*aggregateMethod)(size_t start, size_t end, size_
             *return_ndx = st.m_minmax_index;
         }
 
+        if (cache) {
+            QueryCache::Result result;
+            std::memcpy(&result.state, &st.m_state, sizeof(R));
+            result.match_count = st.m_match_count;
+            result.minmax_index = st.m_minmax_index;
+            cache->insert(std::move(key), m_table->get_version_counter(), std::move(result)); // Throws
+        }
+
         return st.m_state;
     }
 }
 
+QueryCache* Query::get_result_cache(std::string& key, Action action, size_t column_ndx, size_t start, size_t end,
+                                    size_t limit) const
+{
+    QueryCache* cache = m_table->m_query_cache.get();
+    if (!cache || m_view || !has_conditions())
+        return nullptr;
+
+    if (!root_node()->fingerprint(key))
+        return nullptr;
+    for (size_t arg : {size_t(action), column_ndx, start, end, limit})
+        key.append(reinterpret_cast<const char*>(&arg), sizeof arg);
+    return cache;
+}
+
 /**************************************************************************************************************
 *                                                                                                             *
 * Main entry point of a query. Schedules calls to aggregate_local                                             *
@@ -867,6 +940,14 @@ void Query::aggregate_internal(Action TAction, DataType TSourceColumn, bool null
     if (end == not_found)
         end = m_table->size();
 
+    if (pn->m_match_in_blocks) {
+        // Qualified call, as subclasses may override aggregate_local_prepare() with one that leaves the column
+        // action specializer used by aggregate_blocks() unset
+        pn->ParentNode::aggregate_local_prepare(TAction, TSourceColumn, nullable);
+        pn->aggregate_blocks(st, start, end, source_column);
+        return;
+    }
+
     for (size_t c = 0; c < pn->m_children.size(); c++)
         pn->m_children[c]->aggregate_local_prepare(TAction, TSourceColumn, nullable);
 
@@ -1192,11 +1273,21 @@ void Query::find_all(TableViewBase& ret, size_t begin, size_t end, size_t limit)
 
     REALM_ASSERT_3(begin, <=, m_table->size());
 
-    init();
-
     if (end == size_t(-1))
         end = m_table->size();
 
+    std::string key;
+    QueryCache* cache = get_result_cache(key, act_FindAll, npos, begin, end, limit);
+    if (cache) {
+        if (const QueryCache::Result* cached = cache->find(key, m_table->get_version_counter())) {
+            for (int64_t row : cached->rows)
+                ret.m_row_indexes.add(row);
+            return;
+        }
+    }
+
+    init();
+
     if (m_view) {
         for (size_t t = 0; t < m_view->size() && ret.size() < limit; t++) {
             size_t tablerow = static_cast<size_t>(m_view->m_row_indexes.get(t));
@@ -1213,10 +1304,19 @@ void Query::find_all(TableViewBase& ret, size_t begin, size_t end, size_t limit)
             }
         }
         else {
+            size_t first = ret.m_row_indexes.size();
             QueryState<int64_t> st;
             st.init(act_FindAll, &ret.m_row_indexes, limit);
             aggregate_internal(act_FindAll, ColumnTypeTraits<int64_t>::id, false, root_node(), &st, begin, end,
                                nullptr);
+
+            if (cache) {
+                QueryCache::Result result;
+                result.rows.reserve(ret.m_row_indexes.size() - first);
+                for (size_t i = first; i < ret.m_row_indexes.size(); ++i)
+                    result.rows.push_back(ret.m_row_indexes.get(i));
+                cache->insert(std::move(key), m_table->get_version_counter(), std::move(result)); // Throws
+            }
         }
     }
 }
@@ -1228,6 +1328,13 @@ TableView Query::find_all(size_t start, size_t end, size_t limit)
     return ret;
 }
 
+TableView Query::find_all(SortDescriptor order, size_t limit)
+{
+    TableView ret = find_all();
+    ret.sort(std::move(order), limit);
+    return ret;
+}
+
 
 size_t Query::count(size_t start, size_t end, size_t limit) const
 {
@@ -1247,6 +1354,13 @@ size_t Query::count(size_t start, size_t end, size_t limit) const
         }
     }
 
+    std::string key;
+    QueryCache* cache = get_result_cache(key, act_Count, npos, start, end, limit);
+    if (cache) {
+        if (const QueryCache::Result* cached = cache->find(key, m_table->get_version_counter()))
+            return cached->match_count;
+    }
+
     init();
     size_t cnt = 0;
 
@@ -1263,6 +1377,12 @@ size_t Query::count(size_t start, size_t end, size_t limit) const
         st.init(act_Count, nullptr, limit);
         aggregate_internal(act_Count, ColumnTypeTraits<int64_t>::id, false, root_node(), &st, start, end, nullptr);
         cnt = size_t(st.m_state);
+
+        if (cache) {
+            QueryCache::Result result;
+            result.match_count = cnt;
+            cache->insert(std::move(key), m_table->get_version_counter(), std::move(result)); // Throws
+        }
     }
 
     return cnt;
@@ -1432,6 +1552,11 @@ void Query::init() const
         root->init();
         std::vector<ParentNode*> v;
         root->gather_children(v);
+
+        // Conjunctions of simple column conditions are aggregated block by block, see ParentNode::aggregate_blocks()
+        auto block_capable = [](const ParentNode* node) { return node->can_match_block(); };
+        root->m_match_in_blocks = root->m_children.size() > 1 &&
+                                  std::all_of(root->m_children.begin(), root->m_children.end(), block_capable);
     }
 }
 
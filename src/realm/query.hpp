@@ -56,6 +56,9 @@ class Array;
 class Expression;
 class SequentialGetterBase;
 class Group;
+class QueryCache;
+class GroupByResult;
+struct GroupByAggregate;
 
 struct QueryGroup {
     enum class State {
@@ -170,6 +173,7 @@ public:
     Query& greater_equal(size_t column_ndx, Timestamp value);
     Query& less_equal(size_t column_ndx, Timestamp value);
     Query& less(size_t column_ndx, Timestamp value);
+    Query& between(size_t column_ndx, Timestamp from, Timestamp to);
 
     // Conditions: bool
     Query& equal(size_t column_ndx, bool value);
@@ -225,6 +229,12 @@ public:
     Query& ends_with(size_t column_ndx, BinaryData value);
     Query& contains(size_t column_ndx, BinaryData value);
 
+    // Conditions: set membership. Matches the rows whose value is equal to
+    // any of the given values, and is much faster than an equivalent chain of
+    // equal() conditions joined by Or().
+    Query& in(size_t column_ndx, std::vector<int64_t> values);
+    Query& in(size_t column_ndx, const std::vector<StringData>& values);
+
     // Negation
     Query& Not();
 
@@ -247,6 +257,11 @@ public:
     TableView find_all(size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1));
     ConstTableView find_all(size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
 
+    // Find the first `limit` matching rows in the order given by `order`. The
+    // matches are not sorted in full, so this is cheaper than sorting the
+    // result of find_all() when `limit` is small.
+    TableView find_all(SortDescriptor order, size_t limit);
+
     // Aggregates
     size_t count(size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
 
@@ -300,6 +315,12 @@ public:
     Timestamp minimum_timestamp(size_t column_ndx, size_t* return_ndx, size_t start = 0, size_t end = size_t(-1),
                                 size_t limit = size_t(-1));
 
+    // Group the matching rows, see Table::group_by(). With a `thread_count` above 1, queries of integer, float,
+    // double and string equality conditions are also matched in parallel, each thread matching and grouping its
+    // own range of rows.
+    GroupByResult group_by(const std::vector<size_t>& keys, const std::vector<GroupByAggregate>& aggregates,
+                           size_t thread_count = 1) const;
+
     // Deletion
     size_t remove();
 
@@ -405,6 +426,11 @@ private:
     void find_all(TableViewBase& tv, size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
     void delete_nodes() noexcept;
 
+    // Returns the result cache of the table if results of this query can be cached, and sets `key` to identify the
+    // call given by the arguments, see Table::enable_query_cache()
+    QueryCache* get_result_cache(std::string& key, Action action, size_t column_ndx, size_t start, size_t end,
+                                 size_t limit) const;
+
     bool has_conditions() const
     {
         return m_groups.size() > 0 && m_groups[0].m_root_node;
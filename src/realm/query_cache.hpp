@@ -0,0 +1,120 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_QUERY_CACHE_HPP
+#define REALM_QUERY_CACHE_HPP
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <realm/util/assert.hpp>
+
+namespace realm {
+
+// Results of counts, aggregates and find_all() of queries on one table, see Table::enable_query_cache(). Results
+// are keyed by the fingerprint of the query conditions (ParentNode::fingerprint()) and the arguments of the call,
+// and all of them belong to the version of the table they were computed at. Looking up a newer version drops them.
+// When the cache is full, inserting a result evicts the least recently used one.
+class QueryCache {
+public:
+    struct Result {
+        uint64_t state = 0; // Bits of the aggregate result, which is an int64_t, float or double
+        size_t match_count = 0;
+        size_t minmax_index = 0;
+        std::vector<int64_t> rows; // Matching rows, for find_all() only
+    };
+
+    explicit QueryCache(size_t max_entries)
+        : m_max_entries(max_entries)
+    {
+        REALM_ASSERT(max_entries > 0);
+    }
+
+    // Returns null if there is no result for `key` at `version` of the table
+    const Result* find(const std::string& key, uint_fast64_t version)
+    {
+        if (version != m_version) {
+            clear(version);
+            return nullptr;
+        }
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+            return nullptr;
+        ++m_hits;
+        m_results.splice(m_results.begin(), m_results, it->second); // Most recently used first
+        return &it->second->second;
+    }
+
+    void insert(std::string key, uint_fast64_t version, Result result)
+    {
+        if (version != m_version)
+            clear(version);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            it->second->second = std::move(result);
+            m_results.splice(m_results.begin(), m_results, it->second);
+            return;
+        }
+        if (m_results.size() >= m_max_entries) {
+            m_index.erase(m_results.back().first);
+            m_results.pop_back();
+        }
+        m_results.emplace_front(std::move(key), std::move(result)); // Throws
+        try {
+            m_index.emplace(m_results.front().first, m_results.begin()); // Throws
+        }
+        catch (...) {
+            m_results.pop_front();
+            throw;
+        }
+    }
+
+    size_t size() const noexcept
+    {
+        return m_results.size();
+    }
+
+    size_t hits() const noexcept
+    {
+        return m_hits;
+    }
+
+private:
+    using Entries = std::list<std::pair<std::string, Result>>;
+
+    size_t m_max_entries;
+    uint_fast64_t m_version = 0;
+    size_t m_hits = 0;
+    Entries m_results; // Most recently used first
+    std::unordered_map<std::string, Entries::iterator> m_index;
+
+    void clear(uint_fast64_t version) noexcept
+    {
+        m_index.clear();
+        m_results.clear();
+        m_version = version;
+    }
+};
+
+} // namespace realm
+
+#endif // REALM_QUERY_CACHE_HPP
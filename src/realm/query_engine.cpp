@@ -175,6 +175,38 @@ size_t ParentNode::aggregate_local(QueryStateBase* st, size_t start, size_t end,
     }
 }
 
+bool ParentNode::aggregate_blocks(QueryStateBase* st, size_t start, size_t end, SequentialGetterBase* source_column)
+{
+    // All conditions are evaluated for 64 rows at a time and their masks are ANDed together, instead of
+    // alternating between find_first_local() calls on each node. The remaining conditions are skipped once no rows
+    // are left in a block, and a condition that empties a block is moved one step ahead, so that the most selective
+    // conditions end up being evaluated first.
+    const size_t block_size = 64;
+    std::vector<ParentNode*> order(m_children);
+    while (start < end) {
+        size_t size = std::min(end - start, block_size);
+        uint64_t matches = size == block_size ? ~uint64_t(0) : (uint64_t(1) << size) - 1;
+        for (size_t c = 0; c < order.size(); c++) {
+            matches &= order[c]->match_block(start, size);
+            if (!matches) {
+                if (c > 0)
+                    std::swap(order[c - 1], order[c]);
+                break;
+            }
+        }
+
+        for (size_t i = 0; matches != 0; ++i, matches >>= 1) {
+            if (matches & 1) {
+                bool cont = (this->*m_column_action_specializer)(st, source_column, start + i);
+                if (!cont)
+                    return false;
+            }
+        }
+        start += size;
+    }
+    return true;
+}
+
 size_t NotNode::find_first_local(size_t start, size_t end)
 {
     if (start <= m_known_range_start && end >= m_known_range_end) {
@@ -307,3 +339,53 @@ size_t NotNode::find_first_no_overlap(size_t start, size_t end)
     }
     return result;
 }
+
+
+std::vector<size_t> LinkMap::get_origin_rows(Query& target_query) const
+{
+    std::vector<size_t> rows;
+    TableView matches = target_query.find_all();
+    rows.reserve(matches.size());
+    for (size_t i = 0; i < matches.size(); ++i)
+        rows.push_back(matches.get_source_ndx(i));
+
+    // Walk the link columns from the last one back to the base table, replacing
+    // the rows of each table by the rows of the previous table linking to them.
+    std::vector<size_t> origin_rows;
+    for (size_t column = m_link_columns.size(); column > 0 && !rows.empty(); --column) {
+        origin_rows.clear();
+        if (m_link_types[column - 1] == col_type_BackLink) {
+            // The rows are in the origin table of the backlink column, so the
+            // previous rows are those that their forward links point to.
+            const BacklinkColumn& bl = *static_cast<const BacklinkColumn*>(m_link_columns[column - 1]);
+            const Table& origin_table = bl.get_origin_table();
+            size_t origin_column_ndx = bl.get_origin_column_index();
+            if (origin_table.get_real_column_type(origin_column_ndx) == col_type_Link) {
+                const LinkColumn& cl = origin_table.get_column_link(origin_column_ndx);
+                for (size_t row : rows) {
+                    size_t target = to_size_t(cl.get(row));
+                    if (target != 0)
+                        origin_rows.push_back(target - 1); // LinkColumn stores link to row N as N + 1
+                }
+            }
+            else {
+                const LinkListColumn& cll = origin_table.get_column_link_list(origin_column_ndx);
+                for (size_t row : rows)
+                    cll.get_target_rows(row, origin_rows);
+            }
+        }
+        else {
+            const LinkColumnBase& link_column = *static_cast<const LinkColumnBase*>(m_link_columns[column - 1]);
+            const BacklinkColumn& bl = link_column.get_backlink_column();
+            for (size_t row : rows) {
+                size_t count = bl.get_backlink_count(row);
+                for (size_t i = 0; i < count; ++i)
+                    origin_rows.push_back(bl.get_backlink(row, i));
+            }
+        }
+        std::sort(origin_rows.begin(), origin_rows.end());
+        origin_rows.erase(std::unique(origin_rows.begin(), origin_rows.end()), origin_rows.end());
+        rows.swap(origin_rows);
+    }
+    return rows;
+}
@@ -87,6 +87,7 @@ AggregateState      State of the aggregate - contains a state variable that stor
 #include <algorithm>
 #include <functional>
 #include <string>
+#include <typeinfo>
 
 #include <realm/util/meta.hpp>
 #include <realm/util/miscellaneous.hpp>
@@ -105,6 +106,7 @@ AggregateState      State of the aggregate - contains a state variable that stor
 #include <realm/column_timestamp.hpp>
 #include <realm/column_type_traits.hpp>
 #include <realm/column_type_traits.hpp>
+#include <realm/impl/destroy_guard.hpp>
 #include <realm/link_view.hpp>
 #include <realm/query_conditions.hpp>
 #include <realm/query_expression.hpp>
@@ -217,6 +219,38 @@ public:
     virtual size_t aggregate_local(QueryStateBase* st, size_t start, size_t end, size_t local_limit,
                                    SequentialGetterBase* source_column);
 
+    // Conditions on a single column that can test a block of consecutive rows in one call return true, see
+    // match_block()
+    virtual bool can_match_block() const
+    {
+        return false;
+    }
+
+    // Return a mask with bit i set if row start + i matches this condition alone, for i < size <= 64. Only called
+    // if can_match_block() returns true.
+    virtual uint64_t match_block(size_t start, size_t size)
+    {
+        uint64_t matches = 0;
+        size_t end = start + size;
+        for (size_t s = find_first_local(start, end); s != not_found; s = find_first_local(s + 1, end))
+            matches |= uint64_t(1) << (s - start);
+        return matches;
+    }
+
+    // Run the conjunction of m_children in a single loop over blocks of 64 rows, ANDing the masks of match_block(),
+    // instead of finding matches of one node and testing the other nodes one row at a time. Used by
+    // Query::aggregate_internal() when Query::init() has set m_match_in_blocks.
+    bool aggregate_blocks(QueryStateBase* st, size_t start, size_t end, SequentialGetterBase* source_column);
+
+    // Append a key to `out` that identifies this condition and the conditions after it, for the query result cache
+    // of Table::enable_query_cache(). Returns false if some condition has no such key, in which case the results of
+    // the query are not cached.
+    bool fingerprint(std::string& out) const
+    {
+        if (!fingerprint_local(out))
+            return false;
+        return !m_child || m_child->fingerprint(out);
+    }
 
     virtual std::string validate()
     {
@@ -271,6 +305,9 @@ public:
     size_t m_probes = 0;
     size_t m_matches = 0;
 
+    // Set by Query::init() on the first node when all nodes of the conjunction can match blocks of rows
+    bool m_match_in_blocks = false;
+
 protected:
     typedef bool (ParentNode::*Column_action_specialized)(QueryStateBase*, SequentialGetterBase*, size_t);
     Column_action_specialized m_column_action_specializer;
@@ -295,6 +332,60 @@ protected:
         return m_table->get_real_column_type(ndx);
     }
 
+    // Append the key of this condition alone, see fingerprint(). Conditions start it with append_node_key(), which
+    // identifies the type of the node, including its column and condition types, and its column.
+    virtual bool fingerprint_local(std::string&) const
+    {
+        return false;
+    }
+
+    void append_node_key(std::string& out) const
+    {
+        append_key(out, StringData(typeid(*this).name()));
+        append_key(out, m_condition_column_idx);
+    }
+
+    template <class T>
+    static void append_key(std::string& out, T value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "");
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <class T>
+    static void append_key(std::string& out, const util::Optional<T>& value)
+    {
+        append_key(out, bool(value));
+        if (value)
+            append_key(out, *value);
+    }
+
+    static void append_key(std::string& out, BinaryData value)
+    {
+        append_key(out, value.is_null());
+        append_key(out, value.size());
+        out.append(value.data(), value.size());
+    }
+
+    static void append_key(std::string& out, StringData value)
+    {
+        append_key(out, BinaryData(value.data(), value.size()));
+    }
+
+    static void append_key(std::string& out, const std::string& value)
+    {
+        append_key(out, BinaryData(value.data(), value.size()));
+    }
+
+    static void append_key(std::string& out, Timestamp value)
+    {
+        append_key(out, value.is_null());
+        if (!value.is_null()) {
+            append_key(out, value.get_seconds());
+            append_key(out, value.get_nanoseconds());
+        }
+    }
+
     template <class ColType>
     void copy_getter(SequentialGetter<ColType>& dst, size_t& dst_idx, const SequentialGetter<ColType>& src,
                      const QueryNodeHandoverPatches* patches)
@@ -389,6 +480,16 @@ public:
         return not_found;
     }
 
+    bool fingerprint_local(std::string& out) const override
+    {
+        std::string condition;
+        if (!m_condition || !m_condition->fingerprint(condition))
+            return false;
+        append_node_key(out);
+        append_key(out, condition);
+        return true;
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new SubtableNode(*this, patches));
@@ -512,6 +613,71 @@ protected:
         nullptr; // Column of values used in aggregate (act_FindAll, actReturnFirst, act_Sum, etc)
 };
 
+// Test `size` values, starting at `ndx` in `leaf`, against `value`, and return a mask with bit `shift + i` set if
+// value i matches
+template <class TConditionFunction>
+uint64_t match_leaf_values(const ArrayInteger& leaf, size_t ndx, size_t size, int64_t value, size_t shift)
+{
+    TConditionFunction cond;
+    uint64_t matches = 0;
+    size_t i = 0;
+    int64_t chunk[8];
+    for (; i + 8 <= size; i += 8) {
+        // get_chunk() reads 8 values much faster than 8 calls to get()
+        leaf.get_chunk(ndx + i, chunk);
+        for (size_t j = 0; j < 8; ++j)
+            matches |= uint64_t(cond(chunk[j], value)) << (shift + i + j);
+    }
+    for (; i < size; ++i)
+        matches |= uint64_t(cond(leaf.get(ndx + i), value)) << (shift + i);
+    return matches;
+}
+
+template <class TConditionFunction>
+uint64_t match_leaf_values(const ArrayIntNull& leaf, size_t ndx, size_t size, util::Optional<int64_t> value,
+                           size_t shift)
+{
+    TConditionFunction cond;
+    uint64_t matches = 0;
+    for (size_t i = 0; i < size; ++i) {
+        util::Optional<int64_t> v = leaf.get(ndx + i);
+        bool match = cond(v ? *v : 0, value ? *value : 0, !v, !value);
+        matches |= uint64_t(match) << (shift + i);
+    }
+    return matches;
+}
+
+// Test the seconds of `size` timestamps, starting at `ndx` in `leaf`, against `seconds`. Set bit `shift + i` of
+// the result if value i is greater than `seconds` (if `greater`) or less than it (otherwise), and the same bit of
+// `equal` if it is equal. Nulls set neither bit.
+template <bool greater, size_t width>
+uint64_t match_leaf_seconds(const Array& leaf, size_t ndx, size_t size, int64_t seconds, size_t shift,
+                            uint64_t& equal)
+{
+    // This is the plain array below the nullable one, where entry 0 is the null value and value i is entry i + 1
+    int64_t null_value = leaf.get<width>(0);
+    uint64_t matches = 0;
+    for (size_t i = 0; i < size; ++i) {
+        int64_t v = leaf.get<width>(ndx + i + 1);
+        bool not_null = v != null_value;
+        bool beyond = greater ? v > seconds : v < seconds;
+        matches |= uint64_t(beyond & not_null) << (shift + i);
+        equal |= uint64_t((v == seconds) & not_null) << (shift + i);
+    }
+    return matches;
+}
+
+template <bool greater>
+uint64_t match_leaf_seconds(const ArrayIntNull& leaf, size_t ndx, size_t size, int64_t seconds, size_t shift,
+                            uint64_t& equal)
+{
+    const Array& array = leaf;
+    uint64_t matches;
+    REALM_TEMPEX2(matches = match_leaf_seconds, greater, array.get_width(),
+                  (array, ndx, size, seconds, shift, equal));
+    return matches;
+}
+
 template <class ColType>
 class IntegerNodeBase : public ColumnNodeBase {
     using ThisType = IntegerNodeBase<ColType>;
@@ -745,6 +911,31 @@ public:
         return not_found;
     }
 
+    bool can_match_block() const override
+    {
+        return true;
+    }
+
+    uint64_t match_block(size_t start, size_t size) override
+    {
+        uint64_t matches = 0;
+        for (size_t i = 0; i < size;) {
+            this->cache_leaf(start + i);
+            size_t n = std::min(size - i, this->m_leaf_end - (start + i));
+            matches |= match_leaf_values<TConditionFunction>(*this->m_leaf_ptr, start + i - this->m_leaf_start, n,
+                                                             this->m_value, i);
+            i += n;
+        }
+        return matches;
+    }
+
+    bool fingerprint_local(std::string& out) const override
+    {
+        this->append_node_key(out);
+        this->append_key(out, this->m_value);
+        return true;
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new IntegerNode<ColType, TConditionFunction>(*this, patches));
@@ -814,6 +1005,115 @@ protected:
     }
 };
 
+// Matches rows whose value is any of a set of integers, see Query::in(). Indexed columns are answered from the
+// search index, and other columns are scanned once, looking up each value in the sorted set.
+template <class ColType>
+class IntegerInNode : public ParentNode {
+public:
+    IntegerInNode(std::vector<int64_t> values, size_t column_idx)
+        : m_values(std::move(values))
+    {
+        m_condition_column_idx = column_idx;
+        std::sort(m_values.begin(), m_values.end());
+        m_values.erase(std::unique(m_values.begin(), m_values.end()), m_values.end());
+    }
+
+    IntegerInNode(const IntegerInNode& from, QueryNodeHandoverPatches* patches)
+        : ParentNode(from, patches)
+        , m_values(from.m_values)
+        , m_condition_column(from.m_condition_column)
+    {
+        if (m_condition_column && patches)
+            m_condition_column_idx = m_condition_column->get_column_index();
+    }
+
+    void table_changed() override
+    {
+        m_condition_column = &get_column<ColType>(m_condition_column_idx);
+    }
+
+    void init() override
+    {
+        ParentNode::init();
+
+        m_dD = 100.0;
+        m_index_matches.clear();
+        m_getter.init(m_condition_column);
+
+        if (m_condition_column->has_search_index()) {
+            m_dT = 0.0;
+            Allocator& alloc = Allocator::get_default();
+            IntegerColumn matches(alloc, IntegerColumn::create(alloc)); // Throws
+            _impl::DestroyGuard<IntegerColumn> dg(&matches);
+            const StringIndex* index = m_condition_column->get_search_index();
+            for (int64_t value : m_values)
+                index->find_all(matches, typename ColType::value_type(value)); // Throws
+            m_index_matches.reserve(matches.size());
+            for (size_t i = 0; i < matches.size(); ++i)
+                m_index_matches.push_back(to_size_t(matches.get(i)));
+            std::sort(m_index_matches.begin(), m_index_matches.end());
+        }
+        else {
+            m_dT = _impl::CostHeuristic<ColType>::dT();
+        }
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_condition_column->has_search_index()) {
+            auto it = std::lower_bound(m_index_matches.begin(), m_index_matches.end(), start);
+            return (it != m_index_matches.end() && *it < end) ? *it : not_found;
+        }
+
+        if (m_values.empty())
+            return not_found;
+
+        for (size_t s = start; s < end;) {
+            m_getter.cache_next(s);
+            size_t local_end = m_getter.local_end(end);
+            for (size_t i = s - m_getter.m_leaf_start; i < local_end; ++i) {
+                if (contains(m_getter.m_leaf_ptr->get(i)))
+                    return i + m_getter.m_leaf_start;
+            }
+            s = m_getter.m_leaf_end;
+        }
+        return not_found;
+    }
+
+    bool fingerprint_local(std::string& out) const override
+    {
+        append_node_key(out);
+        append_key(out, m_values.size());
+        for (int64_t value : m_values)
+            append_key(out, value);
+        return true;
+    }
+
+    std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
+    {
+        return std::unique_ptr<ParentNode>(new IntegerInNode<ColType>(*this, patches));
+    }
+
+private:
+    bool contains(int64_t value) const
+    {
+        if (value < m_values.front() || value > m_values.back())
+            return false;
+        return std::binary_search(m_values.begin(), m_values.end(), value);
+    }
+
+    bool contains(util::Optional<int64_t> value) const
+    {
+        return value && contains(*value);
+    }
+
+    // Sorted and without duplicates
+    std::vector<int64_t> m_values;
+    const ColType* m_condition_column = nullptr;
+    SequentialGetter<ColType> m_getter;
+    std::vector<size_t> m_index_matches;
+};
+
 // This node is currently used for floats and doubles only
 template <class ColType, class TConditionFunction>
 class FloatDoubleNode : public ParentNode {
@@ -867,6 +1167,39 @@ public:
             return find(false);
     }
 
+    bool can_match_block() const override
+    {
+        return true;
+    }
+
+    uint64_t match_block(size_t start, size_t size) override
+    {
+        TConditionFunction cond;
+        bool nullable = m_table->is_nullable(m_condition_column_idx);
+        bool value_nan = nullable && null::is_null_float(m_value);
+        uint64_t matches = 0;
+        for (size_t i = 0; i < size;) {
+            // Read the values from the leaf rather than through get_next(), which looks up every row in the B+tree
+            m_condition_column.cache_next(start + i);
+            size_t n = std::min(size - i, m_condition_column.m_leaf_end - (start + i));
+            size_t ndx = start + i - m_condition_column.m_leaf_start;
+            for (size_t j = 0; j < n; ++j) {
+                TConditionValue v = m_condition_column.m_leaf_ptr->get(ndx + j);
+                bool match = cond(v, m_value, nullable && null::is_null_float(v), value_nan);
+                matches |= uint64_t(match) << (i + j);
+            }
+            i += n;
+        }
+        return matches;
+    }
+
+    bool fingerprint_local(std::string& out) const override
+    {
+        this->append_node_key(out);
+        this->append_key(out, m_value);
+        return true;
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new FloatDoubleNode(*this, patches));
@@ -927,6 +1260,13 @@ public:
         return not_found;
     }
 
+    bool fingerprint_local(std::string& out) const override
+    {
+        this->append_node_key(out);
+        this->append_key(out, m_value.get());
+        return true;
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new BinaryNode(*this, patches));
@@ -973,6 +1313,10 @@ public:
     {
         m_dD = 100.0;
 
+        // Clear leaf cache
+        m_leaf_end = 0;
+        m_leaf_cache.reset(new ArrayIntNull(m_table->get_alloc()));
+
         if (m_child)
             m_child->init();
     }
@@ -983,6 +1327,52 @@ public:
         return ret;
     }
 
+    bool can_match_block() const override
+    {
+        return true;
+    }
+
+    uint64_t match_block(size_t start, size_t size) override
+    {
+        const bool greater = std::is_same<TConditionFunction, Greater>::value ||
+                             std::is_same<TConditionFunction, GreaterEqual>::value;
+        const bool less =
+            std::is_same<TConditionFunction, Less>::value || std::is_same<TConditionFunction, LessEqual>::value;
+        if ((!greater && !less) || m_value.is_null())
+            return ParentNode::match_block(start, size);
+
+        // Range conditions are decided by the seconds alone, except for rows with the same seconds as m_value
+        int64_t seconds = m_value.get_seconds();
+        uint64_t matches = 0;
+        uint64_t equal = 0;
+        for (size_t i = 0; i < size;) {
+            if (start + i >= m_leaf_end || start + i < m_leaf_start) {
+                size_t ndx_in_leaf;
+                TimestampColumn::SecondsLeafInfo leaf{&m_leaf_ptr, m_leaf_cache.get()};
+                m_condition_column->get_seconds_leaf(start + i, ndx_in_leaf, leaf);
+                m_leaf_start = start + i - ndx_in_leaf;
+                m_leaf_end = m_leaf_start + m_leaf_ptr->size();
+            }
+            size_t n = std::min(size - i, m_leaf_end - (start + i));
+            matches |= match_leaf_seconds<greater>(*m_leaf_ptr, start + i - m_leaf_start, n, seconds, i, equal);
+            i += n;
+        }
+
+        TConditionFunction cond;
+        for (size_t bit = 0; equal != 0; ++bit, equal >>= 1) {
+            if (equal & 1)
+                matches |= uint64_t(cond(m_condition_column->get(start + bit), m_value)) << bit;
+        }
+        return matches;
+    }
+
+    bool fingerprint_local(std::string& out) const override
+    {
+        this->append_node_key(out);
+        this->append_key(out, m_value);
+        return true;
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new TimestampNode(*this, patches));
@@ -1000,6 +1390,12 @@ public:
 private:
     Timestamp m_value;
     const TimestampColumn* m_condition_column;
+
+    // Leaf cache of match_block()
+    std::unique_ptr<ArrayIntNull> m_leaf_cache;
+    const ArrayIntNull* m_leaf_ptr = nullptr;
+    size_t m_leaf_start = 0;
+    size_t m_leaf_end = 0;
 };
 
 class StringNodeBase : public ParentNode {
@@ -1077,14 +1473,50 @@ public:
         }
     }
 
+    ~StringNode() noexcept override
+    {
+        deallocate();
+    }
+
+    void deallocate() noexcept
+    {
+        if (m_index_matches)
+            m_index_matches->destroy();
+        m_index_matches.reset();
+    }
+
     void init() override
     {
         clear_leaf_state();
+        deallocate();
 
         m_dD = 100.0;
 
         StringNodeBase::init();
 
+        // Case insensitive equality can be answered by the search index
+        if (std::is_same<TConditionFunction, EqualIns>::value && m_condition_column->has_search_index() &&
+            m_ucase.size() == value_size() && m_lcase.size() == value_size()) {
+            m_dT = 0.0;
+            Allocator& alloc = Allocator::get_default();
+            ref_type ref = IntegerColumn::create(alloc); // Throws
+            m_index_matches.reset(new IntegerColumn(alloc, ref)); // Throws
+            m_condition_column->get_search_index()->find_all_case_insensitive(
+                *m_index_matches, StringData(m_value), m_ucase.data(), m_lcase.data()); // Throws
+        }
+        else if (m_column_type == col_type_StringEnum) {
+            // The condition only depends on the string, so evaluate it once
+            // per key instead of once per row.
+            const StringEnumColumn* cse = static_cast<const StringEnumColumn*>(m_condition_column);
+            const StringColumn& keys = cse->get_keys();
+            size_t num_keys = keys.size();
+            TConditionFunction cond;
+            m_key_matches.assign(num_keys, false);
+            for (size_t i = 0; i < num_keys; ++i)
+                m_key_matches[i] = cond(StringData(m_value), m_ucase.data(), m_lcase.data(), keys.get(i));
+            m_cse.init(cse);
+        }
+
         if (m_child)
             m_child->init();
     }
@@ -1092,47 +1524,73 @@ public:
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (m_index_matches) {
+            // Indexed string column. The matches are in ascending order.
+            size_t ndx = m_index_matches->lower_bound(int64_t(start));
+            if (ndx == m_index_matches->size())
+                return not_found;
+            size_t found_index = to_size_t(m_index_matches->get(ndx));
+            return found_index < end ? found_index : not_found;
+        }
+
+        if (m_column_type == col_type_StringEnum) {
+            // Enum string column
+            for (size_t s = start; s < end; ++s) {
+                m_cse.cache_next(s);
+                size_t local_end = m_cse.local_end(end);
+                for (size_t i = s - m_cse.m_leaf_start; i < local_end; ++i) {
+                    size_t key_ndx = to_size_t(m_cse.m_leaf_ptr->get(i));
+                    if (m_key_matches[key_ndx])
+                        return i + m_cse.m_leaf_start;
+                }
+                s = m_cse.m_leaf_end - 1;
+            }
+            return not_found;
+        }
+
         TConditionFunction cond;
 
         for (size_t s = start; s < end; ++s) {
             StringData t;
 
-            if (m_column_type == col_type_StringEnum) {
-                // enum
-                t = static_cast<const StringEnumColumn*>(m_condition_column)->get(s);
-            }
-            else {
-                // short or long
-                const StringColumn* asc = static_cast<const StringColumn*>(m_condition_column);
-                REALM_ASSERT_3(s, <, asc->size());
-                if (s >= m_end_s || s < m_leaf_start) {
-                    // we exceeded current leaf's range
-                    clear_leaf_state();
-                    size_t ndx_in_leaf;
-                    m_leaf = asc->get_leaf(s, ndx_in_leaf, m_leaf_type);
-                    m_leaf_start = s - ndx_in_leaf;
-
-                    if (m_leaf_type == StringColumn::leaf_type_Small)
-                        m_end_s = m_leaf_start + static_cast<const ArrayString&>(*m_leaf).size();
-                    else if (m_leaf_type == StringColumn::leaf_type_Medium)
-                        m_end_s = m_leaf_start + static_cast<const ArrayStringLong&>(*m_leaf).size();
-                    else
-                        m_end_s = m_leaf_start + static_cast<const ArrayBigBlobs&>(*m_leaf).size();
-                }
+            // short or long
+            const StringColumn* asc = static_cast<const StringColumn*>(m_condition_column);
+            REALM_ASSERT_3(s, <, asc->size());
+            if (s >= m_end_s || s < m_leaf_start) {
+                // we exceeded current leaf's range
+                clear_leaf_state();
+                size_t ndx_in_leaf;
+                m_leaf = asc->get_leaf(s, ndx_in_leaf, m_leaf_type);
+                m_leaf_start = s - ndx_in_leaf;
 
                 if (m_leaf_type == StringColumn::leaf_type_Small)
-                    t = static_cast<const ArrayString&>(*m_leaf).get(s - m_leaf_start);
+                    m_end_s = m_leaf_start + static_cast<const ArrayString&>(*m_leaf).size();
                 else if (m_leaf_type == StringColumn::leaf_type_Medium)
-                    t = static_cast<const ArrayStringLong&>(*m_leaf).get(s - m_leaf_start);
+                    m_end_s = m_leaf_start + static_cast<const ArrayStringLong&>(*m_leaf).size();
                 else
-                    t = static_cast<const ArrayBigBlobs&>(*m_leaf).get_string(s - m_leaf_start);
+                    m_end_s = m_leaf_start + static_cast<const ArrayBigBlobs&>(*m_leaf).size();
             }
+
+            if (m_leaf_type == StringColumn::leaf_type_Small)
+                t = static_cast<const ArrayString&>(*m_leaf).get(s - m_leaf_start);
+            else if (m_leaf_type == StringColumn::leaf_type_Medium)
+                t = static_cast<const ArrayStringLong&>(*m_leaf).get(s - m_leaf_start);
+            else
+                t = static_cast<const ArrayBigBlobs&>(*m_leaf).get_string(s - m_leaf_start);
+
             if (cond(StringData(m_value), m_ucase.data(), m_lcase.data(), t))
                 return s;
         }
         return not_found;
     }
 
+    bool fingerprint_local(std::string& out) const override
+    {
+        this->append_node_key(out);
+        this->append_key(out, m_value);
+        return true;
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new StringNode<TConditionFunction>(*this, patches));
@@ -1148,6 +1606,19 @@ public:
 protected:
     std::string m_ucase;
     std::string m_lcase;
+
+    // Used for linear scan through enum-string. Whether the condition holds
+    // for each key of the column.
+    std::vector<bool> m_key_matches;
+    SequentialGetter<StringEnumColumn> m_cse;
+
+    // Used for index lookup (EqualIns only)
+    std::unique_ptr<IntegerColumn> m_index_matches;
+
+    size_t value_size() const noexcept
+    {
+        return m_value ? m_value->size() : 0;
+    }
 };
 
 
@@ -1341,6 +1812,19 @@ public:
         return not_found;
     }
 
+    // Without an index, the generic match_block() scans the leaves like a search does
+    bool can_match_block() const override
+    {
+        return !m_condition_column->has_search_index();
+    }
+
+    bool fingerprint_local(std::string& out) const override
+    {
+        this->append_node_key(out);
+        this->append_key(out, m_value);
+        return true;
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new StringNode<Equal>(*this, patches));
@@ -1372,6 +1856,159 @@ private:
     size_t m_last_start;
 };
 
+// Matches rows whose string is any of a set of strings, see Query::in(). Indexed columns are answered from the
+// search index, enumerated columns compare each key once, and other columns look up each string in the sorted set.
+class StringInNode : public StringNodeBase {
+public:
+    StringInNode(const std::vector<StringData>& values, size_t column)
+        : StringNodeBase(StringData(), column)
+    {
+        for (StringData value : values) {
+            if (value.is_null())
+                m_has_null = true;
+            else
+                m_values.push_back(value);
+        }
+        // Ordered like StringData, which compares bytes as signed chars
+        std::sort(m_values.begin(), m_values.end(),
+                  [](const std::string& a, const std::string& b) { return StringData(a) < StringData(b); });
+        m_values.erase(std::unique(m_values.begin(), m_values.end()), m_values.end());
+    }
+
+    StringInNode(const StringInNode& from, QueryNodeHandoverPatches* patches)
+        : StringNodeBase(from, patches)
+        , m_values(from.m_values)
+        , m_has_null(from.m_has_null)
+    {
+    }
+
+    void init() override
+    {
+        clear_leaf_state();
+        m_index_matches.clear();
+
+        m_dD = 100.0;
+
+        StringNodeBase::init();
+
+        if (m_condition_column->has_search_index()) {
+            m_dT = 0.0;
+            Allocator& alloc = Allocator::get_default();
+            IntegerColumn matches(alloc, IntegerColumn::create(alloc)); // Throws
+            _impl::DestroyGuard<IntegerColumn> dg(&matches);
+            const StringIndex* index = m_condition_column->get_search_index();
+            for (const std::string& value : m_values)
+                index->find_all(matches, StringData(value)); // Throws
+            if (m_has_null)
+                index->find_all(matches, StringData()); // Throws
+            m_index_matches.reserve(matches.size());
+            for (size_t i = 0; i < matches.size(); ++i)
+                m_index_matches.push_back(to_size_t(matches.get(i)));
+            std::sort(m_index_matches.begin(), m_index_matches.end());
+        }
+        else if (m_column_type == col_type_StringEnum) {
+            const StringEnumColumn* cse = static_cast<const StringEnumColumn*>(m_condition_column);
+            const StringColumn& keys = cse->get_keys();
+            size_t num_keys = keys.size();
+            m_key_matches.assign(num_keys, false);
+            for (size_t i = 0; i < num_keys; ++i)
+                m_key_matches[i] = contains(keys.get(i));
+            m_cse.init(cse);
+        }
+
+        if (m_child)
+            m_child->init();
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_condition_column->has_search_index()) {
+            auto it = std::lower_bound(m_index_matches.begin(), m_index_matches.end(), start);
+            return (it != m_index_matches.end() && *it < end) ? *it : not_found;
+        }
+
+        if (m_column_type == col_type_StringEnum) {
+            for (size_t s = start; s < end; ++s) {
+                m_cse.cache_next(s);
+                size_t local_end = m_cse.local_end(end);
+                for (size_t i = s - m_cse.m_leaf_start; i < local_end; ++i) {
+                    size_t key_ndx = to_size_t(m_cse.m_leaf_ptr->get(i));
+                    if (m_key_matches[key_ndx])
+                        return i + m_cse.m_leaf_start;
+                }
+                s = m_cse.m_leaf_end - 1;
+            }
+            return not_found;
+        }
+
+        const StringColumn* asc = static_cast<const StringColumn*>(m_condition_column);
+        for (size_t s = start; s < end; ++s) {
+            if (s >= m_end_s || s < m_leaf_start) {
+                clear_leaf_state();
+                size_t ndx_in_leaf;
+                m_leaf = asc->get_leaf(s, ndx_in_leaf, m_leaf_type);
+                m_leaf_start = s - ndx_in_leaf;
+
+                if (m_leaf_type == StringColumn::leaf_type_Small)
+                    m_end_s = m_leaf_start + static_cast<const ArrayString&>(*m_leaf).size();
+                else if (m_leaf_type == StringColumn::leaf_type_Medium)
+                    m_end_s = m_leaf_start + static_cast<const ArrayStringLong&>(*m_leaf).size();
+                else
+                    m_end_s = m_leaf_start + static_cast<const ArrayBigBlobs&>(*m_leaf).size();
+            }
+
+            StringData t;
+            if (m_leaf_type == StringColumn::leaf_type_Small)
+                t = static_cast<const ArrayString&>(*m_leaf).get(s - m_leaf_start);
+            else if (m_leaf_type == StringColumn::leaf_type_Medium)
+                t = static_cast<const ArrayStringLong&>(*m_leaf).get(s - m_leaf_start);
+            else
+                t = static_cast<const ArrayBigBlobs&>(*m_leaf).get_string(s - m_leaf_start);
+
+            if (contains(t))
+                return s;
+        }
+        return not_found;
+    }
+
+    bool fingerprint_local(std::string& out) const override
+    {
+        append_node_key(out);
+        append_key(out, m_has_null);
+        append_key(out, m_values.size());
+        for (auto& value : m_values)
+            append_key(out, value);
+        return true;
+    }
+
+    std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
+    {
+        return std::unique_ptr<ParentNode>(new StringInNode(*this, patches));
+    }
+
+private:
+    bool contains(StringData value) const
+    {
+        if (value.is_null())
+            return m_has_null;
+        auto it = std::lower_bound(m_values.begin(), m_values.end(), value,
+                                   [](const std::string& a, StringData b) { return StringData(a) < b; });
+        return it != m_values.end() && StringData(*it) == value;
+    }
+
+    // Sorted and without duplicates
+    std::vector<std::string> m_values;
+    bool m_has_null = false;
+
+    // Used for linear scan through enum-string. Whether each key of the
+    // column is in the set.
+    std::vector<bool> m_key_matches;
+    SequentialGetter<StringEnumColumn> m_cse;
+
+    // Used for index lookup
+    std::vector<size_t> m_index_matches;
+};
+
 // OR node contains at least two node pointers: Two or more conditions to OR
 // together in m_conditions, and the next AND condition (if any) in m_child.
 //
@@ -1418,6 +2055,9 @@ public:
         m_was_match.clear();
         m_was_match.resize(m_conditions.size(), false);
 
+        m_block_start = 0;
+        m_block_end = 0;
+
         std::vector<ParentNode*> v;
         for (auto& condition : m_conditions) {
             condition->init();
@@ -1434,6 +2074,9 @@ public:
         if (start >= end)
             return not_found;
 
+        if (m_conditions.size() >= block_min_conditions)
+            return find_first_in_blocks(start, end);
+
         size_t index = not_found;
 
         for (size_t c = 0; c < m_conditions.size(); ++c) {
@@ -1485,6 +2128,19 @@ public:
         return "";
     }
 
+    bool fingerprint_local(std::string& out) const override
+    {
+        append_node_key(out);
+        append_key(out, m_conditions.size());
+        for (auto& condition : m_conditions) {
+            std::string key;
+            if (!condition->fingerprint(key))
+                return false;
+            append_key(out, key);
+        }
+        return true;
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new OrNode(*this, patches));
@@ -1501,12 +2157,67 @@ public:
     std::vector<std::unique_ptr<ParentNode>> m_conditions;
 
 private:
+    // With many conditions, finding the next match of each condition for
+    // every match of the OR dominates. Instead, the matches of all conditions
+    // within a block of rows are collected in a bitmap, so each condition is
+    // searched once per block.
+    static const size_t block_min_conditions = 8;
+    static const size_t block_size = 1024;
+
+    size_t find_first_in_blocks(size_t start, size_t end)
+    {
+        while (start < end) {
+            if (start < m_block_start || start >= m_block_end)
+                fill_block(start, std::min(start + block_size, end));
+
+            size_t scan_end = std::min(m_block_end, end);
+            size_t i = start - m_block_start;
+            size_t i_end = scan_end - m_block_start;
+            while (i < i_end) {
+                uint64_t word = m_block_bits[i / 64] >> (i % 64);
+                if (word == 0) {
+                    i = (i / 64 + 1) * 64;
+                    continue;
+                }
+                while ((word & 1) == 0) {
+                    word >>= 1;
+                    ++i;
+                }
+                if (i < i_end)
+                    return m_block_start + i;
+                break;
+            }
+            start = scan_end;
+        }
+        return not_found;
+    }
+
+    void fill_block(size_t start, size_t end)
+    {
+        m_block_start = start;
+        m_block_end = end;
+        m_block_bits.assign((end - start + 63) / 64, 0);
+        for (auto& condition : m_conditions) {
+            size_t f = condition->find_first(start, end);
+            while (f != not_found) {
+                size_t i = f - start;
+                m_block_bits[i / 64] |= uint64_t(1) << (i % 64);
+                f = condition->find_first(f + 1, end);
+            }
+        }
+    }
+
     // start index of the last find for each cond
     std::vector<size_t> m_start;
     // last looked at index of the lasft find for each cond
     // is a matching index if m_was_match is true
     std::vector<size_t> m_last;
     std::vector<bool> m_was_match;
+
+    // Matches of any condition in rows [m_block_start, m_block_end)
+    size_t m_block_start = 0;
+    size_t m_block_end = 0;
+    std::vector<uint64_t> m_block_bits;
 };
 
 
@@ -1561,6 +2272,16 @@ public:
         return "";
     }
 
+    bool fingerprint_local(std::string& out) const override
+    {
+        std::string condition;
+        if (!m_condition || !m_condition->fingerprint(condition))
+            return false;
+        append_node_key(out);
+        append_key(out, condition);
+        return true;
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new NotNode(*this, patches));
@@ -1680,6 +2401,14 @@ public:
         return not_found;
     }
 
+    bool fingerprint_local(std::string& out) const override
+    {
+        this->append_node_key(out);
+        this->append_key(out, m_condition_column_idx1);
+        this->append_key(out, m_condition_column_idx2);
+        return true;
+    }
+
     std::unique_ptr<ParentNode> clone(QueryNodeHandoverPatches* patches) const override
     {
         return std::unique_ptr<ParentNode>(new TwoColumnsNode<ColType, TConditionFunction>(*this, patches));
@@ -1721,6 +2450,12 @@ public:
         m_dT = 50.0;
     }
 
+    void init() override
+    {
+        ParentNode::init();
+        m_expression->init();
+    }
+
     void table_changed() override
     {
         m_expression->set_base_table(m_table.get());
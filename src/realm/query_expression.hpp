@@ -83,10 +83,14 @@ size_t Compare<Greater>::find_first()-------------+
                                                Value<float>::evaluate()    Columns<float>::evaluate()
 
 Operator, Value and Columns have an evaluate(size_t i, ValueBase* destination) method which returns a Value<T>
-containing 8 values representing table rows i...i + 7.
+containing values representing table rows i...i + n - 1. The caller asks for n rows by passing a destination of
+size n; Compare asks for ValueBase::chunk_size (64) rows at a time when it scans consecutive rows, and for
+ValueBase::default_size (8) rows when it tests scattered rows.
 
-So Value<T> contains 8 concecutive values and all operations are based on these chunks. This is
+So Value<T> contains up to 64 concecutive values and all operations are based on these chunks. This is
 to save overhead by virtual calls needed for evaluating a query that has been dynamically constructed at runtime.
+Compare remembers which rows of the most recent chunk matched, so a chunk is evaluated only once when searching
+for all matches.
 
 
 Memory allocation:
@@ -324,7 +328,11 @@ private:
 
 
 struct ValueBase {
+    // Number of rows evaluated at a time when a condition is tested on a few scattered rows
     static const size_t default_size = 8;
+    // Number of rows evaluated at a time when a condition is tested on consecutive rows. The matches of a block
+    // are kept as a bit mask, so this must not exceed 64.
+    static const size_t chunk_size = 64;
     virtual void export_bool(ValueBase& destination) const = 0;
     virtual void export_Timestamp(ValueBase& destination) const = 0;
     virtual void export_int(ValueBase& destination) const = 0;
@@ -358,6 +366,12 @@ public:
     virtual void set_base_table(const Table* table) = 0;
     virtual const Table* get_base_table() const = 0;
 
+    // Called before each search, after the base table has been set, so that expressions can prepare state that
+    // depends on the contents of the tables.
+    virtual void init()
+    {
+    }
+
     virtual std::unique_ptr<Expression> clone(QueryNodeHandoverPatches*) const = 0;
     virtual void apply_handover_patch(QueryNodeHandoverPatches&, Group&)
     {
@@ -370,6 +384,8 @@ std::unique_ptr<Expression> make_expression(Args&&... args)
     return std::unique_ptr<Expression>(new T(std::forward<Args>(args)...));
 }
 
+class LinkMap;
+
 class Subexpr {
 public:
     virtual ~Subexpr()
@@ -400,6 +416,14 @@ public:
         return nullptr;
     }
 
+    // Columns that are reached through links return their link map and set the argument to the index of the
+    // column in the target table, so that conditions on them can be evaluated on the target table first. All
+    // other subexpressions return nullptr.
+    virtual const LinkMap* get_link_map(size_t&) const
+    {
+        return nullptr;
+    }
+
     virtual void evaluate(size_t index, ValueBase& destination) = 0;
 };
 
@@ -759,7 +783,7 @@ The query system will then construct a NullableVector of type `null` (NullableVe
 time optimizations for these cases.
 */
 
-template <class T, size_t prealloc = 8>
+template <class T, size_t prealloc = ValueBase::chunk_size>
 struct NullableVector {
     using Underlying = typename util::RemoveOptional<T>::type;
     using t_storage =
@@ -810,6 +834,16 @@ struct NullableVector {
         m_first[index] = m_null;
     }
 
+    // Whether any of the first `size` values is null. Written without an early exit so that it compiles to a
+    // branch free loop.
+    bool has_null(size_t size) const
+    {
+        bool found = false;
+        for (size_t t = 0; t < size; t++)
+            found |= is_null(t);
+        return found;
+    }
+
     template <typename Type = t_storage>
     typename std::enable_if<std::is_same<Type, int64_t>::value, void>::type set(size_t index, t_storage value)
     {
@@ -1038,11 +1072,11 @@ class Value : public ValueBase, public Subexpr2<T> {
 public:
     Value()
     {
-        init(false, ValueBase::default_size, T());
+        init(false, ValueBase::chunk_size, T());
     }
     Value(T v)
     {
-        init(false, ValueBase::default_size, v);
+        init(false, ValueBase::chunk_size, v);
     }
 
     Value(bool from_link_list, size_t values)
@@ -1088,6 +1122,9 @@ public:
             size_t min = std::min(left->m_values, right->m_values);
             init(false, min);
 
+            if (fun_no_nulls<TOperator>(left, right, min))
+                return;
+
             for (size_t i = 0; i < min; i++) {
                 m_storage.set(i, o(left->m_storage.get(i), right->m_storage.get(i)));
             }
@@ -1118,6 +1155,33 @@ public:
         }
     }
 
+    // Arithmetic on blocks without nulls, which is the common case, in a loop that the compiler can vectorize.
+    // Returns false, leaving the values to the general loop above, if there are nulls or if a result happens to
+    // collide with the magic value that represents null.
+    template <class TOperator, class U = T>
+    typename std::enable_if<realm::is_any<U, int64_t, float, double>::value, bool>::type
+    fun_no_nulls(const Value* left, const Value* right, size_t size)
+    {
+        if (left->m_storage.has_null(size) || right->m_storage.has_null(size))
+            return false;
+
+        TOperator o;
+        const auto* l = left->m_storage.m_first;
+        const auto* r = right->m_storage.m_first;
+        auto* d = m_storage.m_first;
+        for (size_t i = 0; i < size; i++)
+            d[i] = o(l[i], r[i]);
+
+        return !m_storage.has_null(size);
+    }
+
+    template <class TOperator, class U = T>
+    typename std::enable_if<!realm::is_any<U, int64_t, float, double>::value, bool>::type
+    fun_no_nulls(const Value*, const Value*, size_t)
+    {
+        return false;
+    }
+
     template <class TOperator>
     REALM_FORCEINLINE void fun(const Value* value)
     {
@@ -1136,7 +1200,17 @@ public:
     export2(ValueBase& destination) const
     {
         Value<D>& d = static_cast<Value<D>&>(destination);
-        d.init(ValueBase::m_from_link_list, ValueBase::m_values, D());
+        d.init(ValueBase::m_from_link_list, ValueBase::m_values);
+
+        // Numbers without nulls are copied in a loop that the compiler can vectorize, unless a value happens to
+        // collide with the magic value that represents null in the destination
+        if (std::is_arithmetic<T>::value && std::is_arithmetic<D>::value && !m_storage.has_null(m_values)) {
+            for (size_t t = 0; t < ValueBase::m_values; t++)
+                d.m_storage.m_first[t] = static_cast<D>(m_storage.m_first[t]);
+            if (!d.m_storage.has_null(m_values))
+                return;
+        }
+
         for (size_t t = 0; t < ValueBase::m_values; t++) {
             if (m_storage.is_null(t))
                 d.m_storage.set_null(t);
@@ -1271,6 +1345,23 @@ public:
         return not_found; // no match
     }
 
+    // Given a TCond and two Value<T> holding consecutive rows (no link lists), return a bit mask of the matching
+    // rows among the first `size`, which must not exceed 64
+    template <class TCond>
+    REALM_FORCEINLINE static uint64_t compare_block(const Value<T>* left, const Value<T>* right, size_t size)
+    {
+        REALM_ASSERT_DEBUG(!left->m_from_link_list && !right->m_from_link_list);
+        REALM_ASSERT_DEBUG(size <= 64);
+        TCond c;
+        uint64_t matches = 0;
+        for (size_t m = 0; m < size; m++) {
+            bool match = c(left->m_storage[m], right->m_storage[m], left->m_storage.is_null(m),
+                           right->m_storage.is_null(m));
+            matches |= uint64_t(match) << m;
+        }
+        return matches;
+    }
+
     std::unique_ptr<Subexpr> clone(QueryNodeHandoverPatches*) const override
     {
         return make_subexpr<Value<T>>(*this);
@@ -1285,7 +1376,7 @@ public:
         : Value()
         , m_string(string.is_null() ? util::none : util::make_optional(std::string(string)))
     {
-        init(false, ValueBase::default_size, m_string);
+        init(false, ValueBase::chunk_size, m_string);
     }
 
     std::unique_ptr<Subexpr> clone(QueryNodeHandoverPatches*) const override
@@ -1681,6 +1772,7 @@ public:
         }
 
         m_target_table = table;
+        m_link_buffers.resize(m_link_columns.size());
     }
 
     std::vector<size_t> get_links(size_t index)
@@ -1690,6 +1782,25 @@ public:
         return res;
     }
 
+    /// Replace the contents of \a result with the target rows reached from
+    /// \a row, in the same order as map_links() would visit them. Rather than
+    /// recursing per link, every hop is resolved for all rows reached by the
+    /// previous hop before moving on to the next link column, and link lists
+    /// are read without creating LinkView accessors. Passing the same vector
+    /// for consecutive rows lets its capacity be reused.
+    void get_links(size_t row, std::vector<size_t>& result)
+    {
+        result.clear();
+        result.push_back(row);
+        for (size_t column = 0; column < m_link_columns.size() && !result.empty(); ++column) {
+            std::vector<size_t>& sources = m_link_buffers[column];
+            sources.swap(result);
+            result.clear();
+            for (size_t source : sources)
+                append_links(column, source, result);
+        }
+    }
+
     size_t count_links(size_t row)
     {
         CountLinks counter;
@@ -1707,6 +1818,11 @@ public:
         return m_only_unary_links;
     }
 
+    /// Run \a target_query, which must be a query on target_table(), and
+    /// return the sorted rows of the base table that reach at least one of
+    /// its matches, found by following the link columns backwards.
+    std::vector<size_t> get_origin_rows(Query& target_query) const;
+
     const Table* base_table() const
     {
         return m_base_table;
@@ -1740,9 +1856,12 @@ private:
         }
         else if (type == col_type_LinkList) {
             const LinkListColumn& cll = *static_cast<const LinkListColumn*>(m_link_columns[column]);
-            ConstLinkViewRef lvr = cll.get(row);
-            for (size_t t = 0; t < lvr->size(); t++) {
-                size_t r = lvr->get(t).get_index();
+            // Each link column has its own buffer, so the recursion below
+            // cannot clobber the targets we are iterating over.
+            std::vector<size_t>& targets = m_link_buffers[column];
+            targets.clear();
+            cll.get_target_rows(row, targets);
+            for (size_t r : targets) {
                 if (last) {
                     bool continue2 = lm.consume(r);
                     if (!continue2)
@@ -1769,10 +1888,25 @@ private:
     }
 
 
-    void get_links(size_t row, std::vector<size_t>& result)
+    void append_links(size_t column, size_t row, std::vector<size_t>& result) const
     {
-        MakeLinkVector mlv = MakeLinkVector(result);
-        map_links(row, mlv);
+        ColumnType type = m_link_types[column];
+        if (type == col_type_Link) {
+            const LinkColumn& cl = *static_cast<const LinkColumn*>(m_link_columns[column]);
+            size_t r = to_size_t(cl.get(row));
+            if (r != 0)
+                result.push_back(r - 1); // LinkColumn stores link to row N as N + 1
+        }
+        else if (type == col_type_LinkList) {
+            const LinkListColumn& cll = *static_cast<const LinkListColumn*>(m_link_columns[column]);
+            cll.get_target_rows(row, result);
+        }
+        else if (type == col_type_BackLink) {
+            const BacklinkColumn& bl = *static_cast<const BacklinkColumn*>(m_link_columns[column]);
+            size_t count = bl.get_backlink_count(row);
+            for (size_t i = 0; i < count; ++i)
+                result.push_back(bl.get_backlink(row, i));
+        }
     }
 
     std::vector<size_t> m_link_column_indexes;
@@ -1780,6 +1914,8 @@ private:
     const Table* m_base_table = nullptr;
     const Table* m_target_table = nullptr;
     bool m_only_unary_links = true;
+    // Scratch space for the rows reached through each link column
+    std::vector<std::vector<size_t>> m_link_buffers;
 
     template <class>
     friend Query compare(const Subexpr2<Link>&, const ConstRow&);
@@ -1847,7 +1983,8 @@ public:
         size_t col = column_ndx();
 
         if (links_exist()) {
-            std::vector<size_t> links = m_link_map.get_links(index);
+            std::vector<size_t>& links = m_links;
+            m_link_map.get_links(index, links);
             Value<T> v = make_value_for_link<T>(m_link_map.only_unary_links(), links.size());
 
             for (size_t t = 0; t < links.size(); t++) {
@@ -1857,9 +1994,11 @@ public:
             destination.import(v);
         }
         else {
-            // Not a link column
+            // Not a link column. Load as many rows as the caller asked for, given by the size of the destination.
             const Table* target_table = m_link_map.target_table();
-            for (size_t t = 0; t < destination.m_values && index + t < target_table->size(); t++) {
+            size_t rows = minimum(destination.m_values, target_table->size() - index);
+            d.init(false, rows);
+            for (size_t t = 0; t < rows; t++) {
                 d.m_storage.set(t, target_table->get<T>(col, index + t));
             }
         }
@@ -1870,6 +2009,14 @@ public:
         return m_link_map.m_link_columns.size() > 0;
     }
 
+    const LinkMap* get_link_map(size_t& target_column_ndx) const override
+    {
+        if (!links_exist())
+            return nullptr;
+        target_column_ndx = column_ndx();
+        return &m_link_map;
+    }
+
     std::unique_ptr<Subexpr> clone(QueryNodeHandoverPatches* patches = nullptr) const override
     {
         return make_subexpr<Columns<T>>(static_cast<const Columns<T>&>(*this), patches);
@@ -1897,6 +2044,8 @@ private:
     mutable size_t m_column_ndx;
     const ColumnBase* m_column;
     LinkMap m_link_map;
+    // Target rows of the most recently evaluated row; kept to reuse its capacity
+    std::vector<size_t> m_links;
 };
 
 
@@ -2087,7 +2236,6 @@ public:
     size_t find_first(size_t start, size_t end) const override
     {
         for (; start < end;) {
-            std::vector<size_t> l = m_link_map.get_links(start);
             // We have found a Link which is NULL, or LinkList with 0 entries. Return it as match.
 
             FindNullLinks fnl;
@@ -2271,7 +2419,8 @@ public:
 
     void evaluate(size_t index, ValueBase& destination) override
     {
-        std::vector<size_t> links = m_link_map.get_links(index);
+        std::vector<size_t>& links = m_links;
+        m_link_map.get_links(index, links);
         Value<RowIndex> v = make_value_for_link<RowIndex>(m_link_map.only_unary_links(), links.size());
 
         for (size_t t = 0; t < links.size(); t++) {
@@ -2294,6 +2443,8 @@ private:
     }
 
     LinkMap m_link_map;
+    // Target rows of the most recently evaluated row; kept to reuse its capacity
+    std::vector<size_t> m_links;
     friend class Table;
 };
 
@@ -2470,7 +2621,8 @@ public:
         if (links_exist()) {
             // LinkList with more than 0 values. Create Value with payload for all fields
 
-            std::vector<size_t> links = m_link_map.get_links(index);
+            std::vector<size_t>& links = m_links;
+            m_link_map.get_links(index, links);
             auto v = make_value_for_link<typename util::RemoveOptional<U>::type>(m_link_map.only_unary_links(),
                                                                                  links.size());
 
@@ -2486,46 +2638,35 @@ public:
             destination.import(v);
         }
         else {
-            // Not a Link column
-            // make sequential getter load the respective leaf to access data at column row 'index'
-            sgc->cache_next(index);
-            size_t colsize = sgc->m_column->size();
-
-            // Now load `ValueBase::default_size` rows from from the leaf into m_storage. If it's an integer
-            // leaf, then it contains the method get_chunk() which copies these values in a super fast way (first
-            // case of the `if` below. Otherwise, copy the values one by one in a for-loop (the `else` case).
-            if (std::is_same<U, int64_t>::value && index + ValueBase::default_size <= sgc->m_leaf_end) {
-                Value<int64_t> v;
-
-                // If you want to modify 'default_size' then update Array::get_chunk()
-                REALM_ASSERT_3(ValueBase::default_size, ==, 8);
-
-                auto sgc_2 = static_cast<SequentialGetter<ColType>*>(m_sg.get());
-                sgc_2->m_leaf_ptr->get_chunk(
-                    index - sgc->m_leaf_start,
-                    static_cast<Value<int64_t>*>(static_cast<ValueBase*>(&v))->m_storage.m_first);
-
-                destination.import(v);
+            // Not a Link column. Load as many rows as the caller asked for, given by the size of the destination,
+            // directly from the leaves that contain them.
+            size_t rows = destination.m_values;
+            if (rows == 0 || rows > ValueBase::chunk_size)
+                rows = ValueBase::chunk_size;
+            rows = minimum(rows, sgc->m_column->size() - index);
+
+            Value<typename util::RemoveOptional<U>::type>& v = m_chunk;
+            v.init(false, rows);
+            for (size_t t = 0; t < rows;) {
+                // make sequential getter load the respective leaf to access data at column row 'index + t'
+                sgc->cache_next(index + t);
+                size_t leaf_rows = minimum(rows - t, sgc->m_leaf_end - (index + t));
+                get_leaf_values(*sgc->m_leaf_ptr, index + t - sgc->m_leaf_start, leaf_rows, v.m_storage, t);
+                t += leaf_rows;
             }
-            else {
-                size_t rows = colsize - index;
-                if (rows > ValueBase::default_size)
-                    rows = ValueBase::default_size;
-                Value<typename util::RemoveOptional<U>::type> v(false, rows);
-
-                for (size_t t = 0; t < rows; t++)
-                    v.m_storage.set(t, sgc->get_next(index + t));
 
-                destination.import(v);
-            }
+            destination.import(v);
         }
     }
 
     // Load values from Column into destination
     void evaluate(size_t index, ValueBase& destination) override
     {
+        // Only integer columns have a separate nullable column type
+        using NullableColType = typename std::conditional<std::is_same<typename ColType::value_type, int64_t>::value,
+                                                          IntNullColumn, ColType>::type;
         if (m_nullable && std::is_same<typename ColType::value_type, int64_t>::value) {
-            evaluate_internal<IntNullColumn>(index, destination);
+            evaluate_internal<NullableColType>(index, destination);
         }
         else {
             evaluate_internal<ColType>(index, destination);
@@ -2547,8 +2688,39 @@ public:
         return m_sg ? get_column_base().get_column_index() : m_column;
     }
 
+    const LinkMap* get_link_map(size_t& target_column_ndx) const override
+    {
+        if (!links_exist())
+            return nullptr;
+        target_column_ndx = column_ndx();
+        return &m_link_map;
+    }
+
 private:
+    // Copy `size` values, starting at `ndx` in `leaf`, to `storage`, starting at `offset`
+    template <class LeafType, class Storage>
+    static void get_leaf_values(const LeafType& leaf, size_t ndx, size_t size, Storage& storage, size_t offset)
+    {
+        for (size_t t = 0; t < size; t++)
+            storage.set(offset + t, leaf.get(ndx + t));
+    }
+
+    template <class Storage>
+    static void get_leaf_values(const ArrayInteger& leaf, size_t ndx, size_t size, Storage& storage, size_t offset)
+    {
+        // get_chunk() copies 8 values in a super fast way
+        size_t t = 0;
+        for (; t + 8 <= size; t += 8)
+            leaf.get_chunk(ndx + t, storage.m_first + offset + t);
+        for (; t < size; t++)
+            storage.set(offset + t, leaf.get(ndx + t));
+    }
+
     LinkMap m_link_map;
+    // Target rows of the most recently evaluated row; kept to reuse its capacity
+    std::vector<size_t> m_links;
+    // Values of the most recently evaluated block of rows; kept to avoid initializing a new one for each block
+    Value<typename util::RemoveOptional<typename ColType::value_type>::type> m_chunk;
 
     // Fast (leaf caching) value getter for payload column (column in table on which query condition is executed)
     std::unique_ptr<SequentialGetterBase> m_sg;
@@ -2929,11 +3101,11 @@ public:
     // destination = operator(left)
     void evaluate(size_t index, ValueBase& destination) override
     {
-        Value<T> result;
-        Value<T> left;
-        m_left->evaluate(index, left);
-        result.template fun<oper>(&left);
-        destination.import(result);
+        // Ask the operand for as many rows as the caller asked for
+        m_left_value.init(false, destination.m_values);
+        m_left->evaluate(index, m_left_value);
+        m_result.template fun<oper>(&m_left_value);
+        destination.import(m_result);
     }
 
     std::unique_ptr<Subexpr> clone(QueryNodeHandoverPatches* patches) const override
@@ -2949,6 +3121,9 @@ public:
 private:
     typedef typename oper::type T;
     std::unique_ptr<TLeft> m_left;
+    // Kept to avoid initializing new values for each block of rows
+    Value<T> m_left_value;
+    Value<T> m_result;
 };
 
 
@@ -3004,13 +3179,13 @@ public:
     // destination = operator(left, right)
     void evaluate(size_t index, ValueBase& destination) override
     {
-        Value<T> result;
-        Value<T> left;
-        Value<T> right;
-        m_left->evaluate(index, left);
-        m_right->evaluate(index, right);
-        result.template fun<oper>(&left, &right);
-        destination.import(result);
+        // Ask the operands for as many rows as the caller asked for
+        m_left_value.init(false, destination.m_values);
+        m_right_value.init(false, destination.m_values);
+        m_left->evaluate(index, m_left_value);
+        m_right->evaluate(index, m_right_value);
+        m_result.template fun<oper>(&m_left_value, &m_right_value);
+        destination.import(m_result);
     }
 
     std::unique_ptr<Subexpr> clone(QueryNodeHandoverPatches* patches) const override
@@ -3028,9 +3203,69 @@ private:
     typedef typename oper::type T;
     std::unique_ptr<TLeft> m_left;
     std::unique_ptr<TRight> m_right;
+    // Kept to avoid initializing new values for each block of rows
+    Value<T> m_left_value;
+    Value<T> m_right_value;
+    Value<T> m_result;
 };
 
 
+// Add an equality condition on a column of a target table to \a query, as used by Compare::init(). Returns false
+// when the type of the column does not match the type of the value.
+template <class T>
+bool add_equal_condition(Query&, size_t, const T&, bool)
+{
+    return false;
+}
+
+inline bool add_equal_condition(Query& query, size_t column_ndx, int64_t value, bool)
+{
+    if (query.get_table()->get_column_type(column_ndx) != type_Int)
+        return false;
+    query.equal(column_ndx, value);
+    return true;
+}
+
+inline bool add_equal_condition(Query& query, size_t column_ndx, bool value, bool)
+{
+    if (query.get_table()->get_column_type(column_ndx) != type_Bool)
+        return false;
+    query.equal(column_ndx, value);
+    return true;
+}
+
+inline bool add_equal_condition(Query& query, size_t column_ndx, float value, bool)
+{
+    if (query.get_table()->get_column_type(column_ndx) != type_Float)
+        return false;
+    query.equal(column_ndx, value);
+    return true;
+}
+
+inline bool add_equal_condition(Query& query, size_t column_ndx, double value, bool)
+{
+    if (query.get_table()->get_column_type(column_ndx) != type_Double)
+        return false;
+    query.equal(column_ndx, value);
+    return true;
+}
+
+inline bool add_equal_condition(Query& query, size_t column_ndx, Timestamp value, bool)
+{
+    if (query.get_table()->get_column_type(column_ndx) != type_Timestamp)
+        return false;
+    query.equal(column_ndx, value);
+    return true;
+}
+
+inline bool add_equal_condition(Query& query, size_t column_ndx, StringData value, bool case_sensitive)
+{
+    if (query.get_table()->get_column_type(column_ndx) != type_String)
+        return false;
+    query.equal(column_ndx, value, case_sensitive);
+    return true;
+}
+
 template <class TCond, class T, class TLeft, class TRight>
 class Compare : public Expression {
 public:
@@ -3045,6 +3280,7 @@ public:
     {
         m_left->set_base_table(table);
         m_right->set_base_table(table);
+        m_block_start = m_block_end = 0;
     }
 
     // Recursively fetch tables of columns in expression tree. Used when user first builds a stand-alone expression
@@ -3062,23 +3298,42 @@ public:
         return l ? l : r;
     }
 
-    size_t find_first(size_t start, size_t end) const override
+    // A row matches an equality condition on a column reached through links if any of the rows it links to
+    // matches. When the other side is a constant, the matching target rows are found with a query on the target
+    // table, which can use its search index, and are then mapped back to base table rows through the backlinks.
+    void init() override
     {
-        size_t match;
-        Value<T> right;
-        Value<T> left;
+        m_block_start = m_block_end = 0;
+        m_has_semi_join = false;
+        m_semi_join_rows.clear();
+        if (std::is_same<TCond, Equal>::value || std::is_same<TCond, EqualIns>::value) {
+            if (!init_semi_join(*m_left, *m_right))
+                init_semi_join(*m_right, *m_left);
+        }
+    }
 
-        for (; start < end;) {
-            m_left->evaluate(start, left);
-            m_right->evaluate(start, right);
-            match = Value<T>::template compare<TCond>(&left, &right);
+    size_t find_first(size_t start, size_t end) const override
+    {
+        if (m_has_semi_join) {
+            auto it = std::lower_bound(m_semi_join_rows.begin(), m_semi_join_rows.end(), start);
+            if (it != m_semi_join_rows.end() && *it < end)
+                return *it;
+            return not_found;
+        }
 
-            if (match != not_found && match + start < end)
-                return start + match;
+        while (start < end) {
+            if (start < m_block_start || start >= m_block_end)
+                evaluate_block(start);
 
-            size_t rows =
-                (left.m_from_link_list || right.m_from_link_list) ? 1 : minimum(right.m_values, left.m_values);
-            start += rows;
+            uint64_t matches = m_block_matches >> (start - m_block_start);
+            if (matches != 0) {
+                while ((matches & 1) == 0) {
+                    matches >>= 1;
+                    ++start;
+                }
+                return start < end ? start : not_found;
+            }
+            start = m_block_end;
         }
 
         return not_found; // no match
@@ -3102,8 +3357,70 @@ private:
     {
     }
 
+    // Evaluate the block of rows that starts at `start` and record which of them match. Consecutive blocks are
+    // evaluated chunk_size rows at a time, while scattered rows, as when this is not the first condition of a
+    // query, are evaluated default_size rows at a time so that few rows are evaluated in vain.
+    void evaluate_block(size_t start) const
+    {
+        size_t rows = start == m_block_end ? ValueBase::chunk_size : ValueBase::default_size;
+        m_left_value.init(false, rows);
+        m_right_value.init(false, rows);
+        m_left->evaluate(start, m_left_value);
+        m_right->evaluate(start, m_right_value);
+
+        m_block_start = start;
+        if (m_left_value.m_from_link_list || m_right_value.m_from_link_list) {
+            // Values from link lists all belong to the single row `start`
+            bool match = Value<T>::template compare<TCond>(&m_left_value, &m_right_value) != not_found;
+            m_block_end = start + 1;
+            m_block_matches = match ? 1 : 0;
+        }
+        else {
+            rows = minimum(minimum(m_left_value.m_values, m_right_value.m_values), ValueBase::chunk_size);
+            REALM_ASSERT_DEBUG(rows > 0);
+            m_block_end = start + rows;
+            m_block_matches = Value<T>::template compare_block<TCond>(&m_left_value, &m_right_value, rows);
+        }
+    }
+
+    bool init_semi_join(Subexpr& constant, const Subexpr& column)
+    {
+        size_t target_column_ndx;
+        const LinkMap* link_map = column.get_link_map(target_column_ndx);
+        if (!link_map || constant.get_base_table())
+            return false;
+
+        // Null links and empty link lists never match a non-null constant, so
+        // only the rows that reach a matching target row can match.
+        Value<T> value;
+        constant.evaluate(0, value);
+        if (value.m_values == 0 || value.m_storage.is_null(0))
+            return false;
+
+        Query target_query(*link_map->target_table());
+        bool case_sensitive = std::is_same<TCond, Equal>::value;
+        if (!add_equal_condition(target_query, target_column_ndx, value.m_storage[0], case_sensitive))
+            return false;
+
+        m_semi_join_rows = link_map->get_origin_rows(target_query);
+        m_has_semi_join = true;
+        return true;
+    }
+
     std::unique_ptr<TLeft> m_left;
     std::unique_ptr<TRight> m_right;
+
+    // Sorted rows of the base table that match, when the condition was evaluated on the target table in init()
+    bool m_has_semi_join = false;
+    std::vector<size_t> m_semi_join_rows;
+
+    // Matches of the most recently evaluated block of rows [m_block_start, m_block_end), one bit per row. Kept
+    // between calls of find_first() so that a block is evaluated only once when searching for all matches.
+    mutable size_t m_block_start = 0;
+    mutable size_t m_block_end = 0;
+    mutable uint64_t m_block_matches = 0;
+    mutable Value<T> m_left_value;
+    mutable Value<T> m_right_value;
 };
 }
 #endif // REALM_QUERY_EXPRESSION_HPP
@@ -289,75 +289,12 @@ inline bool StringData::contains(StringData d) const noexcept
     if (is_null() && !d.is_null())
         return false;
 
-    return d.m_size == 0 || std::search(m_data, m_data + m_size, d.m_data, d.m_data + d.m_size) != m_data + m_size;
+    return d.m_size == 0 || search_substring(m_data, m_data + m_size, d.m_data, d.m_size) != m_data + m_size;
 }
 
 inline bool StringData::matchlike(const StringData& text, const StringData& pattern) noexcept
 {
-    std::vector<size_t> textpos;
-    std::vector<size_t> patternpos;
-    size_t p1 = 0; // position in text (haystack)
-    size_t p2 = 0; // position in pattern (needle)
-    
-    while (true) {
-        if (p1 == text.size()) {
-            if (p2 == pattern.size())
-                return true;
-            if (p2 == pattern.size()-1 && pattern[p2] == '*')
-                return true;
-            goto no_match;
-        }
-        if (p2 == pattern.size())
-            goto no_match;
-        
-        if (pattern[p2] == '*') {
-            textpos.push_back(p1);
-            patternpos.push_back(++p2);
-            continue;
-        }
-        if (pattern[p2] == '?') {
-            // utf-8 encoded characters may take up multiple bytes
-            if ((text[p1] & 0x80) == 0) {
-                ++p1;
-                ++p2;
-                continue;
-            }
-            else {
-                size_t p = 1;
-                while (p1+p != text.size() && (text[p1+p] & 0xc0) == 0x80)
-                    ++p;
-                p1 += p;
-                ++p2;
-                continue;
-            }
-        }
-        
-        if (pattern[p2] == text[p1]) {
-            ++p1;
-            ++p2;
-            continue;
-        }
-        
-    no_match:
-        if (textpos.empty())
-            return false;
-        else {
-            if (p1 == text.size()) {
-                textpos.pop_back();
-                patternpos.pop_back();
-                
-                if (textpos.empty())
-                    return false;
-                
-                p1 = textpos.back();
-            }
-            else {
-                p1 = textpos.back();
-                textpos.back() = ++p1;
-            }
-            p2 = patternpos.back();
-        }
-    }
+    return match_like(text.data(), text.size(), pattern.data(), pattern.data(), pattern.size());
 }
 
 inline bool StringData::like(StringData d) const noexcept
@@ -43,6 +43,7 @@
 #include <realm/column_backlink.hpp>
 #include <realm/index_string.hpp>
 #include <realm/group.hpp>
+#include <realm/group_by.hpp>
 #include <realm/link_view.hpp>
 #include <realm/replication.hpp>
 #include <realm/table_view.hpp>
@@ -1368,6 +1369,33 @@ void Table::move_registered_view(const TableViewBase* old_addr, const TableViewB
 }
 
 
+void Table::record_changed_row(size_t row_ndx) noexcept
+{
+    LockGuard lock(m_accessor_mutex);
+    for (auto& view : m_views) {
+        view->record_changed_row(row_ndx);
+    }
+}
+
+
+void Table::record_version_bump(uint_fast64_t old_version) noexcept
+{
+    LockGuard lock(m_accessor_mutex);
+    for (auto& view : m_views) {
+        view->record_version_bump(old_version, m_version);
+    }
+}
+
+
+void Table::discard_changed_rows() noexcept
+{
+    LockGuard lock(m_accessor_mutex);
+    for (auto& view : m_views) {
+        view->discard_changed_rows();
+    }
+}
+
+
 void Table::discard_views() noexcept
 {
     LockGuard lock(m_accessor_mutex);
@@ -1627,7 +1655,7 @@ void Table::upgrade_file_format(size_t target_file_format_version)
                 // Indices are not support on these column types
                 break;
             case col_type_Timestamp: {
-                if (target_file_format_version == 6) {
+                if (target_file_format_version >= 6) {
                     TimestampColumn& col = get_column_timestamp(col_ndx);
                     col.get_search_index()->clear();
                     col.populate_search_index();
@@ -4161,7 +4189,7 @@ size_t get_group_ndx_blocked(size_t i, AggrState& state, Table& result)
 
 // Simple pivot aggregate method. Experimental! Please do not document method publicly.
 void Table::aggregate(size_t group_by_column, size_t aggr_column, AggrType op, Table& result,
-                      const IntegerColumn* viewrefs) const
+                      const IntegerColumn* viewrefs, size_t thread_count) const
 {
     REALM_ASSERT(result.is_empty() && result.get_column_count() == 0);
     REALM_ASSERT_3(group_by_column, <, m_columns.size());
@@ -4170,6 +4198,11 @@ void Table::aggregate(size_t group_by_column, size_t aggr_column, AggrType op, T
     REALM_ASSERT_3(get_column_type(group_by_column), ==, type_String);
     REALM_ASSERT(op == aggr_count || get_column_type(aggr_column) == type_Int);
 
+    if (thread_count > 1) {
+        aggregate_in_parallel(group_by_column, aggr_column, op, result, viewrefs, thread_count); // Throws
+        return;
+    }
+
     // Add columns to result table
     result.add_column(type_String, get_column_name(group_by_column));
 
@@ -4398,6 +4431,34 @@ void Table::aggregate(size_t group_by_column, size_t aggr_column, AggrType op, T
     }
 }
 
+// Produces the same result table as the single threaded aggregate() above
+void Table::aggregate_in_parallel(size_t group_by_column, size_t aggr_column, AggrType op, Table& result,
+                                  const IntegerColumn* viewrefs, size_t thread_count) const
+{
+    GroupByResult groups = group_by({group_by_column}, {{op, aggr_column}}, viewrefs, thread_count); // Throws
+
+    result.add_column(type_String, get_column_name(group_by_column));
+    if (op == aggr_count)
+        result.add_column(type_Int, "COUNT()");
+    else if (op == aggr_avg)
+        result.add_column(type_Double, "average");
+    else
+        result.add_column(type_Int, get_column_name(aggr_column));
+    if (get_real_column_type(group_by_column) != col_type_StringEnum)
+        result.add_search_index(0);
+
+    size_t count = groups.size();
+    result.add_empty_row(count);
+    for (size_t i = 0; i < count; ++i) {
+        StringData key = groups.is_key_null(0, i) ? StringData() : groups.get_key(0, i).get_string();
+        result.set_string(0, i, key);
+        if (op == aggr_avg)
+            result.set_double(1, i, groups.get_double(0, i));
+        else
+            result.set_int(1, i, groups.get_int(0, i));
+    }
+}
+
 
 TableView Table::get_range_view(size_t begin, size_t end)
 {
@@ -4509,11 +4570,13 @@ size_t Table::upper_bound_string(size_t col_ndx, StringData value) const noexcep
 
 void Table::optimize(bool enforce)
 {
-    // At the present time there is only one kind of optimization that
-    // we can do, and that is to replace a string column with a string
+    // At the present time there are two kinds of optimization that we
+    // can do. The first is to replace a string column with a string
     // enumeration column. Since this involves changing the spec of
     // the table, it is not something we can do for a subtable with
-    // shared spec.
+    // shared spec. The second, which is attempted on string columns
+    // that are not enumerated, is to convert leaves of long strings
+    // with many duplicates to compressed form.
     if (has_shared_type())
         return;
 
@@ -4527,8 +4590,10 @@ void Table::optimize(bool enforce)
 
             ref_type ref, keys_ref;
             bool res = column_i->auto_enumerate(keys_ref, ref, enforce);
-            if (!res)
+            if (!res) {
+                column_i->compress_leaves(); // Throws
                 continue;
+            }
 
             Spec::ColumnInfo info = m_spec.get_column_info(i);
             ArrayParent* keys_parent;
@@ -5616,6 +5681,11 @@ void Table::adj_row_acc_swap_rows(size_t row_ndx_1, size_t row_ndx_2) noexcept
         }
         row = row->m_next;
     }
+
+    // Table views are not adjusted, they must rerun their queries
+    for (auto& view : m_views) {
+        view->discard_changed_rows();
+    }
 }
 
 
@@ -5632,6 +5702,11 @@ void Table::adj_row_acc_merge_rows(size_t old_row_ndx, size_t new_row_ndx) noexc
             row->m_row_ndx = new_row_ndx;
         row = row->m_next;
     }
+
+    // Table views are not adjusted, they must rerun their queries
+    for (auto& view : m_views) {
+        view->discard_changed_rows();
+    }
 }
 
 
@@ -5674,6 +5749,7 @@ void Table::adj_insert_column(size_t col_ndx)
         REALM_ASSERT_3(col_ndx, <=, m_cols.size());
         m_cols.insert(m_cols.begin() + col_ndx, nullptr); // Throws
     }
+    discard_changed_rows();
 }
 
 
@@ -5691,6 +5767,7 @@ void Table::adj_erase_column(size_t col_ndx) noexcept
             delete col;
         m_cols.erase(m_cols.begin() + col_ndx);
     }
+    discard_changed_rows();
 }
 
 void Table::adj_move_column(size_t from, size_t to) noexcept
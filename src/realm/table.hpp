@@ -34,6 +34,7 @@
 #include <realm/spec.hpp>
 #include <realm/mixed.hpp>
 #include <realm/query.hpp>
+#include <realm/query_cache.hpp>
 #include <realm/column.hpp>
 
 namespace realm {
@@ -42,6 +43,8 @@ class BacklinkColumn;
 class BinaryColumy;
 class ConstTableView;
 class Group;
+class GroupByResult;
+struct GroupByAggregate;
 class LinkColumn;
 class LinkColumnBase;
 class LinkListColumn;
@@ -658,8 +661,24 @@ public:
     };
 
     // Simple pivot aggregate method. Experimental! Please do not document method publicly.
+    // With a `thread_count` above 1, the rows are aggregated by group_by() in parallel.
     void aggregate(size_t group_by_column, size_t aggr_column, AggrType op, Table& result,
-                   const IntegerColumn* viewrefs = nullptr) const;
+                   const IntegerColumn* viewrefs = nullptr, size_t thread_count = 1) const;
+
+    /// Group the rows of this table, or the rows given by `viewrefs`, by the
+    /// values of the `keys` columns, and compute all of `aggregates` for each
+    /// group in a single pass over the rows. Key columns can be of any type but
+    /// link, link list, table and mixed. Aggregates work on integer, float and
+    /// double columns, and minimum and maximum also on timestamps. Include
+    /// `<realm/group_by.hpp>` to use the result.
+    ///
+    /// With a `thread_count` above 1, the rows are split into up to that many
+    /// ranges of whole B+-tree leaves, which are grouped on separate threads
+    /// and merged at the end. The result is the same as with one thread, except
+    /// for rounding in floating point sums. The table must not be modified
+    /// while this runs.
+    GroupByResult group_by(const std::vector<size_t>& keys, const std::vector<GroupByAggregate>& aggregates,
+                           const IntegerColumn* viewrefs = nullptr, size_t thread_count = 1) const;
 
     /// Report the current versioning counter for the table. The versioning counter is guaranteed to
     /// change when the contents of the table changes after advance_read() or promote_to_write(), or
@@ -672,12 +691,30 @@ public:
     /// without any apparent reason.
     uint_fast64_t get_version_counter() const noexcept;
 
+    /// Keep the results of up to `max_entries` calls of Query::count(),
+    /// Query::find_all() and the Query aggregate methods on this table, and
+    /// return them again for queries with the same conditions and arguments
+    /// for as long as the version counter of the table stays the same. This
+    /// saves executing queries that are repeated many times at the same
+    /// version. Queries restricted by a view, and queries with expression or
+    /// links_to() conditions, are always executed. When the cache is full, the
+    /// least recently used result is evicted. The cache belongs to this
+    /// accessor, and is disabled by default.
+    void enable_query_cache(size_t max_entries = 256);
+    void disable_query_cache() noexcept;
+
+    /// The cache of enable_query_cache(), or null if it is disabled.
+    const QueryCache* get_query_cache() const noexcept;
+
 private:
     template <class T>
     size_t find_first(size_t column_ndx, T value) const; // called by above methods
     template <class T>
     TableView find_all(size_t column_ndx, T value);
 
+    void aggregate_in_parallel(size_t group_by_column, size_t aggr_column, AggrType op, Table& result,
+                               const IntegerColumn* viewrefs, size_t thread_count) const;
+
 public:
     //@{
     /// Find the lower/upper bound according to a column that is
@@ -744,7 +781,9 @@ public:
     Table& backlink(const Table& origin, size_t origin_col_ndx);
 
     // Optimizing. enforce == true will enforce enumeration of all string columns;
-    // enforce == false will auto-evaluate if they should be enumerated or not
+    // enforce == false will auto-evaluate if they should be enumerated or not.
+    // Long strings in columns that are not enumerated are compressed where
+    // they have many duplicates.
     void optimize(bool enforce = false);
 
     /// Write this table (or a slice of this table) to the specified
@@ -947,6 +986,9 @@ private:
 
     mutable uint_fast64_t m_version;
 
+    // Results of queries on this table, see enable_query_cache()
+    std::unique_ptr<QueryCache> m_query_cache;
+
     void erase_row(size_t row_ndx, bool is_move_last_over);
     void batch_erase_rows(const IntegerColumn& row_indexes, bool is_move_last_over);
     void do_remove(size_t row_ndx, bool broken_reciprocal_backlinks);
@@ -1370,6 +1412,19 @@ private:
     void adj_erase_column(size_t col_ndx) noexcept;
     void adj_move_column(size_t col_ndx_1, size_t col_ndx_2) noexcept;
 
+    /// Used by Group::TransactAdvancer to tell the table views of this table
+    /// which rows were modified by the transaction logs, so that they can be
+    /// patched instead of rerunning their queries. record_version_bump() is
+    /// called after the version of the table was bumped from `old_version` as
+    /// part of the same advance.
+    void record_changed_row(size_t row_ndx) noexcept;
+    void record_version_bump(uint_fast64_t old_version) noexcept;
+
+    /// Make the table views of this table forget the rows recorded by
+    /// record_changed_row(), for changes that cannot be described as a set
+    /// of changed rows.
+    void discard_changed_rows() noexcept;
+
     bool is_marked() const noexcept;
     void mark() noexcept;
     void unmark() noexcept;
@@ -1449,6 +1504,7 @@ private:
     friend class LinkMap;
     friend class LinkView;
     friend class Group;
+    friend class GroupByResult;
 };
 
 
@@ -1494,6 +1550,21 @@ inline uint_fast64_t Table::get_version_counter() const noexcept
     return m_version;
 }
 
+inline void Table::enable_query_cache(size_t max_entries)
+{
+    m_query_cache.reset(new QueryCache(max_entries)); // Throws
+}
+
+inline void Table::disable_query_cache() noexcept
+{
+    m_query_cache.reset();
+}
+
+inline const QueryCache* Table::get_query_cache() const noexcept
+{
+    return m_query_cache.get();
+}
+
 inline void Table::bump_version(bool bump_global) const noexcept
 {
     if (bump_global) {
@@ -2335,6 +2406,16 @@ public:
         table.adj_erase_column(col_ndx);
     }
 
+    static void record_changed_row(Table& table, size_t row_ndx) noexcept
+    {
+        table.record_changed_row(row_ndx);
+    }
+
+    static void record_version_bump(Table& table, uint_fast64_t old_version) noexcept
+    {
+        table.record_version_bump(old_version);
+    }
+
     static void adj_move_column(Table& table, size_t col_ndx_1, size_t col_ndx_2) noexcept
     {
         table.adj_move_column(col_ndx_1, col_ndx_2);
@@ -24,6 +24,7 @@
 #include <realm/impl/sequential_getter.hpp>
 #include <realm/index_string.hpp>
 #include <realm/query_conditions.hpp>
+#include <realm/query_engine.hpp>
 #include <realm/util/utf8.hpp>
 
 using namespace realm;
@@ -47,10 +48,12 @@ TableViewBase::TableViewBase(TableViewBase& src, HandoverPatch& patch, MutableSo
     }
 
     src.m_last_seen_version = util::none; // bring source out-of-sync, now that it has lost its data
+    src.discard_changed_rows();
     m_last_seen_version = 0;
     m_start = src.m_start;
     m_end = src.m_end;
     m_limit = src.m_limit;
+    m_sort_limit = src.m_sort_limit;
 }
 
 TableViewBase::TableViewBase(const TableViewBase& src, HandoverPatch& patch, ConstSourcePayload mode)
@@ -75,6 +78,7 @@ TableViewBase::TableViewBase(const TableViewBase& src, HandoverPatch& patch, Con
     m_start = src.m_start;
     m_end = src.m_end;
     m_limit = src.m_limit;
+    m_sort_limit = src.m_sort_limit;
 }
 
 void TableViewBase::apply_patch(HandoverPatch& patch, Group& group)
@@ -414,9 +418,10 @@ size_t TableViewBase::count_timestamp(size_t column_ndx, Timestamp target) const
 }
 
 // Simple pivot aggregate method. Experimental! Please do not document method publicly.
-void TableViewBase::aggregate(size_t group_by_column, size_t aggr_column, Table::AggrType op, Table& result) const
+void TableViewBase::aggregate(size_t group_by_column, size_t aggr_column, Table::AggrType op, Table& result,
+                              size_t thread_count) const
 {
-    m_table->aggregate(group_by_column, aggr_column, op, result, &m_row_indexes);
+    m_table->aggregate(group_by_column, aggr_column, op, result, &m_row_indexes, thread_count);
 }
 
 void TableViewBase::to_json(std::ostream& out) const
@@ -565,6 +570,14 @@ uint_fast64_t TableViewBase::sync_if_needed() const
 void TableViewBase::adj_row_acc_insert_rows(size_t row_ndx, size_t num_rows) noexcept
 {
     m_row_indexes.adjust_ge(int_fast64_t(row_ndx), num_rows);
+
+    // The new rows may match the query
+    for (auto& changed_row : m_changed_rows) {
+        if (changed_row >= row_ndx)
+            changed_row += num_rows;
+    }
+    for (size_t i = 0; i < num_rows; ++i)
+        record_changed_row(row_ndx + i);
 }
 
 
@@ -579,6 +592,13 @@ void TableViewBase::adj_row_acc_erase_row(size_t row_ndx) noexcept
         m_row_indexes.set(it, -1);
     }
     m_row_indexes.adjust_ge(int_fast64_t(row_ndx) + 1, -1);
+
+    auto end = std::remove(m_changed_rows.begin(), m_changed_rows.end(), row_ndx);
+    m_changed_rows.erase(end, m_changed_rows.end());
+    for (auto& changed_row : m_changed_rows) {
+        if (changed_row > row_ndx)
+            --changed_row;
+    }
 }
 
 
@@ -601,6 +621,15 @@ void TableViewBase::adj_row_acc_move_over(size_t from_row_ndx, size_t to_row_ndx
             break;
         m_row_indexes.set(it, to_row_ndx);
     }
+
+    // The moved row is recorded as changed, as it has to be moved to its new
+    // position in table order
+    auto end = std::remove(m_changed_rows.begin(), m_changed_rows.end(), to_row_ndx);
+    m_changed_rows.erase(end, m_changed_rows.end());
+    if (from_row_ndx != to_row_ndx) {
+        std::replace(m_changed_rows.begin(), m_changed_rows.end(), from_row_ndx, to_row_ndx);
+        record_changed_row(to_row_ndx);
+    }
 }
 
 
@@ -609,6 +638,38 @@ void TableViewBase::adj_row_acc_clear() noexcept
     m_num_detached_refs = m_row_indexes.size();
     for (size_t i = 0, num_rows = m_row_indexes.size(); i < num_rows; ++i)
         m_row_indexes.set(i, -1);
+    discard_changed_rows();
+}
+
+
+void TableViewBase::record_changed_row(size_t row_ndx) noexcept
+{
+    if (!m_changed_rows_version)
+        return;
+    try {
+        m_changed_rows.push_back(row_ndx); // Throws
+    }
+    catch (...) {
+        discard_changed_rows();
+    }
+}
+
+
+void TableViewBase::record_version_bump(uint_fast64_t old_version, uint_fast64_t new_version) noexcept
+{
+    // Any other change of the version means that the table was changed in a
+    // way that was not recorded
+    if (m_changed_rows_version && *m_changed_rows_version == old_version)
+        m_changed_rows_version = new_version;
+    else
+        discard_changed_rows();
+}
+
+
+void TableViewBase::discard_changed_rows() noexcept
+{
+    m_changed_rows_version = util::none;
+    m_changed_rows.clear();
 }
 
 
@@ -704,8 +765,95 @@ void TableViewBase::sort(size_t column, bool ascending)
 // Sort according to multiple columns, user specified order on each column
 void TableViewBase::sort(SortDescriptor order)
 {
+    sort(std::move(order), npos);
+}
+
+// Sort according to multiple columns, and keep only the first `limit` rows
+void TableViewBase::sort(SortDescriptor order, size_t limit)
+{
+    // Ties are no longer in table order when an already sorted view is sorted
+    // again, so the view cannot be patched until it has been synced
+    if (m_sorting_predicate || limit != npos)
+        discard_changed_rows();
+    bool truncated = m_sort_limit != npos;
     m_sorting_predicate = std::move(order);
-    do_sort(m_sorting_predicate, m_distinct_predicate);
+    m_sort_limit = limit;
+
+    // The rows removed by an earlier limit may belong to the view under the
+    // new order or limit, so rederive the rows from the source of the view,
+    // which sorts them again
+    bool has_source = m_linkview_source || m_distinct_column_source != npos || m_linked_column || m_query.m_table;
+    if (truncated && m_table && has_source) {
+        do_sync();
+        return;
+    }
+    do_sort(m_sorting_predicate, m_distinct_predicate, m_sort_limit);
+}
+
+bool TableViewBase::can_track_changed_rows() const noexcept
+{
+    // Only views of a query over the whole of a group-level table can be
+    // patched, and only if no column can make the result depend on other
+    // tables
+    if (!m_table || !m_query.m_table || m_query.m_view || m_linkview_source || m_linked_column ||
+        m_distinct_column_source != npos)
+        return false;
+    if (m_start != 0 || m_end != size_t(-1) || m_limit != size_t(-1) || m_sort_limit != npos || m_distinct_predicate)
+        return false;
+    if (!m_table->is_group_level() || m_table->m_cols.size() != m_table->get_column_count())
+        return false;
+    for (size_t col_ndx = 0; col_ndx < m_table->get_column_count(); ++col_ndx) {
+        DataType type = m_table->get_column_type(col_ndx);
+        if (type == type_Link || type == type_LinkList || type == type_Table || type == type_Mixed)
+            return false;
+    }
+    return true;
+}
+
+// Patch the view with the rows recorded by record_changed_row(), giving the
+// same result as rerunning the query and sorting the result
+void TableViewBase::sync_changed_rows()
+{
+    std::sort(m_changed_rows.begin(), m_changed_rows.end());
+    m_changed_rows.erase(std::unique(m_changed_rows.begin(), m_changed_rows.end()), m_changed_rows.end());
+
+    // The changed rows that match the query, in table order, or in sorted
+    // order with ties in table order
+    auto is_before = [&](size_t row_1, size_t row_2) {
+        return m_sorting_predicate ? m_sorting_predicate.is_before(row_1, row_2) : row_1 < row_2;
+    };
+    m_query.init();
+    ParentNode* root = m_query.has_conditions() ? m_query.root_node() : nullptr;
+    std::vector<size_t> matches;
+    for (auto row : m_changed_rows) {
+        if (row < m_table->size() && (!root || root->find_first(row, row + 1) == row))
+            matches.push_back(row);
+    }
+    if (m_sorting_predicate)
+        std::sort(matches.begin(), matches.end(), is_before);
+
+    // In one pass, keep the rows that did not change and are not detached,
+    // which are still in the order of the view, and merge the matches into
+    // them. Rows moved by adj_row_acc_move_over() are out of order, but they
+    // are always among the changed rows.
+    std::vector<size_t> rows;
+    rows.reserve(m_row_indexes.size() + matches.size());
+    auto match = matches.begin();
+    for (auto it = m_row_indexes.cbegin(), end = m_row_indexes.cend(); it != end; ++it) {
+        int64_t row = *it;
+        if (row == detached_ref || std::binary_search(m_changed_rows.begin(), m_changed_rows.end(), size_t(row)))
+            continue;
+        for (; match != matches.end() && is_before(*match, size_t(row)); ++match)
+            rows.push_back(*match);
+        rows.push_back(size_t(row));
+    }
+    rows.insert(rows.end(), match, matches.end());
+
+    m_row_indexes.clear();
+    for (size_t row : rows)
+        m_row_indexes.add(row);
+    m_num_detached_refs = 0;
+    m_changed_rows.clear();
 }
 
 void TableViewBase::do_sync()
@@ -713,6 +861,15 @@ void TableViewBase::do_sync()
     // A TableView can be "born" from 4 different sources: LinkView, Table::get_distinct_view(),
     // Table::find_all() or Query. Here we sync with the respective source.
 
+    // If the only changes since the last sync came from transaction logs
+    // which recorded the changed rows, patch the view with those rows
+    if (m_changed_rows_version && can_track_changed_rows() && *m_changed_rows_version == outside_version() &&
+        m_changed_rows.size() <= m_table->size() / 4) {
+        sync_changed_rows();
+        m_last_seen_version = m_changed_rows_version;
+        return;
+    }
+
     if (m_linkview_source) {
         m_row_indexes.clear();
         for (size_t t = 0; t < m_linkview_source->size(); t++)
@@ -757,9 +914,14 @@ void TableViewBase::do_sync()
     }
     m_num_detached_refs = 0;
 
-    do_sort(m_sorting_predicate, m_distinct_predicate);
+    do_sort(m_sorting_predicate, m_distinct_predicate, m_sort_limit);
 
     m_last_seen_version = outside_version();
+    m_changed_rows.clear();
+    if (can_track_changed_rows())
+        m_changed_rows_version = m_last_seen_version;
+    else
+        m_changed_rows_version = util::none;
 }
 
 bool TableViewBase::is_in_table_order() const
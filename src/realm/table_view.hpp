@@ -247,7 +247,12 @@ public:
 
     // Simple pivot aggregate method. Experimental! Please do not
     // document method publicly.
-    void aggregate(size_t group_by_column, size_t aggr_column, Table::AggrType op, Table& result) const;
+    void aggregate(size_t group_by_column, size_t aggr_column, Table::AggrType op, Table& result,
+                   size_t thread_count = 1) const;
+
+    // Group the rows of this view, see Table::group_by()
+    GroupByResult group_by(const std::vector<size_t>& keys, const std::vector<GroupByAggregate>& aggregates,
+                           size_t thread_count = 1) const;
 
     // Get row index in the source table this view is "looking" at.
     size_t get_source_ndx(size_t row_ndx) const noexcept;
@@ -296,6 +301,14 @@ public:
     // Sort m_row_indexes according to multiple columns
     void sort(SortDescriptor order);
 
+    // Sort m_row_indexes according to multiple columns, and keep only the
+    // first `limit` rows. The rows beyond the limit are removed from the view,
+    // and the limit is reapplied whenever the view is synced. Sorting a view
+    // that was limited before, with or without a limit, first brings back the
+    // removed rows from the source of the view. Views of Table::find_all() for
+    // a value have no such source, so their removed rows stay removed.
+    void sort(SortDescriptor order, size_t limit);
+
     // Remove rows that are duplicated with respect to the column set passed as argument.
     // distinct() will preserve the original order of the row pointers, also if the order is a result of sort()
     // If two rows are indentical (for the given set of distinct-columns), then the last row is removed.
@@ -346,6 +359,7 @@ protected:
     SortDescriptor m_distinct_predicate;
 
     SortDescriptor m_sorting_predicate; // Stores sorting criterias (columns + ascending)
+    size_t m_sort_limit = npos;         // Number of rows to keep after sorting
 
 
     // A valid query holds a reference to its table which must match our m_table.
@@ -360,6 +374,14 @@ protected:
     mutable util::Optional<uint_fast64_t> m_last_seen_version;
 
     size_t m_num_detached_refs = 0;
+
+    // Rows of m_table changed by transaction logs since the last sync, and the
+    // version of m_table up to which they are complete. do_sync() patches the
+    // view with these rows instead of rerunning the query when
+    // m_changed_rows_version matches the current version.
+    std::vector<size_t> m_changed_rows;
+    util::Optional<uint_fast64_t> m_changed_rows_version;
+
     /// Construct null view (no memory allocated).
     TableViewBase();
 
@@ -428,6 +450,15 @@ private:
     void adj_row_acc_move_over(size_t from_row_ndx, size_t to_row_ndx) noexcept;
     void adj_row_acc_clear() noexcept;
 
+    // Called by table to record rows changed by the transaction logs (see
+    // Table::record_changed_row()):
+    void record_changed_row(size_t row_ndx) noexcept;
+    void record_version_bump(uint_fast64_t old_version, uint_fast64_t new_version) noexcept;
+    void discard_changed_rows() noexcept;
+
+    bool can_track_changed_rows() const noexcept;
+    void sync_changed_rows();
+
     template <typename Tab>
     friend class BasicTableView;
 };
@@ -741,6 +772,8 @@ inline TableViewBase::TableViewBase(Table* parent, Query& query, size_t start, s
     ref_guard.reset(IntegerColumn::create(alloc)); // Throws
     parent->register_view(this);                   // Throws
     m_row_indexes.init_from_ref(alloc, ref_guard.release());
+    if (can_track_changed_rows())
+        m_changed_rows_version = m_last_seen_version;
 }
 
 inline TableViewBase::TableViewBase(Table* parent, size_t column, BasicRowExpr<const Table> row)
@@ -769,12 +802,15 @@ inline TableViewBase::TableViewBase(const TableViewBase& tv)
     , m_distinct_column_source(tv.m_distinct_column_source)
     , m_distinct_predicate(std::move(tv.m_distinct_predicate))
     , m_sorting_predicate(std::move(tv.m_sorting_predicate))
+    , m_sort_limit(tv.m_sort_limit)
     , m_query(tv.m_query)
     , m_start(tv.m_start)
     , m_end(tv.m_end)
     , m_limit(tv.m_limit)
     , m_last_seen_version(tv.m_last_seen_version)
     , m_num_detached_refs(tv.m_num_detached_refs)
+    , m_changed_rows(tv.m_changed_rows)
+    , m_changed_rows_version(tv.m_changed_rows_version)
 {
     // FIXME: This code is unreasonably complicated because it uses `IntegerColumn` as
     // a free-standing container, and because `IntegerColumn` does not conform to the
@@ -797,6 +833,7 @@ inline TableViewBase::TableViewBase(TableViewBase&& tv) noexcept
     , m_distinct_column_source(tv.m_distinct_column_source)
     , m_distinct_predicate(std::move(tv.m_distinct_predicate))
     , m_sorting_predicate(std::move(tv.m_sorting_predicate))
+    , m_sort_limit(tv.m_sort_limit)
     , m_query(std::move(tv.m_query))
     , m_start(tv.m_start)
     , m_end(tv.m_end)
@@ -806,6 +843,8 @@ inline TableViewBase::TableViewBase(TableViewBase&& tv) noexcept
     // version number so that we can later trigger a sync if needed.
     m_last_seen_version(tv.m_last_seen_version)
     , m_num_detached_refs(tv.m_num_detached_refs)
+    , m_changed_rows(std::move(tv.m_changed_rows))
+    , m_changed_rows_version(tv.m_changed_rows_version)
 {
     if (m_table)
         m_table->move_registered_view(&tv, this);
@@ -841,6 +880,9 @@ inline TableViewBase& TableViewBase::operator=(TableViewBase&& tv) noexcept
     m_distinct_predicate = std::move(tv.m_distinct_predicate);
     m_distinct_column_source = tv.m_distinct_column_source;
     m_sorting_predicate = std::move(tv.m_sorting_predicate);
+    m_sort_limit = tv.m_sort_limit;
+    m_changed_rows = std::move(tv.m_changed_rows);
+    m_changed_rows_version = tv.m_changed_rows_version;
 
     return *this;
 }
@@ -877,6 +919,9 @@ inline TableViewBase& TableViewBase::operator=(const TableViewBase& tv)
     m_distinct_predicate = tv.m_distinct_predicate;
     m_distinct_column_source = tv.m_distinct_column_source;
     m_sorting_predicate = tv.m_sorting_predicate;
+    m_sort_limit = tv.m_sort_limit;
+    m_changed_rows = tv.m_changed_rows;
+    m_changed_rows_version = tv.m_changed_rows_version;
 
     return *this;
 }
@@ -491,85 +491,26 @@ bool equal_case_fold(StringData haystack, const char* needle_upper, const char*
 // in spirit to std::search().
 size_t search_case_fold(StringData haystack, const char* needle_upper, const char* needle_lower, size_t needle_size)
 {
-    // FIXME: This solution is very inefficient. Consider deploying the Boyer-Moore algorithm.
-    size_t i = 0;
-    while (needle_size <= haystack.size() - i) {
-        if (equal_case_fold(haystack.substr(i, needle_size), needle_upper, needle_lower)) {
+    if (needle_size == 0)
+        return 0;
+    if (needle_size > haystack.size())
+        return haystack.size(); // Not found
+
+    // Only positions where the first and the last byte match either case of
+    // the needle are candidates for the full comparison.
+    size_t last_offset = needle_size - 1;
+    const char* begin = haystack.data();
+    const char* candidates_end = begin + (haystack.size() - last_offset);
+    const char* p = begin;
+    for (;;) {
+        p = find_first_last_bytes(p, candidates_end, last_offset, needle_upper[0], needle_lower[0],
+                                  needle_upper[last_offset], needle_lower[last_offset]);
+        if (p == candidates_end)
+            return haystack.size(); // Not found
+        size_t i = size_t(p - begin);
+        if (equal_case_fold(haystack.substr(i, needle_size), needle_upper, needle_lower))
             return i;
-        }
-        ++i;
-    }
-    return haystack.size(); // Not found
-}
-
-// pre-declaration
-bool matchlike_ins(const StringData& text, const StringData& pattern_upper, const StringData& pattern_lower) noexcept;
-
-bool matchlike_ins(const StringData& text, const StringData& pattern_upper, const StringData& pattern_lower) noexcept
-{
-    std::vector<size_t> textpos;
-    std::vector<size_t> patternpos;
-    size_t p1 = 0; // position in text (haystack)
-    size_t p2 = 0; // position in pattern (needle)
-    
-    while (true) {
-        if (p1 == text.size()) {
-            if (p2 == pattern_lower.size())
-                return true;
-            if (p2 == pattern_lower.size()-1 && pattern_lower[p2] == '*')
-                return true;
-            goto no_match;
-        }
-        if (p2 == pattern_lower.size())
-            goto no_match;
-        
-        if (pattern_lower[p2] == '*') {
-            textpos.push_back(p1);
-            patternpos.push_back(++p2);
-            continue;
-        }
-        if (pattern_lower[p2] == '?') {
-            // utf-8 encoded characters may take up multiple bytes
-            if ((text[p1] & 0x80) == 0) {
-                ++p1;
-                ++p2;
-                continue;
-            }
-            else {
-                size_t p = 1;
-                while (p1+p != text.size() && (text[p1+p] & 0xc0) == 0x80)
-                    ++p;
-                p1 += p;
-                ++p2;
-                continue;
-            }
-        }
-        
-        if (pattern_lower[p2] == text[p1] || pattern_upper[p2] == text[p1]) {
-            ++p1;
-            ++p2;
-            continue;
-        }
-        
-    no_match:
-        if (textpos.empty())
-            return false;
-        else {
-            if (p1 == text.size()) {
-                textpos.pop_back();
-                patternpos.pop_back();
-                
-                if (textpos.empty())
-                    return false;
-                
-                p1 = textpos.back();
-            }
-            else {
-                p1 = textpos.back();
-                textpos.back() = ++p1;
-            }
-            p2 = patternpos.back();
-        }
+        ++p;
     }
 }
 
@@ -579,7 +520,7 @@ bool string_like_ins(StringData text, StringData upper, StringData lower) noexce
         return (text.is_null() && lower.is_null());
     }
     
-    return matchlike_ins(text, lower, upper);
+    return match_like(text.data(), text.size(), upper.data(), lower.data(), lower.size());
 }
 
 bool string_like_ins(StringData text, StringData pattern) noexcept
@@ -591,7 +532,7 @@ bool string_like_ins(StringData text, StringData pattern) noexcept
     std::string upper = case_map(pattern, true, IgnoreErrors);
     std::string lower = case_map(pattern, false, IgnoreErrors);
     
-    return matchlike_ins(text, lower.c_str(), upper.c_str());
+    return match_like(text.data(), text.size(), upper.data(), lower.data(), lower.size());
 }
 
 } // namespace realm
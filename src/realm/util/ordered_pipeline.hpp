@@ -0,0 +1,163 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_UTIL_ORDERED_PIPELINE_HPP
+#define REALM_UTIL_ORDERED_PIPELINE_HPP
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include <realm/util/thread.hpp>
+
+namespace realm {
+namespace util {
+
+/// The number of slots that run_ordered_pipeline() uses with \a
+/// thread_count worker threads.
+inline size_t get_pipeline_slot_count(size_t thread_count) noexcept
+{
+    return thread_count > 0 ? 2 * thread_count : 1;
+}
+
+/// Produces the items `0` to `count - 1` on up to \a thread_count worker
+/// threads, and consumes them on the calling thread, in order.
+///
+/// Each worker repeatedly claims the next item that has not been claimed, and
+/// calls `produce(item, slot)`. The calling thread calls `consume(item,
+/// slot)` for each item in ascending order, as soon as it has been
+/// produced. When the next item to consume has not been claimed yet, the
+/// calling thread produces it itself, so items are still produced when no
+/// worker thread could be started.
+///
+/// `slot` is less than `get_pipeline_slot_count(thread_count)`, and no two
+/// items that have been claimed but not consumed share a slot, so the result
+/// of producing an item can be kept in storage that is reused for later
+/// items. A worker waits for a slot to become free before claiming an item, so
+/// at most two items per thread are held at any time.
+///
+/// Consumption stops early when `consume` returns false. When `produce` or
+/// `consume` throws, no further items are claimed, and the first exception is
+/// rethrown once all worker threads have been joined.
+template <class Produce, class Consume>
+void run_ordered_pipeline(size_t count, size_t thread_count, Produce produce, Consume consume)
+{
+    size_t slot_count = get_pipeline_slot_count(thread_count);
+    std::unique_ptr<bool[]> ready(new bool[slot_count]()); // Throws
+
+    Mutex mutex;
+    CondVar changed;
+    size_t next = 0;     // The next item to be claimed
+    size_t consumed = 0; // The number of items consumed
+    bool stop = false;
+    std::exception_ptr error;
+
+    auto work = [&]() noexcept {
+        for (;;) {
+            size_t item;
+            {
+                LockGuard lock(mutex);
+                while (!stop && next < count && next >= consumed + slot_count)
+                    changed.wait(lock);
+                if (stop || next == count)
+                    return;
+                item = next++;
+            }
+            try {
+                produce(item, item % slot_count); // Throws
+            }
+            catch (...) {
+                LockGuard lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+                stop = true;
+                changed.notify_all();
+                return;
+            }
+            {
+                LockGuard lock(mutex);
+                ready[item % slot_count] = true;
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<Thread> threads(thread_count); // Throws
+    auto stop_and_join = [&]() noexcept {
+        {
+            LockGuard lock(mutex);
+            stop = true;
+        }
+        changed.notify_all();
+        for (auto& thread : threads) {
+            if (thread.joinable())
+                thread.join();
+        }
+    };
+
+    try {
+        try {
+            for (auto& thread : threads)
+                thread.start(work); // Throws
+        }
+        catch (...) {
+        }
+
+        for (; consumed < count; ) {
+            size_t slot = consumed % slot_count;
+            bool claimed = false;
+            {
+                LockGuard lock(mutex);
+                while (!ready[slot] && !error) {
+                    if (next == consumed) {
+                        ++next;
+                        claimed = true;
+                        break;
+                    }
+                    changed.wait(lock);
+                }
+                if (error)
+                    break;
+            }
+            if (claimed)
+                produce(consumed, slot); // Throws
+            bool more = consume(consumed, slot); // Throws
+            {
+                LockGuard lock(mutex);
+                ready[slot] = false;
+                ++consumed;
+            }
+            changed.notify_all();
+            if (!more)
+                break;
+        }
+    }
+    catch (...) {
+        stop_and_join();
+        throw;
+    }
+    stop_and_join();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} // namespace util
+} // namespace realm
+
+#endif // REALM_UTIL_ORDERED_PIPELINE_HPP
@@ -17,6 +17,7 @@
  **************************************************************************/
 
 #include <cstdlib> // size_t
+#include <cstring>
 #include <string>
 #include <cstdint>
 #include <atomic>
@@ -38,6 +39,7 @@
 #ifdef _MSC_VER
 #include <intrin.h>
 #endif
+#include <emmintrin.h> // SSE2
 #endif
 
 
@@ -259,6 +261,184 @@ uint64_t fastrand(uint64_t max, bool is_seed)
 }
 
 
+const char* find_first_last_bytes(const char* begin, const char* end, size_t last_offset, char first_1,
+                                  char first_2, char last_1, char last_2) noexcept
+{
+    const char* p = begin;
+#ifdef REALM_COMPILER_SSE
+    // SSE2 is always available on x86-64
+    const __m128i f1 = _mm_set1_epi8(first_1);
+    const __m128i f2 = _mm_set1_epi8(first_2);
+    const __m128i l1 = _mm_set1_epi8(last_1);
+    const __m128i l2 = _mm_set1_epi8(last_2);
+    while (end - p >= 16) {
+        __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + last_offset));
+        __m128i first_eq = _mm_or_si128(_mm_cmpeq_epi8(first, f1), _mm_cmpeq_epi8(first, f2));
+        __m128i last_eq = _mm_or_si128(_mm_cmpeq_epi8(last, l1), _mm_cmpeq_epi8(last, l2));
+        unsigned mask = unsigned(_mm_movemask_epi8(_mm_and_si128(first_eq, last_eq)));
+        if (mask != 0) {
+#if defined(_MSC_VER)
+            unsigned long i;
+            _BitScanForward(&i, mask);
+            return p + i;
+#else
+            return p + __builtin_ctz(mask);
+#endif
+        }
+        p += 16;
+    }
+#endif
+    for (; p != end; ++p) {
+        if ((*p == first_1 || *p == first_2) && (p[last_offset] == last_1 || p[last_offset] == last_2))
+            return p;
+    }
+    return end;
+}
+
+
+const char* search_substring(const char* begin, const char* end, const char* needle, size_t needle_size) noexcept
+{
+    if (needle_size == 0)
+        return begin;
+    if (size_t(end - begin) < needle_size)
+        return end;
+
+    size_t last_offset = needle_size - 1;
+    char first = needle[0];
+    char last = needle[last_offset];
+    const char* candidates_end = end - last_offset;
+    const char* p = begin;
+    for (;;) {
+        p = find_first_last_bytes(p, candidates_end, last_offset, first, first, last, last);
+        if (p == candidates_end)
+            return end;
+        // First and last bytes are known to match
+        if (needle_size <= 2 || std::memcmp(p + 1, needle + 1, needle_size - 2) == 0)
+            return p;
+        ++p;
+    }
+}
+
+
+namespace {
+
+const size_t no_match = size_t(-1);
+
+// Returns the end of the part of `text` that the pattern segment
+// [seg_begin, seg_end) matches from `pos`, or `no_match`.
+size_t match_like_segment(const char* text, size_t text_size, size_t pos, const char* upper, const char* lower,
+                          size_t seg_begin, size_t seg_end) noexcept
+{
+    for (size_t i = seg_begin; i != seg_end; ++i) {
+        if (pos == text_size)
+            return no_match;
+        if (lower[i] == '?') {
+            // utf-8 encoded characters may take up multiple bytes
+            ++pos;
+            if ((text[pos - 1] & 0x80) != 0) {
+                while (pos != text_size && (text[pos] & 0xc0) == 0x80)
+                    ++pos;
+            }
+            continue;
+        }
+        if (text[pos] != lower[i] && text[pos] != upper[i])
+            return no_match;
+        ++pos;
+    }
+    return pos;
+}
+
+// Finds the leftmost match of the pattern segment [seg_begin, seg_end) that
+// starts at, or after `pos` and ends at, or before `limit`. Returns the end of
+// the match, or `no_match`.
+size_t find_like_segment(const char* text, size_t limit, size_t pos, const char* upper, const char* lower,
+                         size_t seg_begin, size_t seg_end) noexcept
+{
+    size_t seg_size = seg_end - seg_begin;
+    if (std::memchr(lower + seg_begin, '?', seg_size)) {
+        for (; pos < limit; ++pos) {
+            size_t end = match_like_segment(text, limit, pos, upper, lower, seg_begin, seg_end);
+            if (end != no_match)
+                return end;
+        }
+        return no_match;
+    }
+
+    if (limit - pos < seg_size)
+        return no_match;
+    size_t last_offset = seg_size - 1;
+    const char* candidates_end = text + (limit - last_offset);
+    const char* p = text + pos;
+    for (;;) {
+        p = find_first_last_bytes(p, candidates_end, last_offset, upper[seg_begin], lower[seg_begin],
+                                  upper[seg_end - 1], lower[seg_end - 1]);
+        if (p == candidates_end)
+            return no_match;
+        size_t start = size_t(p - text);
+        size_t end = match_like_segment(text, limit, start, upper, lower, seg_begin, seg_end);
+        if (end != no_match)
+            return end;
+        ++p;
+    }
+}
+
+} // anonymous namespace
+
+
+bool match_like(const char* text, size_t text_size, const char* upper, const char* lower,
+                size_t pattern_size) noexcept
+{
+    const char* first_star = static_cast<const char*>(std::memchr(lower, '*', pattern_size));
+    if (!first_star)
+        return match_like_segment(text, text_size, 0, upper, lower, 0, pattern_size) == text_size;
+
+    // Anchored prefix
+    size_t prefix_end = size_t(first_star - lower);
+    size_t pos = match_like_segment(text, text_size, 0, upper, lower, 0, prefix_end);
+    if (pos == no_match)
+        return false;
+
+    // Anchored suffix. If it contains `?`, its size in the text is unknown,
+    // so it is matched last.
+    size_t suffix_begin = pattern_size;
+    while (lower[suffix_begin - 1] != '*')
+        --suffix_begin;
+    size_t suffix_size = pattern_size - suffix_begin;
+    bool suffix_has_wildcard = std::memchr(lower + suffix_begin, '?', suffix_size) != nullptr;
+    size_t limit = text_size;
+    if (!suffix_has_wildcard) {
+        if (text_size - pos < suffix_size)
+            return false;
+        limit = text_size - suffix_size;
+        if (match_like_segment(text, text_size, limit, upper, lower, suffix_begin, pattern_size) == no_match)
+            return false;
+    }
+
+    // The segments in between are matched as early as possible
+    size_t seg_begin = prefix_end + 1;
+    while (seg_begin < suffix_begin) {
+        size_t seg_end = seg_begin;
+        while (lower[seg_end] != '*')
+            ++seg_end;
+        if (seg_end != seg_begin) {
+            pos = find_like_segment(text, limit, pos, upper, lower, seg_begin, seg_end);
+            if (pos == no_match)
+                return false;
+        }
+        seg_begin = seg_end + 1;
+    }
+
+    if (!suffix_has_wildcard)
+        return true;
+    for (; pos <= text_size; ++pos) {
+        if (match_like_segment(text, text_size, pos, upper, lower, suffix_begin, pattern_size) == text_size)
+            return true;
+    }
+    return false;
+}
+
+
 void millisleep(size_t milliseconds)
 {
 #ifdef _WIN32
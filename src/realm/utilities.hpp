@@ -123,6 +123,31 @@ int fast_popcount32(int32_t x);
 int fast_popcount64(int64_t x);
 uint64_t fastrand(uint64_t max = 0xffffffffffffffffULL, bool is_seed = false);
 
+// Substring search. find_first_last_bytes() returns a pointer to the first
+// `p` in [begin, end) for which `p[0]` equals `first_1` or `first_2`, and
+// `p[last_offset]` equals `last_1` or `last_2`, or `end` if there is no such
+// `p`. The bytes up to `end + last_offset` must be readable. Only candidates
+// that pass this test need to be compared in full, which makes it a fast
+// filter for substring searches (also case insensitive ones). On x86-64 it
+// tests 16 positions at a time with SSE2.
+const char* find_first_last_bytes(const char* begin, const char* end, size_t last_offset, char first_1,
+                                  char first_2, char last_1, char last_2) noexcept;
+
+// Returns a pointer to the first occurrence of the needle in [begin, end), or
+// `end` if there is none. Same as std::search(), but faster.
+const char* search_substring(const char* begin, const char* end, const char* needle, size_t needle_size) noexcept;
+
+// Returns true if the text matches the pattern, where `*` matches any
+// sequence of characters and `?` matches a single (UTF-8 encoded)
+// character. A byte of the text matches a byte of the pattern if it equals
+// either `pattern_upper[i]` or `pattern_lower[i]`, which must be the same
+// pointer for case sensitive matching. The segments before the first and
+// after the last `*` are matched as an anchored prefix and suffix, and the
+// segments in between are searched for from left to right, so no
+// backtracking is needed.
+bool match_like(const char* text, size_t text_size, const char* pattern_upper, const char* pattern_lower,
+                size_t pattern_size) noexcept;
+
 // log2 - returns -1 if x==0, otherwise log2(x)
 inline int log2(size_t x)
 {
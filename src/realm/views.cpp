@@ -19,7 +19,15 @@
 #include <realm/views.hpp>
 
 #include <realm/column_link.hpp>
+#include <realm/column_string_enum.hpp>
+#include <realm/column_timestamp.hpp>
 #include <realm/table.hpp>
+#include <realm/unicode.hpp>
+
+#include <cstring>
+#include <numeric>
+#include <typeinfo>
+#include <unordered_set>
 
 using namespace realm;
 
@@ -111,32 +119,262 @@ public:
                            [=](auto&& col) { return col.is_null[i.index_in_view]; });
     }
 
+    // Whether the values of all columns were extracted, so that rows can be
+    // hashed and compared for equality without sorting them.
+    bool has_keys() const
+    {
+        return std::all_of(m_columns.begin(), m_columns.end(),
+                           [](auto&& col) { return col.key_type != KeyType::unsupported; });
+    }
+
+    // Rows that are equal according to the sort order have equal hashes.
+    // Requires has_keys().
+    size_t hash(IndexPair i) const noexcept;
+    bool equal(IndexPair i, IndexPair j) const noexcept;
+
 private:
+    // The values of the sort columns are extracted up front for the column
+    // types we know about, so that comparing two rows does not require a
+    // virtual call and two B+-tree lookups. Strings in enumerated columns are
+    // replaced by the rank of their key, which turns them into integer keys.
+    enum class KeyType { unsupported, integer, floating, timestamp, string };
+
     struct SortColumn {
         std::vector<bool> is_null;
         std::vector<size_t> translated_row;
         const ColumnBase* column;
         bool ascending;
+
+        KeyType key_type = KeyType::unsupported;
+        std::vector<bool> key_is_null;
+        std::vector<int64_t> int_keys;
+        std::vector<double> double_keys;
+        std::vector<Timestamp> timestamp_keys;
+        std::vector<StringData> string_keys;
     };
     std::vector<SortColumn> m_columns;
+
+    static void extract_keys(SortColumn&, IntegerColumn const& row_indexes);
+    static int compare_keys(SortColumn const&, size_t view_ndx_1, size_t view_ndx_2) noexcept;
 };
 
+namespace {
+
+// Same ordering as ColumnBase::compare_values(): nulls first, 1 if a < b
+template <class T>
+int compare_extracted(bool null_1, bool null_2, const T& a, const T& b) noexcept
+{
+    bool v1 = !null_1;
+    bool v2 = !null_2;
+    if (!v1 || !v2)
+        return v1 == v2 ? 0 : v1 < v2 ? 1 : -1;
+    return a == b ? 0 : a < b ? 1 : -1;
+}
+
+} // anonymous namespace
+
+void SortDescriptor::Sorter::extract_keys(SortColumn& col, IntegerColumn const& row_indexes)
+{
+    const ColumnBase* column = col.column;
+    const std::type_info& type = typeid(*column);
+    if (type == typeid(IntegerColumn) || type == typeid(IntNullColumn) || type == typeid(StringEnumColumn))
+        col.key_type = KeyType::integer;
+    else if (type == typeid(FloatColumn) || type == typeid(DoubleColumn))
+        col.key_type = KeyType::floating;
+    else if (type == typeid(TimestampColumn))
+        col.key_type = KeyType::timestamp;
+    else if (type == typeid(StringColumn))
+        col.key_type = KeyType::string;
+    else
+        return;
+
+    // Rank the keys of an enumerated column once, so that rows can be
+    // compared by the rank of their key index
+    std::vector<int64_t> key_ranks;
+    std::vector<bool> key_is_null;
+    if (type == typeid(StringEnumColumn)) {
+        const StringColumn& keys = static_cast<const StringEnumColumn*>(column)->get_keys();
+        size_t num_keys = keys.size();
+        std::vector<StringData> values(num_keys);
+        std::vector<size_t> order(num_keys);
+        key_is_null.resize(num_keys);
+        for (size_t i = 0; i < num_keys; ++i) {
+            values[i] = keys.get(i);
+            key_is_null[i] = values[i].is_null();
+        }
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            if (values[a].is_null() || values[b].is_null())
+                return values[a].is_null() && !values[b].is_null();
+            return values[a] != values[b] && utf8_compare(values[a], values[b]);
+        });
+        key_ranks.resize(num_keys);
+        for (size_t i = 0; i < num_keys; ++i)
+            key_ranks[order[i]] = int64_t(i);
+    }
+
+    size_t num_rows = row_indexes.size();
+    col.key_is_null.resize(num_rows);
+    switch (col.key_type) {
+        case KeyType::integer:
+            col.int_keys.resize(num_rows);
+            break;
+        case KeyType::floating:
+            col.double_keys.resize(num_rows);
+            break;
+        case KeyType::timestamp:
+            col.timestamp_keys.resize(num_rows);
+            break;
+        case KeyType::string:
+            col.string_keys.resize(num_rows);
+            break;
+        case KeyType::unsupported:
+            REALM_UNREACHABLE();
+    }
+
+    for (size_t view_ndx = 0; view_ndx < num_rows; ++view_ndx) {
+        int64_t ndx = row_indexes.get(view_ndx);
+        if (ndx == detached_ref)
+            continue;
+        size_t row = size_t(ndx);
+        if (!col.translated_row.empty()) {
+            if (col.is_null[view_ndx])
+                continue;
+            row = col.translated_row[view_ndx];
+        }
+
+        if (type == typeid(IntegerColumn)) {
+            col.int_keys[view_ndx] = static_cast<const IntegerColumn*>(column)->get(row);
+        }
+        else if (type == typeid(IntNullColumn)) {
+            auto value = static_cast<const IntNullColumn*>(column)->get(row);
+            col.key_is_null[view_ndx] = !value;
+            col.int_keys[view_ndx] = value ? *value : 0;
+        }
+        else if (type == typeid(StringEnumColumn)) {
+            size_t key_ndx = to_size_t(static_cast<const IntegerColumn*>(column)->get(row));
+            col.key_is_null[view_ndx] = key_is_null[key_ndx];
+            col.int_keys[view_ndx] = key_ranks[key_ndx];
+        }
+        else if (type == typeid(FloatColumn)) {
+            auto float_col = static_cast<const FloatColumn*>(column);
+            col.key_is_null[view_ndx] = float_col->is_null(row);
+            col.double_keys[view_ndx] = float_col->get(row);
+        }
+        else if (type == typeid(DoubleColumn)) {
+            auto double_col = static_cast<const DoubleColumn*>(column);
+            col.key_is_null[view_ndx] = double_col->is_null(row);
+            col.double_keys[view_ndx] = double_col->get(row);
+        }
+        else if (type == typeid(TimestampColumn)) {
+            auto timestamp_col = static_cast<const TimestampColumn*>(column);
+            col.key_is_null[view_ndx] = timestamp_col->is_null(row);
+            col.timestamp_keys[view_ndx] = timestamp_col->get(row);
+        }
+        else {
+            StringData value = static_cast<const StringColumn*>(column)->get(row);
+            col.key_is_null[view_ndx] = value.is_null();
+            col.string_keys[view_ndx] = value;
+        }
+    }
+}
+
+size_t SortDescriptor::Sorter::hash(IndexPair i) const noexcept
+{
+    size_t ndx = i.index_in_view;
+    uint64_t h = 14695981039346656037ULL;
+    auto combine = [&](uint64_t value) {
+        h = (h ^ value) * 1099511628211ULL;
+    };
+    for (auto& col : m_columns) {
+        if (col.key_is_null[ndx]) {
+            combine(0x6e756c6c);
+            continue;
+        }
+        switch (col.key_type) {
+            case KeyType::integer:
+                combine(uint64_t(col.int_keys[ndx]));
+                break;
+            case KeyType::floating: {
+                // -0.0 and 0.0 compare equal, so they must hash alike
+                double value = col.double_keys[ndx];
+                uint64_t bits = 0;
+                if (value != 0)
+                    std::memcpy(&bits, &value, sizeof bits);
+                combine(bits);
+                break;
+            }
+            case KeyType::timestamp: {
+                const Timestamp& value = col.timestamp_keys[ndx];
+                combine(uint64_t(value.get_seconds()));
+                combine(uint64_t(value.get_nanoseconds()));
+                break;
+            }
+            case KeyType::string: {
+                StringData value = col.string_keys[ndx];
+                for (size_t k = 0; k < value.size(); ++k)
+                    combine(uint8_t(value[k]));
+                combine(value.size());
+                break;
+            }
+            case KeyType::unsupported:
+                REALM_UNREACHABLE();
+        }
+    }
+    return size_t(h);
+}
+
+bool SortDescriptor::Sorter::equal(IndexPair i, IndexPair j) const noexcept
+{
+    return std::all_of(m_columns.begin(), m_columns.end(), [&](auto&& col) {
+        return compare_keys(col, i.index_in_view, j.index_in_view) == 0;
+    });
+}
+
+int SortDescriptor::Sorter::compare_keys(SortColumn const& col, size_t i, size_t j) noexcept
+{
+    bool null_i = col.key_is_null[i];
+    bool null_j = col.key_is_null[j];
+    switch (col.key_type) {
+        case KeyType::integer:
+            return compare_extracted(null_i, null_j, col.int_keys[i], col.int_keys[j]);
+        case KeyType::floating:
+            return compare_extracted(null_i, null_j, col.double_keys[i], col.double_keys[j]);
+        case KeyType::timestamp:
+            return compare_extracted(null_i, null_j, col.timestamp_keys[i], col.timestamp_keys[j]);
+        case KeyType::string: {
+            if (null_i || null_j)
+                return compare_extracted(null_i, null_j, 0, 0);
+            StringData a = col.string_keys[i];
+            StringData b = col.string_keys[j];
+            if (a == b)
+                return 0;
+            return utf8_compare(a, b) ? 1 : -1;
+        }
+        case KeyType::unsupported:
+            break;
+    }
+    REALM_UNREACHABLE();
+}
+
 SortDescriptor::Sorter::Sorter(std::vector<std::vector<const ColumnBase*>> const& columns,
                                std::vector<bool> const& ascending, IntegerColumn const& row_indexes)
 {
     REALM_ASSERT(!columns.empty());
     size_t num_rows = row_indexes.size();
 
-    m_columns.reserve(columns.size());
+    m_columns.resize(columns.size());
     for (size_t i = 0; i < columns.size(); ++i) {
-        m_columns.push_back({{}, {}, columns[i].back(), ascending[i]});
         REALM_ASSERT_EX(!columns[i].empty(), i);
+        m_columns[i].column = columns[i].back();
+        m_columns[i].ascending = ascending[i];
         if (columns[i].size() == 1) { // no link chain
+            extract_keys(m_columns[i], row_indexes);
             continue;
         }
 
-        auto& translated_rows = m_columns.back().translated_row;
-        auto& is_null = m_columns.back().is_null;
+        auto& translated_rows = m_columns[i].translated_row;
+        auto& is_null = m_columns[i].is_null;
         translated_rows.resize(num_rows);
         is_null.resize(num_rows);
 
@@ -153,6 +391,7 @@ SortDescriptor::Sorter::Sorter(std::vector<std::vector<const ColumnBase*>> const
             }
             translated_rows[row_ndx] = translated_index;
         }
+        extract_keys(m_columns[i], row_indexes);
     }
 }
 
@@ -161,6 +400,42 @@ SortDescriptor::Sorter SortDescriptor::sorter(IntegerColumn const& row_indexes)
     return Sorter(m_columns, m_ascending, row_indexes);
 }
 
+bool SortDescriptor::is_before(size_t row_ndx_1, size_t row_ndx_2) const noexcept
+{
+    for (size_t t = 0; t < m_columns.size(); t++) {
+        auto& columns = m_columns[t];
+        size_t index_1 = row_ndx_1;
+        size_t index_2 = row_ndx_2;
+        bool null_1 = false;
+        bool null_2 = false;
+        for (size_t j = 0; j + 1 < columns.size(); ++j) {
+            // type was checked when creating the SortDescriptor
+            auto link_col = static_cast<const LinkColumn*>(columns[j]);
+            if (!null_1) {
+                null_1 = link_col->is_null(index_1);
+                if (!null_1)
+                    index_1 = link_col->get_link(index_1);
+            }
+            if (!null_2) {
+                null_2 = link_col->is_null(index_2);
+                if (!null_2)
+                    index_2 = link_col->get_link(index_2);
+            }
+        }
+
+        if (null_1 && null_2)
+            continue;
+        if (null_1 || null_2) {
+            // Same as Sorter: null links at the end if ascending, else at beginning.
+            return m_ascending[t] != null_1;
+        }
+
+        if (int c = columns.back()->compare_values(index_1, index_2))
+            return m_ascending[t] ? c > 0 : c < 0;
+    }
+    return row_ndx_1 < row_ndx_2;
+}
+
 bool SortDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ordering) const
 {
     for (size_t t = 0; t < m_columns.size(); t++) {
@@ -183,14 +458,19 @@ bool SortDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ord
             index_j = m_columns[t].translated_row[j.index_in_view];
         }
 
-        if (int c = m_columns[t].column->compare_values(index_i, index_j))
+        int c;
+        if (m_columns[t].key_type != KeyType::unsupported)
+            c = compare_keys(m_columns[t], i.index_in_view, j.index_in_view);
+        else
+            c = m_columns[t].column->compare_values(index_i, index_j);
+        if (c)
             return m_columns[t].ascending ? c > 0 : c < 0;
     }
     // make sort stable by using original index as final comparison
     return total_ordering ? i.index_in_view < j.index_in_view : 0;
 }
 
-void RowIndexes::do_sort(const SortDescriptor& order, const SortDescriptor& distinct)
+void RowIndexes::do_sort(const SortDescriptor& order, const SortDescriptor& distinct, size_t limit)
 {
     if (!order && !distinct)
         return;
@@ -225,26 +505,45 @@ void RowIndexes::do_sort(const SortDescriptor& order, const SortDescriptor& dist
                     v.end());
         }
 
-        // Sort by the columns to distinct on
-        std::sort(v.begin(), v.end(), std::ref(sorting_predicate));
-
-        // Remove all duplicates
-        v.erase(std::unique(v.begin(), v.end(),
-                            [&](auto&& a, auto&& b) {
-                                // "not less than" is "equal" since they're sorted
-                                return !sorting_predicate(a, b, false);
-                            }),
-                v.end());
+        if (sorting_predicate.has_keys()) {
+            // Keep the first occurrence of each distinct value in a single
+            // pass, which also preserves the original order
+            auto hash = [&](IndexPair i) { return sorting_predicate.hash(i); };
+            auto equal = [&](IndexPair i, IndexPair j) { return sorting_predicate.equal(i, j); };
+            std::unordered_set<IndexPair, decltype(hash), decltype(equal)> seen(v.size(), hash, equal);
+            v.erase(std::remove_if(v.begin(), v.end(), [&](auto&& index) { return !seen.insert(index).second; }),
+                    v.end());
+        }
+        else {
+            // Sort by the columns to distinct on
+            std::sort(v.begin(), v.end(), std::ref(sorting_predicate));
+
+            // Remove all duplicates
+            v.erase(std::unique(v.begin(), v.end(),
+                                [&](auto&& a, auto&& b) {
+                                    // "not less than" is "equal" since they're sorted
+                                    return !sorting_predicate(a, b, false);
+                                }),
+                    v.end());
 
-        // Restore the original order unless we're just going to sort it again anyway
-        if (!order) {
-            std::sort(v.begin(), v.end(), [](auto a, auto b) { return a.index_in_view < b.index_in_view; });
+            // Restore the original order unless we're just going to sort it again anyway
+            if (!order) {
+                std::sort(v.begin(), v.end(), [](auto a, auto b) { return a.index_in_view < b.index_in_view; });
+            }
         }
     }
 
     if (order) {
         auto sorting_predicate = order.sorter(m_row_indexes);
-        std::sort(v.begin(), v.end(), std::ref(sorting_predicate));
+        if (limit < v.size()) {
+            // Only the first `limit` rows are kept, so select them with a
+            // bounded heap instead of sorting all of them
+            std::partial_sort(v.begin(), v.begin() + limit, v.end(), std::ref(sorting_predicate));
+            v.resize(limit);
+        }
+        else {
+            std::sort(v.begin(), v.end(), std::ref(sorting_predicate));
+        }
     }
 
     // Apply the results
@@ -63,6 +63,11 @@ public:
     class Sorter;
     Sorter sorter(IntegerColumn const& row_indexes) const;
 
+    // Returns whether row `row_ndx_1` comes before row `row_ndx_2` in the
+    // order given by this descriptor, with ties broken by row index, as in a
+    // sorted query result.
+    bool is_before(size_t row_ndx_1, size_t row_ndx_2) const noexcept;
+
 private:
     std::vector<std::vector<const ColumnBase*>> m_columns;
     std::vector<bool> m_ascending;
@@ -107,7 +112,10 @@ public:
     IntegerColumn m_row_indexes;
 
 protected:
-    void do_sort(const SortDescriptor& sorting_predicate, const SortDescriptor& distinct_columns);
+    // If `limit` is less than the number of rows, only the first `limit` rows
+    // in sorted order are kept (not counting detached refs).
+    void do_sort(const SortDescriptor& sorting_predicate, const SortDescriptor& distinct_columns,
+                 size_t limit = npos);
 
     static const uint64_t cookie_expected = 0x7765697677777777ull; // 0x77656976 = 'view'; 0x77777777 = '7777' = alive
     uint64_t m_debug_cookie;
@@ -306,6 +306,68 @@ TEST(Alloc_Fuzzy)
 }
 
 
+TEST(Alloc_SizeClassesAndArena)
+{
+    SlabAlloc alloc;
+    alloc.attach_empty();
+
+    // Small chunks of mixed sizes, and large ones spanning several slabs
+    std::vector<MemRef> refs;
+    for (size_t i = 0; i < 2000; ++i) {
+        size_t size = (i % 7 == 0) ? 8 * (1000 + i) : 8 * (i % 200 + 1);
+        MemRef r = alloc.alloc(size);
+        set_capacity(r.get_addr(), size);
+        memset(r.get_addr() + 3, static_cast<char>(i), size - 3);
+        refs.push_back(r);
+    }
+    for (size_t i = 0; i < refs.size(); ++i) {
+        CHECK_EQUAL(static_cast<void*>(refs[i].get_addr()), alloc.translate(refs[i].get_ref()));
+        CHECK_EQUAL(static_cast<char>(i), refs[i].get_addr()[get_capacity(refs[i].get_addr()) - 1]);
+    }
+
+    // Free every other chunk, then allocate chunks of the same sizes again
+    std::vector<size_t> sizes;
+    for (size_t i = 0; i < refs.size(); i += 2) {
+        sizes.push_back(get_capacity(refs[i].get_addr()));
+        alloc.free_(refs[i].get_ref(), refs[i].get_addr());
+    }
+    for (size_t i = 0; i < refs.size(); i += 2) {
+        size_t size = sizes[i / 2];
+        MemRef r = alloc.alloc(size);
+        set_capacity(r.get_addr(), size);
+        memset(r.get_addr() + 3, static_cast<char>(i), size - 3);
+        refs[i] = r;
+    }
+    for (size_t i = 0; i < refs.size(); ++i) {
+        CHECK_EQUAL(static_cast<void*>(refs[i].get_addr()), alloc.translate(refs[i].get_ref()));
+        CHECK_EQUAL(static_cast<char>(i), refs[i].get_addr()[get_capacity(refs[i].get_addr()) - 1]);
+    }
+
+    // Freeing the most recent allocation gives it back to the arena
+    MemRef last = alloc.alloc(64);
+    set_capacity(last.get_addr(), 64);
+    alloc.free_(last.get_ref(), last.get_addr());
+    MemRef again = alloc.alloc(128);
+    set_capacity(again.get_addr(), 128);
+    CHECK_EQUAL(last.get_ref(), again.get_ref());
+    alloc.free_(again.get_ref(), again.get_addr());
+
+    for (auto& r : refs)
+        alloc.free_(r.get_ref(), r.get_addr());
+#ifdef REALM_DEBUG
+    CHECK(alloc.is_all_free());
+#endif
+
+    // After a reset, all slabs are free again and can be reused
+    alloc.reset_free_space_tracking();
+    CHECK(alloc.is_free_space_clean());
+    MemRef r = alloc.alloc(8);
+    set_capacity(r.get_addr(), 8);
+    alloc.free_(r.get_ref(), r.get_addr());
+
+    // SlabAlloc destructor will verify that all is free'd
+}
+
 // This test reproduces the sporadic issue that was seen for large refs (addresses)
 // on 32-bit iPhone 5 Simulator runs on certain host machines.
 TEST(Alloc_ToAndFromRef)
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include <realm/array_string_long.hpp>
+#include <realm/util/to_string.hpp>
 #include "test.hpp"
 
 using namespace realm;
@@ -289,6 +290,133 @@ TEST_TYPES(ArrayStringLong_Basic, non_nullable, nullable)
 }
 
 
+TEST_TYPES(ArrayStringLong_Compressed, non_nullable, nullable)
+{
+    constexpr bool nullable = TEST_TYPE::value;
+
+    ArrayStringLong c(Allocator::get_default(), nullable);
+    bool compressed = true;
+    c.create(compressed);
+    CHECK(c.is_compressed());
+    CHECK(c.is_empty());
+
+    std::string long_1(200, 'a');
+    std::string long_2(300, 'b');
+
+    c.add(long_1);
+    c.add(long_2);
+    c.add(long_1);
+    c.insert(0, long_2);
+    c.add("");
+    CHECK_EQUAL(5, c.size());
+    CHECK_EQUAL(3, c.get_dictionary_size());
+    CHECK_EQUAL(long_2, c.get(0));
+    CHECK_EQUAL(long_1, c.get(1));
+    CHECK_EQUAL(long_2, c.get(2));
+    CHECK_EQUAL(long_1, c.get(3));
+    CHECK_EQUAL("", c.get(4));
+    CHECK_EQUAL(long_1, ArrayStringLong::get(c.get_mem().get_addr(), 3, c.get_alloc(), nullable));
+    CHECK_EQUAL(5, ArrayStringLong::get_size_from_header(c.get_mem().get_addr(), c.get_alloc()));
+
+    CHECK_EQUAL(2, c.count(long_1));
+    CHECK_EQUAL(1, c.find_first(long_1));
+    CHECK_EQUAL(3, c.find_first(long_1, 2));
+    CHECK_EQUAL(not_found, c.find_first("foo"));
+
+    c.set(1, "foo");
+    CHECK_EQUAL("foo", c.get(1));
+    CHECK_EQUAL(4, c.get_dictionary_size());
+    c.erase(0);
+    CHECK_EQUAL(4, c.size());
+    CHECK_EQUAL("foo", c.get(0));
+    CHECK_EQUAL(long_2, c.get(1));
+    CHECK_EQUAL(1, c.count(long_2));
+
+    c.add(realm::null());
+    CHECK_EQUAL(nullable, c.is_null(4));
+    CHECK_EQUAL(nullable, c.get(4).is_null());
+    CHECK_EQUAL(nullable ? 1 : 2, c.count(realm::null()));
+
+    // Attaching a new accessor must discover the compressed form and the
+    // nullability
+    {
+        ArrayStringLong c2(Allocator::get_default(), !nullable);
+        c2.init_from_ref(c.get_ref());
+        CHECK(c2.is_compressed());
+        CHECK_EQUAL(5, c2.size());
+        CHECK_EQUAL(long_2, c2.get(1));
+        CHECK_EQUAL(nullable, c2.is_null(4));
+    }
+
+    // Slicing drops dictionary entries that are no longer referenced
+    {
+        MemRef mem = c.slice(1, 2, Allocator::get_default());
+        ArrayStringLong slice(Allocator::get_default(), nullable);
+        slice.init_from_mem(mem);
+        CHECK(slice.is_compressed());
+        CHECK_EQUAL(2, slice.size());
+        CHECK_EQUAL(2, slice.get_dictionary_size());
+        CHECK_EQUAL(long_2, slice.get(0));
+        CHECK_EQUAL(long_1, slice.get(1));
+        slice.destroy();
+    }
+
+    c.truncate(2);
+    CHECK_EQUAL(2, c.size());
+    c.clear();
+    CHECK(c.is_empty());
+    CHECK_EQUAL(0, c.get_dictionary_size());
+
+    c.destroy();
+}
+
+
+TEST_TYPES(ArrayStringLong_CompressedChurn, non_nullable, nullable)
+{
+    constexpr bool nullable = TEST_TYPE::value;
+
+    ArrayStringLong c(Allocator::get_default(), nullable);
+    bool compressed = true;
+    c.create(compressed);
+    std::vector<std::string> expected;
+    auto value = [](size_t i) { return std::string(80, char('a' + i % 26)) + util::to_string(i); };
+
+    for (size_t i = 0; i < 100; ++i) {
+        std::string v = value(i % 10);
+        c.insert(i / 2, v);
+        expected.insert(expected.begin() + i / 2, v);
+    }
+    CHECK_EQUAL(10, c.get_dictionary_size());
+
+    // Overwriting every element many times with new strings leaves old
+    // dictionary entries behind, but they are reclaimed before they can make
+    // up most of the dictionary
+    for (size_t i = 0; i < 5000; ++i) {
+        std::string v = value(i * 7919 % 4001);
+        c.set(i % 100, v);
+        expected[i % 100] = v;
+        CHECK_LESS_EQUAL(c.get_dictionary_size(), 2 * c.size() + 17);
+    }
+    for (size_t i = 0; i < c.size(); i += 3) {
+        c.erase(i);
+        expected.erase(expected.begin() + i);
+    }
+    CHECK_EQUAL(expected.size(), c.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        CHECK_EQUAL(expected[i], c.get(i));
+        CHECK_EQUAL(expected[i], c.get(c.find_first(expected[i])));
+    }
+    std::string missing = value(4002);
+    CHECK_EQUAL(not_found, c.find_first(missing));
+
+    // Erasing the last element also empties the dictionary
+    while (!c.is_empty())
+        c.erase(0);
+    CHECK_EQUAL(0, c.get_dictionary_size());
+
+    c.destroy();
+}
+
 TEST(ArrayStringLong_Null)
 {
 
@@ -20,6 +20,7 @@
 #ifdef TEST_COLUMN_STRING
 
 #include <vector>
+#include <realm/alloc_slab.hpp>
 #include <realm/column_string.hpp>
 #include <realm/column_string_enum.hpp>
 #include <realm/index_string.hpp>
@@ -1625,4 +1626,66 @@ TEST(ColumnString_NonLeafRoot)
     }
 }
 
+
+TEST_TYPES(ColumnString_CompressLeaves, non_nullable, nullable)
+{
+    constexpr bool nullable = TEST_TYPE::value;
+
+    std::string payloads[] = {std::string(100, 'x'), std::string(5000, 'y'), std::string(70, 'z')};
+    auto payload = [&](size_t i) { return StringData(payloads[i % 3]); };
+
+    // Compressed leaves need file format version 7
+    {
+        SlabAlloc alloc;
+        alloc.attach_empty();
+        alloc.set_file_format_version(6);
+        ref_type ref = StringColumn::create(alloc);
+        StringColumn c(alloc, ref, nullable);
+        for (size_t i = 0; i < 8; ++i)
+            c.add(payloads[0]);
+        CHECK_NOT(c.compress_leaves());
+        alloc.set_file_format_version(7);
+        CHECK(c.compress_leaves());
+        c.destroy();
+    }
+
+    ref_type ref = StringColumn::create(Allocator::get_default());
+    StringColumn c(Allocator::get_default(), ref, nullable);
+
+    // Too few duplicates for compression to be worthwhile
+    c.add(payloads[0]);
+    c.add(payloads[1]);
+    CHECK_NOT(c.compress_leaves());
+
+    size_t n = REALM_MAX_BPNODE_SIZE * 2 + 5;
+    for (size_t i = 2; i < n; ++i)
+        c.add(payload(i));
+    CHECK(c.compress_leaves());
+    CHECK_NOT(c.compress_leaves());
+    c.verify();
+
+    CHECK_EQUAL(n, c.size());
+    for (size_t i = 0; i < n; ++i)
+        CHECK_EQUAL(payload(i), c.get(i));
+    CHECK_EQUAL((n + 1) / 3, c.count(payloads[1]));
+    CHECK_EQUAL(1, c.find_first(payloads[1]));
+    CHECK_EQUAL(not_found, c.find_first("foo"));
+
+    // Compressed leaves keep accepting long strings
+    std::string other(150, 'w');
+    c.set(1, other);
+    c.insert(3, other);
+    c.add("short");
+    CHECK_EQUAL(other, c.get(1));
+    CHECK_EQUAL(other, c.get(3));
+    CHECK_EQUAL(payload(3), c.get(4));
+    CHECK_EQUAL("short", c.get(n + 1));
+    c.erase(3);
+    c.move_last_over(0);
+    CHECK_EQUAL("short", c.get(0));
+    c.verify();
+
+    c.destroy();
+}
+
 #endif // TEST_COLUMN_STRING
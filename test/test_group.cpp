@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <sstream>
 
 #include <sys/stat.h>
 #ifndef _WIN32
@@ -1200,6 +1201,79 @@ TEST(Group_Serialize_Mem)
 }
 
 
+TEST(Group_Serialize_Snapshot)
+{
+    GROUP_TEST_PATH(path_1);
+    GROUP_TEST_PATH(path_2);
+    Group group;
+    TableRef table_1 = group.add_table("table_1");
+    table_1->add_column(type_Int, "int");
+    table_1->add_column(type_String, "string", true);
+    table_1->add_column(type_Binary, "binary");
+    TableRef table_2 = group.add_table("table_2");
+    table_2->add_column(type_Double, "double");
+    table_1->add_search_index(1);
+    for (size_t i = 0; i < 5000; ++i) {
+        std::string str(i % 40, char('a' + i % 26));
+        table_1->add_empty_row();
+        table_1->set_int(0, i, int64_t(i) * 7919);
+        if (i % 3)
+            table_1->set_string(1, i, str);
+        table_1->set_binary(2, i, BinaryData(str.data(), str.size()));
+        table_2->add_empty_row();
+        table_2->set_double(0, i, double(i) / 7);
+    }
+
+    // The arrays are laid out as when written to a stream, whether the group
+    // is written to memory or to a file
+    std::ostringstream out;
+    group.write(out);
+    std::string streamed = out.str();
+    BinaryData buffer = group.write_to_mem();
+    std::unique_ptr<const char[]> buffer_owner(buffer.data());
+    CHECK_EQUAL(streamed.size(), buffer.size());
+    size_t footer_size = 16; // Top ref and magic cookie
+    CHECK(std::equal(streamed.end() - footer_size, streamed.end(), buffer.data() + buffer.size() - footer_size));
+    group.write(path_1);
+    CHECK_EQUAL(streamed.size(), File(path_1).get_size());
+
+    // Also when the arrays are in a file
+    Group from_file(path_1);
+    CHECK(group == from_file);
+    from_file.write(path_2);
+    Group from_file_2(path_2);
+    CHECK(group == from_file_2);
+    Group from_mem(BinaryData(buffer.data(), buffer.size()), false);
+    CHECK(group == from_mem);
+#ifdef REALM_DEBUG
+    from_file_2.verify();
+    from_mem.verify();
+#endif
+
+    // A snapshot is copied the same way on any number of threads
+    _impl::StreamSnapshot snapshot;
+    _impl::OutputStream snapshot_out(snapshot);
+    std::string data(64 * 1024, '\0');
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = char(i * 31 % 251);
+    snapshot_out.write(data.data(), 8);
+    snapshot_out.set_borrow_arrays(true);
+    for (size_t i = 0; i + 8 < data.size(); i += 4096)
+        snapshot_out.write_array(data.data() + i, 4096 - i % 8192 / 2, 0x41414141);
+    snapshot_out.set_borrow_arrays(false);
+    snapshot_out.write(data.data(), 800);
+    std::ostringstream snapshot_stream;
+    snapshot.copy_to(snapshot_stream);
+    std::string expected = snapshot_stream.str();
+    CHECK_EQUAL(snapshot.size(), expected.size());
+    for (size_t thread_count = 1; thread_count <= 7; ++thread_count) {
+        std::string copy(snapshot.size(), '\0');
+        snapshot.copy_to(&copy[0], thread_count);
+        CHECK(copy == expected);
+    }
+}
+
+
 TEST(Group_Close)
 {
     Group to_mem;
@@ -0,0 +1,221 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_IMPORTER
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <realm.hpp>
+#include <realm/importer.hpp>
+#include <realm/util/to_string.hpp>
+
+#include "test.hpp"
+
+using namespace realm;
+using namespace realm::util;
+using namespace realm::test_util;
+
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+
+namespace {
+
+// Returns a csv file of `rows` rows and the columns name, number, ratio and comment. Most bytes are in quoted
+// comments with line breaks, so that the points where the file is split for parsing on several threads are likely to
+// fall inside them. Some names contain non-quoted line breaks, and some comments contain a double-quote without being
+// quoted, which makes counting quotes misleading. If `bad_row` is given, the number of that row is not an integer,
+// and if `bad_record` is given, that row has a field too many.
+std::string make_csv(size_t rows, size_t bad_row = npos, size_t bad_record = npos)
+{
+    std::string csv = "name,number,ratio,comment\n";
+    for (size_t i = 0; i < rows; ++i) {
+        if (i == bad_record) {
+            csv += "bad,1,2.5,x,extra\n";
+            continue;
+        }
+        csv += "name";
+        if (i > 10 && i % 11 == 0)
+            csv += "\nsplit";
+        csv += "," + (i == bad_row ? std::string("abc") : util::to_string(i)) + ",";
+        csv += util::to_string(i % 100) + ".5,";
+        if (i % 7 == 0) {
+            csv += "12\" pizza";
+        }
+        else {
+            csv += "\"";
+            for (size_t line = 0; line < 10; ++line)
+                csv += "line " + util::to_string(line) + (line == 5 ? " \"\"quoted\"\"\n" : "...\n");
+            csv += "\"";
+        }
+        csv += i % 5 == 0 ? "\r\n" : "\n";
+    }
+    return csv;
+}
+
+void write_file(const std::string& path, const std::string& csv)
+{
+    std::ofstream file(path.c_str(), std::ios::out | std::ios::binary);
+    file << csv;
+}
+
+// Imports the csv file at `path` through a FILE* if `threads` is zero, and otherwise through its path on `threads`
+// threads. Returns the number of rows imported, and sets `error` to the message of the exception thrown, if any.
+size_t import(const std::string& path, Table& table, size_t threads, std::string& error,
+              size_t import_rows = size_t(-1))
+{
+    Importer importer;
+    importer.Quiet = true;
+    importer.Empty_as_string = false;
+    importer.Threads = threads;
+    error.clear();
+    try {
+        if (threads != 0)
+            return importer.import_csv_auto(path, table, 100, import_rows);
+        std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+        return importer.import_csv_auto(file.get(), table, 100, import_rows);
+    }
+    catch (const std::runtime_error& e) {
+        error = e.what();
+        return 0;
+    }
+}
+
+const size_t thread_counts[] = {1, 2, 3, 8};
+
+} // anonymous namespace
+
+
+// A csv file that is imported from its path must give the same table as when it is imported through a FILE*, no
+// matter how many threads parse it.
+TEST(Importer_PathMatchesFile)
+{
+    TEST_PATH(path);
+    const size_t rows = 30000;
+    std::string csv = make_csv(rows);
+    CHECK_GREATER(csv.size(), 3 * parallel_chunk_size);
+    write_file(path, csv);
+
+    std::string error;
+    Table expected;
+    CHECK_EQUAL(import(path, expected, 0, error), rows);
+    CHECK_EQUAL(error, "");
+    CHECK_EQUAL(expected.get_column_count(), 4);
+    CHECK_EQUAL(expected.get_int(1, rows - 1), int64_t(rows - 1));
+    CHECK_EQUAL(expected.get_string(0, 11), "name\nsplit");
+    CHECK_EQUAL(expected.get_string(3, 7), "12\" pizza");
+    CHECK(expected.get_string(3, 8).ends_with("line 5 \"quoted\"\nline 6...\nline 7...\nline 8...\nline 9...\n"));
+
+    for (size_t threads : thread_counts) {
+        Table table;
+        CHECK_EQUAL(import(path, table, threads, error), rows);
+        CHECK_EQUAL(error, "");
+        CHECK(table == expected);
+    }
+
+    // Truncated by `import_rows`, also within the first rows, which are used to detect the scheme
+    for (size_t import_rows : {size_t(1), size_t(50), rows / 2, rows - 1}) {
+        Table truncated;
+        CHECK_EQUAL(import(path, truncated, 0, error, import_rows), import_rows);
+        for (size_t threads : thread_counts) {
+            Table table;
+            CHECK_EQUAL(import(path, table, threads, error, import_rows), import_rows);
+            CHECK(table == truncated);
+        }
+    }
+}
+
+
+// Errors must be reported with the same row and line numbers as when the file is imported through a FILE*, and not
+// at all for rows beyond `import_rows`.
+TEST(Importer_PathErrorsMatchFile)
+{
+    const size_t rows = 30000;
+    const size_t bad_row = 25000;
+
+    {
+        TEST_PATH(path);
+        write_file(path, make_csv(rows, bad_row));
+
+        std::string expected_error;
+        Table expected;
+        import(path, expected, 0, expected_error);
+        CHECK_NOT_EQUAL(expected_error.find("in row 25000 "), std::string::npos);
+        for (size_t threads : thread_counts) {
+            std::string error;
+            Table table;
+            import(path, table, threads, error);
+            CHECK_EQUAL(error, expected_error);
+            CHECK(table == expected);
+
+            Table truncated;
+            CHECK_EQUAL(import(path, truncated, threads, error, bad_row), bad_row);
+            CHECK_EQUAL(error, "");
+        }
+    }
+
+    {
+        TEST_PATH(path);
+        write_file(path, make_csv(rows, npos, bad_row));
+
+        std::string expected_error;
+        Table expected;
+        import(path, expected, 0, expected_error);
+        CHECK_NOT_EQUAL(expected_error.find("Wrong number of delimitors"), std::string::npos);
+        for (size_t threads : thread_counts) {
+            std::string error;
+            Table table;
+            import(path, table, threads, error);
+            CHECK_EQUAL(error, expected_error);
+        }
+    }
+}
+
+#endif // TEST_IMPORTER
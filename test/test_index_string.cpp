@@ -20,6 +20,7 @@
 #ifdef TEST_INDEX_STRING
 
 #include <realm.hpp>
+#include <realm/alloc_slab.hpp>
 #include <realm/index_string.hpp>
 #include <realm/column_linklist.hpp>
 #include <realm/column_string.hpp>
@@ -84,6 +85,23 @@ const int64_t ints[] = {0x1111,     0x11112222, 0x11113333, 0x1111333, 0x1111222
 using nullable = std::true_type;
 using non_nullable = std::false_type;
 
+bool contains_prefix_node(Allocator& alloc, ref_type ref)
+{
+    const char* header = alloc.translate(ref);
+    if (StringIndex::is_prefix_node(header))
+        return true;
+    if (!Array::get_context_flag_from_header(header))
+        return false; // List of row indexes
+    Array node(alloc);
+    node.init_from_ref(ref);
+    for (size_t i = 1; i < node.size(); ++i) {
+        int64_t value = node.get(i);
+        if (value != 0 && (value & 1) == 0 && contains_prefix_node(alloc, to_ref(value)))
+            return true;
+    }
+    return false;
+}
+
 } // anonymous namespace
 
 TEST(StringIndex_NonIndexable)
@@ -1632,6 +1650,228 @@ TEST(StringIndex_InsertLongPrefixAndQuery)
 }
 
 
+// Strings that only differ after a long common prefix are indexed through
+// prefix nodes, which skip the keys that all strings below them share.
+TEST(StringIndex_LongCommonPrefix)
+{
+    ref_type ref = StringColumn::create(Allocator::get_default());
+    StringColumn col(Allocator::get_default(), ref, true);
+
+    const StringIndex& ndx = *col.create_search_index();
+
+    std::string prefix = "https://www.example.com/some/long/path/";
+    std::string str_a = prefix + "index.html";
+    std::string str_b = prefix + "index.htm";
+    std::string str_c = prefix + "image.png";
+    std::string str_d = "https://www.example.org/";
+    std::string str_e = prefix.substr(0, 26); // Ends within the skipped bytes
+    std::string str_f = prefix;
+    std::string str_g = prefix + "index";
+    std::string str_h = prefix + "index.html5";
+
+    col.add(str_a);
+    col.add(str_b);
+    ndx.verify();
+    CHECK_EQUAL(col.find_first(str_a), 0);
+    CHECK_EQUAL(col.find_first(str_b), 1);
+    CHECK_EQUAL(col.find_first(str_c), not_found);
+    CHECK_EQUAL(col.find_first(str_e), not_found);
+
+    // Splits the prefix node at different depths
+    col.add(str_c);
+    col.add(str_d);
+    col.add(str_e);
+    col.add(str_f);
+    col.add(realm::null());
+    col.add("");
+    col.add(str_b);
+    ndx.verify();
+
+    CHECK_EQUAL(col.find_first(str_a), 0);
+    CHECK_EQUAL(col.find_first(str_b), 1);
+    CHECK_EQUAL(col.find_first(str_c), 2);
+    CHECK_EQUAL(col.find_first(str_d), 3);
+    CHECK_EQUAL(col.find_first(str_e), 4);
+    CHECK_EQUAL(col.find_first(str_f), 5);
+    CHECK_EQUAL(col.find_first(realm::null()), 6);
+    CHECK_EQUAL(col.find_first(""), 7);
+    CHECK_EQUAL(col.find_first(str_g), not_found);
+    CHECK_EQUAL(col.find_first(str_h), not_found);
+    CHECK_EQUAL(ndx.count(StringData(str_b)), 2);
+    CHECK(ndx.has_duplicate_values());
+
+    ref_type results_ref = IntegerColumn::create(Allocator::get_default());
+    IntegerColumn results(Allocator::get_default(), results_ref);
+    ndx.distinct(results);
+    CHECK_EQUAL(results.size(), 8);
+    results.clear();
+    ndx.find_all(results, StringData(str_b));
+    CHECK_EQUAL(results.size(), 2);
+    CHECK_EQUAL(results.get(0), 1);
+    CHECK_EQUAL(results.get(1), 8);
+    results.clear();
+
+    // Row indexes below prefix nodes are adjusted
+    col.insert(0, str_d);
+    CHECK_EQUAL(col.find_first(str_a), 1);
+    CHECK_EQUAL(col.find_first(str_c), 3);
+    CHECK_EQUAL(ndx.count(StringData(str_d)), 2);
+    col.erase(0);
+    ndx.verify();
+
+    col.set_string(0, str_c);
+    CHECK_EQUAL(col.find_first(str_a), not_found);
+    CHECK_EQUAL(ndx.count(StringData(str_c)), 2);
+    col.erase(1);
+    col.erase(0);
+    col.erase(0);
+    ndx.verify();
+    CHECK_EQUAL(col.find_first(str_b), 5);
+    CHECK_EQUAL(col.find_first(str_c), not_found);
+    CHECK_EQUAL(col.find_first(str_e), 1);
+    CHECK(!ndx.has_duplicate_values());
+
+    results.destroy();
+    col.destroy();
+}
+
+
+TEST(StringIndex_FindAllCaseInsensitive)
+{
+    ref_type ref = StringColumn::create(Allocator::get_default());
+    StringColumn col(Allocator::get_default(), ref, true);
+
+    const StringIndex& ndx = *col.create_search_index();
+
+    col.add("john.doe@example.com");  // 0
+    col.add("John.Doe@Example.com");  // 1
+    col.add("JOHN.DOE@EXAMPLE.COM");  // 2
+    col.add("john.doe@example.co");   // 3
+    col.add("jane.doe@example.com");  // 4
+    col.add("John.Doe@Example.com");  // 5
+    col.add("");                      // 6
+    col.add(realm::null());           // 7
+    col.add("John");                  // 8
+    col.add("JOHN");                  // 9
+    col.add("Johnny");                // 10
+
+    auto find = [&](StringData value) {
+        std::string upper = *case_map(value, true);
+        std::string lower = *case_map(value, false);
+        ref_type results_ref = IntegerColumn::create(Allocator::get_default());
+        IntegerColumn results(Allocator::get_default(), results_ref);
+        ndx.find_all_case_insensitive(results, value, upper.data(), lower.data());
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < results.size(); ++i)
+            rows.push_back(to_size_t(results.get(i)));
+        results.destroy();
+        return rows;
+    };
+
+    std::vector<size_t> expected = {0, 1, 2, 5};
+    CHECK(find("jOhN.dOe@eXaMpLe.CoM") == expected);
+    expected = {3};
+    CHECK(find("JOHN.DOE@EXAMPLE.CO") == expected);
+    expected = {8, 9};
+    CHECK(find("john") == expected);
+    expected = {6};
+    CHECK(find("") == expected);
+    expected = {7};
+    CHECK(find(realm::null()) == expected);
+    CHECK(find("johnn").empty());
+    CHECK(find("joh").empty());
+
+    col.destroy();
+}
+
+
+// A case insensitive lookup must only look up the case variants of each key,
+// rather than scan the range of keys between the upper and lower case forms,
+// which covers most of an index of mixed case strings.
+TEST(StringIndex_FindAllCaseInsensitiveLookups)
+{
+    ref_type ref = StringColumn::create(Allocator::get_default());
+    StringColumn col(Allocator::get_default(), ref, true);
+
+    const StringIndex& ndx = *col.create_search_index();
+
+    Random random(random_int<unsigned long>());
+    const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    const size_t num_rows = 20000;
+    std::vector<std::string> lower_values;
+    for (size_t i = 0; i < num_rows; ++i) {
+        std::string str;
+        for (size_t j = 0; j < 6; ++j)
+            str += letters[random.draw_int_mod(52)];
+        col.add(str);
+        lower_values.push_back(*case_map(str, false));
+    }
+    std::string duplicate = col.get(num_rows / 2);
+    col.add(duplicate);
+    lower_values.push_back(lower_values[num_rows / 2]);
+
+    for (size_t i = 0; i < 10; ++i) {
+        std::string value = col.get(random.draw_int_mod(num_rows));
+        value[0] ^= 0x20; // Swap the case of the first letter
+        std::string upper = *case_map(value, true);
+        std::string lower = *case_map(value, false);
+
+        ref_type results_ref = IntegerColumn::create(Allocator::get_default());
+        IntegerColumn results(Allocator::get_default(), results_ref);
+        size_t looked_up = ndx.find_all_case_insensitive(results, value, upper.data(), lower.data());
+        CHECK_LESS(looked_up, 100);
+
+        std::vector<size_t> expected;
+        for (size_t row = 0; row < lower_values.size(); ++row) {
+            if (lower_values[row] == lower)
+                expected.push_back(row);
+        }
+        CHECK_EQUAL(results.size(), expected.size());
+        for (size_t j = 0; j < results.size() && j < expected.size(); ++j)
+            CHECK_EQUAL(to_size_t(results.get(j)), expected[j]);
+        results.destroy();
+    }
+
+    col.destroy();
+}
+
+
+// Files of format versions before 7 cannot contain prefix nodes, so the
+// index keeps using chains of subindexes in them.
+TEST(StringIndex_LongCommonPrefixFileFormat)
+{
+    SlabAlloc alloc;
+    alloc.attach_empty();
+    alloc.set_file_format_version(6);
+    ref_type ref = StringColumn::create(alloc);
+    StringColumn col(alloc, ref, true);
+
+    const StringIndex& ndx = *col.create_search_index();
+
+    std::string prefix = "https://www.example.com/some/long/path/";
+    std::string str_a = prefix + "index.html";
+    std::string str_b = prefix + "image.png";
+    std::string str_c = prefix + "index.htm";
+
+    col.add(str_a);
+    col.add(str_b);
+    ndx.verify();
+    CHECK_NOT(contains_prefix_node(alloc, ndx.get_ref()));
+    CHECK_EQUAL(col.find_first(str_a), 0);
+    CHECK_EQUAL(col.find_first(str_b), 1);
+
+    alloc.set_file_format_version(7);
+    col.add(str_c);
+    ndx.verify();
+    CHECK(contains_prefix_node(alloc, ndx.get_ref()));
+    CHECK_EQUAL(col.find_first(str_a), 0);
+    CHECK_EQUAL(col.find_first(str_b), 1);
+    CHECK_EQUAL(col.find_first(str_c), 2);
+
+    col.destroy();
+}
+
+
 TEST(StringIndex_Fuzzy)
 {
     constexpr size_t chunkcount = 50;
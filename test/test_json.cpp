@@ -26,6 +26,7 @@
 #include <ostream>
 
 #include <realm.hpp>
+#include <realm/json_export.hpp>
 #include <realm/lang_bind_helper.hpp>
 
 #include "util/misc.hpp"
@@ -497,6 +498,95 @@ TEST(Json_LinkCycles)
     CHECK(json_test(ss.str(), "expected_json_link_cycles5", generate_all));
 }
 
+TEST(Json_Export)
+{
+    // Same output as to_json() with a link depth of 0
+    {
+        Table table;
+        setup_multi_table(table, 15, 2);
+
+        std::stringstream ss;
+        export_json(table, ss);
+        CHECK(json_test(ss.str(), "expect_json", false));
+    }
+
+    Group group;
+    TableRef table1 = group.add_table("table1");
+    TableRef table2 = group.add_table("table2");
+    group.add_table("empty");
+    TableRef table3 = group.add_table("table3");
+    table1->add_column(type_Int, "int", true);
+    table1->add_column(type_String, "str", true);
+    table1->add_column(type_Double, "double", true);
+    table1->add_column(type_Timestamp, "time", true);
+    table2->add_column(type_Bool, "bool");
+    table3->add_column(type_Int, "int");
+    size_t col_link = table2->add_column_link(type_Link, "link", *table1);
+    size_t col_link_list = table2->add_column_link(type_LinkList, "links", *table1);
+
+    table1->add_empty_row(2500);
+    for (size_t i = 0; i < 2500; ++i) {
+        std::string str = "str" + util::to_string(i);
+        table1->set_int(0, i, int64_t(i) * (i % 2 ? -1 : 1));
+        table1->set_string(1, i, str);
+        table1->set_double(2, i, i / 3.0);
+        table1->set_timestamp(3, i, Timestamp(int64_t(i) * 86400 * 7, 0));
+    }
+    table2->add_empty_row(3);
+    table2->set_bool(0, 1, true);
+    table2->set_link(col_link, 0, 2499);
+    table2->get_linklist(col_link_list, 0)->add(1);
+    table2->get_linklist(col_link_list, 0)->add(2);
+    table3->add_empty_row(1500);
+
+    std::stringstream expected;
+    group.to_json(expected, 0);
+    std::stringstream ss;
+    export_json(group, ss);
+    CHECK_EQUAL(expected.str(), ss.str());
+
+    // Any batch size and number of threads give the same output
+    JsonExportConfig config;
+    for (size_t thread_count : {1, 2, 7}) {
+        for (size_t batch_size : {1, 100, 5000}) {
+            config.thread_count = thread_count;
+            config.batch_size = batch_size;
+            ss.str("");
+            export_json(group, ss, config);
+            CHECK_EQUAL(expected.str(), ss.str());
+        }
+    }
+
+    // NDJSON: one row per line
+    config.ndjson = true;
+    ss.str("");
+    export_json(group, ss, config);
+    std::string ndjson = ss.str();
+    CHECK_EQUAL(2500 + 3 + 1500, std::count(ndjson.begin(), ndjson.end(), '\n'));
+    CHECK_EQUAL(0, ndjson.find("{\"table\":\"table1\",\"row\":{\"int\":0,\"str\":\"str0\","));
+    CHECK_NOT_EQUAL(std::string::npos, ndjson.find("\n{\"table\":\"table3\",\"row\":{\"int\":0}}\n"));
+    ss.str("");
+    export_json(*table2, ss, config);
+    CHECK_EQUAL("{\"bool\":false,\"link\":\"2499\",\"links\":{\"table\": \"table1\", \"rows\": [1, 2]}}\n"
+                "{\"bool\":true,\"link\":[],\"links\":{\"table\": \"table1\", \"rows\": []}}\n"
+                "{\"bool\":false,\"link\":[],\"links\":{\"table\": \"table1\", \"rows\": []}}\n",
+                ss.str());
+
+    // Nulls, escaping and non-finite values
+    table1->clear();
+    table1->add_empty_row(2);
+    table1->set_string(1, 0, "a\"b\\c\nd\x01");
+    table1->set_double(2, 0, std::numeric_limits<double>::infinity());
+    table1->set_timestamp(3, 0, Timestamp(-1, 0));
+    table1->set_int(0, 1, std::numeric_limits<int64_t>::min());
+    ss.str("");
+    export_json(*table1, ss);
+    CHECK_EQUAL("[{\"int\":null,\"str\":\"a\\\"b\\\\c\\nd\\u0001\",\"double\":null,"
+                "\"time\":\"1969-12-31 23:59:59\"},"
+                "{\"int\":-9223372036854775808,\"str\":null,\"double\":null,\"time\":null}]",
+                ss.str());
+}
+
 } // anonymous namespace
 
 #endif // TEST_TABLE
@@ -7617,6 +7617,88 @@ TEST(LangBindHelper_AdvanceReadTransact_UnorderedTableViewClear)
     CHECK_EQUAL(row.get_int(0), 2);
 }
 
+TEST(LangBindHelper_AdvanceReadTransact_PatchedTableViews)
+{
+    SHARED_GROUP_TEST_PATH(path);
+
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    SharedGroup sg(*hist, SharedGroupOptions(crypt_key()));
+    std::unique_ptr<Replication> hist_w(make_in_realm_history(path));
+    SharedGroup sg_w(*hist_w, SharedGroupOptions(crypt_key()));
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const char* strings[] = {"abc", "bcd", "cab", "xyz"};
+    {
+        WriteTransaction wt(sg_w);
+        TableRef table = wt.add_table("table");
+        table->add_column(type_Int, "int");
+        table->add_column(type_String, "string", true);
+        table->add_empty_row(200);
+        for (size_t i = 0; i < 200; ++i) {
+            table->set_int(0, i, random.draw_int_mod(100));
+            table->set_string(1, i, strings[random.draw_int_mod(4)]);
+        }
+        wt.commit();
+    }
+
+    ConstTableRef table = sg.begin_read().get_table("table");
+    auto make_views = [&] {
+        std::vector<TableView> views;
+        views.push_back(table->where().greater(0, 50).find_all());
+        views.push_back(table->where().greater(0, 20).find_all());
+        views.back().sort(0);
+        views.push_back(table->where().find_all());
+        views.back().sort(SortDescriptor(*table, {{1}, {0}}, {false, true}));
+        views.push_back(table->where().contains(1, "a").less(0, 70).find_all());
+        views.back().sort(0, false);
+        return views;
+    };
+    std::vector<TableView> views = make_views();
+
+    for (int round = 0; round < 50; ++round) {
+        {
+            WriteTransaction wt(sg_w);
+            TableRef t = wt.get_table("table");
+            for (int i = 0; i < 5; ++i) {
+                size_t row_ndx = random.draw_int_mod(t->size());
+                switch (random.draw_int_mod(6)) {
+                    case 0:
+                        t->insert_empty_row(row_ndx);
+                        break;
+                    case 1:
+                        t->remove(row_ndx);
+                        break;
+                    case 2:
+                        t->move_last_over(row_ndx);
+                        break;
+                    case 3:
+                        t->set_null(1, row_ndx);
+                        break;
+                    case 4:
+                        t->set_string(1, row_ndx, strings[random.draw_int_mod(4)]);
+                        break;
+                    default:
+                        t->set_int(0, row_ndx, random.draw_int_mod(100));
+                        break;
+                }
+            }
+            wt.commit();
+        }
+        LangBindHelper::advance_read(sg);
+
+        // The views must be identical to views created from scratch
+        std::vector<TableView> expected = make_views();
+        for (size_t v = 0; v < views.size(); ++v) {
+            views[v].sync_if_needed();
+            CHECK(views[v].is_in_sync());
+            if (CHECK_EQUAL(views[v].size(), expected[v].size())) {
+                for (size_t i = 0; i < views[v].size(); ++i)
+                    CHECK_EQUAL(views[v].get_source_ndx(i), expected[v].get_source_ndx(i));
+            }
+        }
+    }
+}
+
 namespace {
 // A base class for transaction log parsers so that tests which want to test
 // just a single part of the transaction log handling don't have to implement
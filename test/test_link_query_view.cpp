@@ -19,7 +19,10 @@
 #include "testsettings.hpp"
 #ifdef TEST_LINK_VIEW
 
+#include <algorithm>
+#include <functional>
 #include <limits>
+#include <numeric>
 #include <string>
 #include <sstream>
 #include <ostream>
@@ -1993,6 +1996,217 @@ TEST(BackLink_Query_MultipleLevels)
     CHECK_TABLE_VIEW(q15.find_all(), {hannah, elijah, mark, jason, diane, carol});
 }
 
+// Test chains of long link lists, which are resolved one hop at a time without LinkView accessors.
+TEST(LinkList_QueryMultipleLevelsLongLists)
+{
+    Group group;
+
+    TableRef origin = group.add_table("origin");
+    TableRef middle = group.add_table("middle");
+    TableRef target = group.add_table("target");
+
+    size_t col_value = target->add_column(type_Int, "value");
+    size_t col_middle_to_target = middle->add_column_link(type_LinkList, "targets", *target);
+    size_t col_origin_to_middle = origin->add_column_link(type_LinkList, "middles", *middle);
+    size_t col_origin_to_target = origin->add_column_link(type_Link, "target", *target);
+
+    const size_t num_targets = 50;
+    target->add_empty_row(num_targets);
+    for (size_t i = 0; i < num_targets; ++i)
+        target->set_int(col_value, i, i);
+
+    // Lists long enough to span several B+-tree leaves, with duplicate targets.
+    middle->add_empty_row(6);
+    for (size_t i = 0; i < middle->size(); ++i) {
+        LinkViewRef links = middle->get_linklist(col_middle_to_target, i);
+        for (size_t j = 0; j < 40 * i; ++j)
+            links->add((i * 7 + j * 3) % num_targets);
+    }
+
+    origin->add_empty_row(8);
+    for (size_t i = 0; i < origin->size(); ++i) {
+        LinkViewRef links = origin->get_linklist(col_origin_to_middle, i);
+        for (size_t j = 0; j < i; ++j)
+            links->add((i + j) % middle->size());
+        if (i % 3 != 0)
+            origin->set_link(col_origin_to_target, i, i * 5);
+    }
+
+    auto reached_targets = [&](size_t row) {
+        std::vector<size_t> result;
+        LinkViewRef middles = origin->get_linklist(col_origin_to_middle, row);
+        for (size_t i = 0; i < middles->size(); ++i) {
+            LinkViewRef targets = middle->get_linklist(col_middle_to_target, middles->get(i).get_index());
+            for (size_t j = 0; j < targets->size(); ++j)
+                result.push_back(targets->get(j).get_index());
+        }
+        return result;
+    };
+
+    for (int64_t value : {0, 7, 31, 49}) {
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < origin->size(); ++i) {
+            std::vector<size_t> targets = reached_targets(i);
+            if (std::find(targets.begin(), targets.end(), size_t(value)) != targets.end())
+                expected.push_back(i);
+        }
+        Query q = origin->link(col_origin_to_middle).link(col_middle_to_target).column<Int>(col_value) == value;
+        CHECK_TABLE_VIEW(q.find_all(), expected);
+    }
+
+    for (size_t i = 0; i < origin->size(); ++i) {
+        std::vector<size_t> targets = reached_targets(i);
+        int64_t sum = std::accumulate(targets.begin(), targets.end(), int64_t(0));
+        Query q =
+            origin->link(col_origin_to_middle).column<Link>(col_middle_to_target).column<Int>(col_value).sum() == sum;
+        TableView tv = q.find_all();
+        CHECK_NOT_EQUAL(tv.find_by_source_ndx(i), npos);
+
+        Query count = origin->link(col_origin_to_middle).column<Link>(col_middle_to_target).count() ==
+                      int64_t(targets.size());
+        tv = count.find_all();
+        CHECK_NOT_EQUAL(tv.find_by_source_ndx(i), npos);
+    }
+
+    // Walk back from the targets, counting every path that reaches them.
+    for (size_t t = 0; t < num_targets; ++t) {
+        int64_t num_paths = 0;
+        for (size_t i = 0; i < origin->size(); ++i) {
+            std::vector<size_t> targets = reached_targets(i);
+            num_paths += std::count(targets.begin(), targets.end(), t);
+        }
+        Query q = target->backlink(*middle, col_middle_to_target)
+                      .column<BackLink>(*origin, col_origin_to_middle)
+                      .count() == num_paths;
+        TableView tv = q.find_all();
+        CHECK_NOT_EQUAL(tv.find_by_source_ndx(t), npos);
+    }
+
+    // Single links mixed into the chain.
+    Query q = target->backlink(*origin, col_origin_to_target)
+                  .link(col_origin_to_middle)
+                  .column<Link>(col_middle_to_target)
+                  .count() > 0;
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < origin->size(); ++i) {
+        if (i % 3 != 0 && !reached_targets(i).empty())
+            expected.push_back(i * 5);
+    }
+    CHECK_TABLE_VIEW(q.find_all(), expected);
+}
+
+// Equality conditions on columns reached through links are answered from the target table and its backlinks.
+TEST(LinkList_QueryEqualityThroughBacklinks)
+{
+    Group group;
+
+    TableRef origin = group.add_table("origin");
+    TableRef target = group.add_table("target");
+
+    size_t col_name = target->add_column(type_String, "name", true);
+    size_t col_value = target->add_column(type_Int, "value", true);
+    size_t col_link = origin->add_column_link(type_Link, "link", *target);
+    size_t col_list = origin->add_column_link(type_LinkList, "list", *target);
+    size_t col_number = origin->add_column(type_Int, "number");
+    target->add_search_index(col_name);
+
+    const char* names[] = {"foo", "bar", "Foo", "baz"};
+    target->add_empty_row(20);
+    for (size_t i = 0; i < target->size(); ++i) {
+        target->set_string(col_name, i, names[i % 4]);
+        if (i % 5 != 0)
+            target->set_int(col_value, i, i % 3);
+    }
+
+    origin->add_empty_row(30);
+    for (size_t i = 0; i < origin->size(); ++i) {
+        if (i % 4 != 0)
+            origin->set_link(col_link, i, (i * 7) % target->size());
+        LinkViewRef list = origin->get_linklist(col_list, i);
+        for (size_t j = 0; j < i % 5; ++j)
+            list->add((i + j * 3) % target->size());
+        origin->set_int(col_number, i, i % 2);
+    }
+
+    auto matching_rows = [&](size_t col, std::function<bool(size_t)> pred, bool only_odd) {
+        std::vector<size_t> result;
+        for (size_t i = 0; i < origin->size(); ++i) {
+            if (only_odd && origin->get_int(col_number, i) == 0)
+                continue;
+            bool match = false;
+            if (col == col_link) {
+                match = !origin->is_null_link(col_link, i) && pred(origin->get_link(col_link, i));
+            }
+            else {
+                LinkViewRef list = origin->get_linklist(col_list, i);
+                for (size_t j = 0; j < list->size() && !match; ++j)
+                    match = pred(list->get(j).get_index());
+            }
+            if (match)
+                result.push_back(i);
+        }
+        return result;
+    };
+    auto name_is = [&](StringData name) {
+        return [=](size_t row) { return target->get_string(col_name, row) == name; };
+    };
+    auto value_is = [&](int64_t value) {
+        return [=](size_t row) { return !target->is_null(col_value, row) && target->get_int(col_value, row) == value; };
+    };
+
+    for (size_t col : {col_link, col_list}) {
+        Query q = origin->link(col).column<String>(col_name) == "foo";
+        CHECK_TABLE_VIEW(q.find_all(), matching_rows(col, name_is("foo"), false));
+        CHECK_EQUAL(q.count(), matching_rows(col, name_is("foo"), false).size());
+
+        q = origin->where().equal(col_number, 1).and_query(origin->link(col).column<String>(col_name) == "bar");
+        CHECK_TABLE_VIEW(q.find_all(), matching_rows(col, name_is("bar"), true));
+
+        q = origin->link(col).column<String>(col_name).equal("FOO", false);
+        auto either_foo = [&](size_t row) { return name_is("foo")(row) || name_is("Foo")(row); };
+        CHECK_TABLE_VIEW(q.find_all(), matching_rows(col, either_foo, false));
+
+        q = origin->link(col).column<Int>(col_value) == 2;
+        CHECK_TABLE_VIEW(q.find_all(), matching_rows(col, value_is(2), false));
+
+        q = origin->link(col).column<String>(col_name) == "none";
+        CHECK_TABLE_VIEW(q.find_all(), {});
+    }
+
+    // Null constants are not answered from the target table, since null links match them.
+    Query q = origin->link(col_link).column<Int>(col_value) == null();
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < origin->size(); ++i) {
+        if (origin->is_null_link(col_link, i) || target->is_null(col_value, origin->get_link(col_link, i)))
+            expected.push_back(i);
+    }
+    CHECK_TABLE_VIEW(q.find_all(), expected);
+
+    // The matching rows are recomputed for every search.
+    q = origin->link(col_list).column<String>(col_name) == "baz";
+    size_t count = q.count();
+    origin->get_linklist(col_list, 0)->add(3);
+    CHECK_EQUAL(q.count(), count + 1);
+    CHECK_EQUAL(q.find(), 0);
+
+    // Through a backlink and back again.
+    q = target->backlink(*origin, col_link).link(col_list).column<String>(col_name) == "foo";
+    expected.clear();
+    for (size_t t = 0; t < target->size(); ++t) {
+        bool match = false;
+        for (size_t i = 0; i < origin->size() && !match; ++i) {
+            if (origin->is_null_link(col_link, i) || origin->get_link(col_link, i) != t)
+                continue;
+            LinkViewRef list = origin->get_linklist(col_list, i);
+            for (size_t j = 0; j < list->size() && !match; ++j)
+                match = name_is("foo")(list->get(j).get_index());
+        }
+        if (match)
+            expected.push_back(t);
+    }
+    CHECK_TABLE_VIEW(q.find_all(), expected);
+}
+
 // Test queries involving the multiple levels of backlinks across multiple tables.
 TEST(BackLink_Query_MultipleLevelsAndTables)
 {
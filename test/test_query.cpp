@@ -20,6 +20,7 @@
 #ifdef TEST_QUERY
 
 #include <cstdlib> // itoa()
+#include <functional>
 #include <initializer_list>
 #include <limits>
 #include <vector>
@@ -5220,6 +5221,79 @@ TEST(Query_Enums)
 }
 
 
+TEST(Query_EnumsContains)
+{
+    Table table;
+    table.add_column(type_String, "str", true);
+
+    for (size_t i = 0; i < 1000; ++i) {
+        size_t row = table.add_empty_row();
+        switch (i % 4) {
+            case 0:
+                table.set_string(0, row, "Hello World");
+                break;
+            case 1:
+                table.set_string(0, row, "hello there");
+                break;
+            case 2:
+                table.set_string(0, row, "Goodbye");
+                break;
+            default:
+                table.set_string(0, row, realm::null());
+                break;
+        }
+    }
+    table.optimize();
+
+    CHECK_EQUAL(250, table.where().contains(0, "World").count());
+    CHECK_EQUAL(500, table.where().contains(0, "WORLD", false).count() +
+                         table.where().contains(0, "THERE", false).count());
+    CHECK_EQUAL(500, table.where().begins_with(0, "hello", false).count());
+    CHECK_EQUAL(750, table.where().not_equal(0, "Goodbye").count());
+    CHECK_EQUAL(0, table.where().contains(0, "Hello there").count());
+
+    TableView tv = table.where().contains(0, "bye").find_all(1, 20);
+    CHECK_EQUAL(5, tv.size());
+    CHECK_EQUAL(2, tv.get_source_ndx(0));
+    CHECK_EQUAL(18, tv.get_source_ndx(4));
+}
+
+
+TEST(Query_EqualInsIndexed)
+{
+    Table table;
+    table.add_column(type_String, "name", true);
+    table.add_column(type_Int, "age");
+
+    const char* names[] = {"Alice", "alice", "ALICE", "Bob", "bob", "Alicia", "Carol", "cAROL"};
+    for (size_t i = 0; i < 100; ++i) {
+        size_t row = table.add_empty_row();
+        table.set_string(0, row, names[i % 8]);
+        table.set_int(1, row, int64_t(i));
+    }
+    table.add_empty_row(); // null
+
+    for (int i = 0; i < 2; ++i) {
+        if (i == 1)
+            table.add_search_index(0);
+
+        CHECK_EQUAL(39, table.where().equal(0, "aLiCe", false).count());
+        CHECK_EQUAL(25, table.where().equal(0, "BOB", false).count());
+        CHECK_EQUAL(24, table.where().equal(0, "carol", false).count());
+        CHECK_EQUAL(0, table.where().equal(0, "alic", false).count());
+        CHECK_EQUAL(1, table.where().equal(0, realm::null(), false).count());
+        CHECK_EQUAL(20, table.where().equal(0, "ALICE", false).less(1, 50).count());
+
+        TableView tv = table.where().equal(0, "alice", false).find_all(10, 20);
+        CHECK_EQUAL(4, tv.size());
+        CHECK_EQUAL(10, tv.get_source_ndx(0));
+        CHECK_EQUAL(16, tv.get_source_ndx(1));
+        CHECK_EQUAL(17, tv.get_source_ndx(2));
+        CHECK_EQUAL(18, tv.get_source_ndx(3));
+    }
+}
+
+
 #define uY "\x0CE\x0AB"            // greek capital letter upsilon with dialytika (U+03AB)
 #define uYd "\x0CE\x0A5\x0CC\x088" // decomposed form (Y followed by two dots)
 #define uy "\x0CF\x08B"            // greek small letter upsilon with dialytika (U+03AB)
@@ -9875,4 +9949,461 @@ TEST(Query_ArrayLeafRelocate)
 }
 
 
+TEST(Query_InInteger)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+
+    Table table;
+    size_t col_int = table.add_column(type_Int, "int");
+    size_t col_null = table.add_column(type_Int, "nullable", true);
+    size_t col_indexed = table.add_column(type_Int, "indexed");
+    size_t col_other = table.add_column(type_Int, "other");
+    table.add_search_index(col_indexed);
+
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 3 + 7;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(col_int, i, random.draw_int(-50, 50));
+        if (random.draw_int_mod(5) != 0)
+            table.set_int(col_null, i, random.draw_int(-50, 50));
+        table.set_int(col_indexed, i, random.draw_int(-50, 50));
+        table.set_int(col_other, i, random.draw_int_mod(2));
+    }
+
+    std::vector<int64_t> values = {-50, 3, 3, 17, 49, -8, 1000};
+    auto in_values = [&](int64_t v) { return std::find(values.begin(), values.end(), v) != values.end(); };
+
+    for (size_t col : {col_int, col_null, col_indexed}) {
+        std::vector<size_t> expected;
+        std::vector<size_t> expected_and;
+        for (size_t i = 0; i < num_rows; ++i) {
+            if (!table.is_null(col, i) && in_values(table.get_int(col, i))) {
+                expected.push_back(i);
+                if (table.get_int(col_other, i) == 1)
+                    expected_and.push_back(i);
+            }
+        }
+
+        TableView tv = table.where().in(col, values).find_all();
+        CHECK_EQUAL(tv.size(), expected.size());
+        for (size_t i = 0; i < tv.size() && i < expected.size(); ++i)
+            CHECK_EQUAL(tv.get_source_ndx(i), expected[i]);
+
+        Query q = table.where().equal(col_other, 1).in(col, values);
+        CHECK_EQUAL(q.count(), expected_and.size());
+        tv = table.where().in(col, values).equal(col_other, 1).find_all(10, num_rows - 10);
+        size_t n = 0;
+        for (size_t row : expected_and) {
+            if (row >= 10 && row < num_rows - 10)
+                CHECK_EQUAL(tv.get_source_ndx(n++), row);
+        }
+        CHECK_EQUAL(tv.size(), n);
+
+        CHECK_EQUAL(table.where().in(col, std::vector<int64_t>()).count(), 0);
+    }
+
+    CHECK_THROW(table.where().in(col_int, std::vector<StringData>{"a"}), LogicError);
+}
+
+
+TEST(Query_InString)
+{
+    Group group;
+    TableRef table = group.add_table("table");
+    size_t col_plain = table->add_column(type_String, "plain", true);
+    size_t col_indexed = table->add_column(type_String, "indexed", true);
+    size_t col_enum = table->add_column(type_String, "enum", true);
+    table->add_search_index(col_indexed);
+
+    const char* strings[] = {"foo", "bar", "baz", "", "\xe6\xf8\xe5", "foobar", "Foo"};
+    const size_t num_rows = REALM_MAX_BPNODE_SIZE * 2 + 3;
+    table->add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        for (size_t col : {col_plain, col_indexed, col_enum}) {
+            size_t n = (i * 7 + col) % 8;
+            table->set_string(col, i, n < 7 ? StringData(strings[n]) : StringData());
+        }
+    }
+    table->optimize(true);
+    CHECK_EQUAL(table->get_column_type(col_enum), type_String);
+
+    std::vector<StringData> values = {"foo", "", "\xe6\xf8\xe5", "missing", "foo"};
+    for (bool with_null : {false, true}) {
+        if (with_null)
+            values.push_back(StringData());
+        for (size_t col : {col_plain, col_indexed, col_enum}) {
+            std::vector<size_t> expected;
+            for (size_t i = 0; i < num_rows; ++i) {
+                StringData value = table->get_string(col, i);
+                if (std::find(values.begin(), values.end(), value) != values.end())
+                    expected.push_back(i);
+            }
+            TableView tv = table->where().in(col, values).find_all();
+            CHECK_EQUAL(tv.size(), expected.size());
+            for (size_t i = 0; i < tv.size() && i < expected.size(); ++i)
+                CHECK_EQUAL(tv.get_source_ndx(i), expected[i]);
+        }
+    }
+}
+
+
+TEST(Query_OrManyConditions)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+
+    Table table;
+    size_t col_a = table.add_column(type_Int, "a");
+    size_t col_b = table.add_column(type_Int, "b");
+    size_t col_s = table.add_column(type_String, "s");
+
+    const size_t num_rows = 5000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(col_a, i, random.draw_int_mod(100));
+        table.set_int(col_b, i, random.draw_int_mod(3));
+        std::string s = util::to_string(random.draw_int_mod(20));
+        table.set_string(col_s, i, s);
+    }
+
+    // Twenty equal conditions, one of them with a nested AND and one on another column
+    Query q = table.where().equal(col_b, 1).group();
+    for (int64_t v = 0; v < 18; ++v)
+        q.equal(col_a, v * 5).Or();
+    q.group().equal(col_a, 1).equal(col_s, "7").end_group().Or().equal(col_s, "13");
+    q.end_group();
+
+    auto matches = [&](size_t i) {
+        int64_t a = table.get_int(col_a, i);
+        StringData s = table.get_string(col_s, i);
+        bool any = (a % 5 == 0 && a < 90) || (a == 1 && s == "7") || s == "13";
+        return table.get_int(col_b, i) == 1 && any;
+    };
+
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (matches(i))
+            expected.push_back(i);
+    }
+
+    TableView tv = q.find_all();
+    CHECK_EQUAL(tv.size(), expected.size());
+    for (size_t i = 0; i < tv.size() && i < expected.size(); ++i)
+        CHECK_EQUAL(tv.get_source_ndx(i), expected[i]);
+    CHECK_EQUAL(q.count(), expected.size());
+
+    for (int i = 0; i < 20; ++i) {
+        size_t start = random.draw_int_max(num_rows);
+        size_t end = start + random.draw_int_max(num_rows - start);
+        size_t limit = random.draw_int_max(100);
+        tv = q.find_all(start, end, limit);
+        size_t n = 0;
+        for (size_t row : expected) {
+            if (row >= start && row < end && n < limit)
+                CHECK_EQUAL(tv.get_source_ndx(n++), row);
+        }
+        CHECK_EQUAL(tv.size(), n);
+        if (!expected.empty()) {
+            size_t begin = random.draw_int_max(num_rows);
+            auto it = std::lower_bound(expected.begin(), expected.end(), begin);
+            CHECK_EQUAL(q.find(begin), it == expected.end() ? not_found : *it);
+        }
+    }
+}
+
+
+namespace {
+
+// Checks find_all() and count() of `q` against `matches`, evaluated on each of the first `num_rows` rows, and
+// count() and find() on random ranges that do not line up with leaves or blocks. Returns the matching rows.
+std::vector<size_t> check_query_results(test_util::unit_test::TestContext& test_context, Random& random, Query q,
+                                        size_t num_rows, const std::function<bool(size_t)>& matches)
+{
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (matches(i))
+            expected.push_back(i);
+    }
+
+    TableView tv = q.find_all();
+    CHECK_EQUAL(tv.size(), expected.size());
+    for (size_t i = 0; i < tv.size() && i < expected.size(); ++i)
+        CHECK_EQUAL(tv.get_source_ndx(i), expected[i]);
+    CHECK_EQUAL(q.count(), expected.size());
+
+    for (int i = 0; i < 5; ++i) {
+        size_t start = random.draw_int_max(num_rows);
+        size_t end = start + random.draw_int_max(num_rows - start);
+        size_t n = std::lower_bound(expected.begin(), expected.end(), end) -
+                   std::lower_bound(expected.begin(), expected.end(), start);
+        CHECK_EQUAL(q.count(start, end), n);
+        auto it = std::lower_bound(expected.begin(), expected.end(), start);
+        CHECK_EQUAL(q.find(start), it == expected.end() ? not_found : *it);
+    }
+    return expected;
+}
+
+} // anonymous namespace
+
+
+TEST(Query_ExpressionBlocks)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    size_t col_a = table.add_column(type_Int, "a");
+    size_t col_b = table.add_column(type_Int, "b", true);
+    size_t col_c = table.add_column(type_Int, "c");
+    size_t col_d = table.add_column(type_Double, "d", true);
+    size_t col_s = table.add_column(type_String, "s");
+
+    // Enough rows to span several leaves and many blocks, and a count that is not a multiple of the block size
+    const size_t num_rows = 5 * REALM_MAX_BPNODE_SIZE + 37;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(col_a, i, random.draw_int_mod(100) - 50);
+        if (random.draw_int_mod(4) != 0)
+            table.set_int(col_b, i, random.draw_int_mod(100));
+        else
+            table.set_null(col_b, i);
+        table.set_int(col_c, i, random.draw_int_mod(200) - 50);
+        if (random.draw_int_mod(4) != 0)
+            table.set_double(col_d, i, random.draw_int_mod(100) / 4.0);
+        else
+            table.set_null(col_d, i);
+        table.set_string(col_s, i, random.draw_int_mod(2) ? "x" : "y");
+    }
+
+    auto check = [&](Query q, std::function<bool(size_t)> matches) {
+        check_query_results(test_context, random, q, num_rows, matches);
+    };
+
+    auto a = [&](size_t i) { return table.get_int(col_a, i); };
+    auto c = [&](size_t i) { return table.get_int(col_c, i); };
+    auto b_is_null = [&](size_t i) { return table.is_null(col_b, i); };
+    auto d_is_null = [&](size_t i) { return table.is_null(col_d, i); };
+
+    check(table.column<Int>(col_a) * 2 + table.column<Int>(col_b) > table.column<Int>(col_c),
+          [&](size_t i) { return !b_is_null(i) && a(i) * 2 + table.get_int(col_b, i) > c(i); });
+    check(table.column<Int>(col_a) - table.column<Int>(col_c) <= 3,
+          [&](size_t i) { return a(i) - c(i) <= 3; });
+    check(table.column<Int>(col_b) == null(), b_is_null);
+    check(table.column<Double>(col_d) * table.column<Int>(col_a) >= table.column<Int>(col_c), [&](size_t i) {
+        return !d_is_null(i) && table.get_double(col_d, i) * a(i) >= double(c(i));
+    });
+
+    // As a second condition, the expression is tested on scattered rows only
+    check(table.where().equal(col_s, "x").and_query(table.column<Int>(col_a) + 10 < table.column<Int>(col_c)),
+          [&](size_t i) { return table.get_string(col_s, i) == "x" && a(i) + 10 < c(i); });
+
+    // The matches remembered from a previous search must not survive changes to the table
+    Query q = table.column<Int>(col_a) > table.column<Int>(col_c);
+    q.find();
+    for (size_t i = 0; i < num_rows; i += 3)
+        table.set_int(col_a, i, c(i) + 1);
+    size_t count = 0;
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (a(i) > c(i))
+            ++count;
+    }
+    CHECK_EQUAL(q.count(), count);
+}
+
+
+TEST(Query_AndBlocks)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    size_t col_a = table.add_column(type_Int, "a");
+    size_t col_b = table.add_column(type_Int, "b", true);
+    size_t col_f = table.add_column(type_Float, "f", true);
+    size_t col_d = table.add_column(type_Double, "d");
+    size_t col_s = table.add_column(type_String, "s");
+
+    const size_t num_rows = 5 * REALM_MAX_BPNODE_SIZE + 37;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(col_a, i, random.draw_int_mod(100) - 50);
+        if (random.draw_int_mod(4) != 0)
+            table.set_int(col_b, i, random.draw_int_mod(100));
+        else
+            table.set_null(col_b, i);
+        if (random.draw_int_mod(4) != 0)
+            table.set_float(col_f, i, random.draw_int_mod(100) / 4.0f);
+        else
+            table.set_null(col_f, i);
+        table.set_double(col_d, i, random.draw_int_mod(100) / 8.0);
+        table.set_string(col_s, i, random.draw_int_mod(3) ? "x" : "y");
+    }
+
+    auto check = [&](Query q, std::function<bool(size_t)> matches) {
+        std::vector<size_t> expected = check_query_results(test_context, random, q, num_rows, matches);
+        int64_t sum = 0;
+        for (size_t row : expected)
+            sum += table.get_int(col_a, row);
+        CHECK_EQUAL(q.sum_int(col_a), sum);
+        CHECK_EQUAL(q.find_all(0, size_t(-1), 10).size(), std::min<size_t>(expected.size(), 10));
+    };
+
+    auto a = [&](size_t i) { return table.get_int(col_a, i); };
+    auto b = [&](size_t i) -> util::Optional<int64_t> {
+        return table.is_null(col_b, i) ? util::none : util::some<int64_t>(table.get_int(col_b, i));
+    };
+    auto f = [&](size_t i) -> util::Optional<float> {
+        return table.is_null(col_f, i) ? util::none : util::some<float>(table.get_float(col_f, i));
+    };
+    auto d = [&](size_t i) { return table.get_double(col_d, i); };
+    auto s = [&](size_t i) { return table.get_string(col_s, i) == "x"; };
+
+    check(table.where().greater(col_a, 0).less(col_b, 50), [&](size_t i) { return a(i) > 0 && b(i) && *b(i) < 50; });
+    check(table.where().equal(col_b, null()).not_equal(col_a, 3), [&](size_t i) { return !b(i) && a(i) != 3; });
+    check(table.where().less(col_d, 5.0).greater_equal(col_f, 10.0f).equal(col_a, -7),
+          [&](size_t i) { return d(i) < 5.0 && f(i) && *f(i) >= 10.0f && a(i) == -7; });
+    check(table.where().equal(col_f, null()).greater(col_d, 6.0), [&](size_t i) { return !f(i) && d(i) > 6.0; });
+    check(table.where().equal(col_s, "x").less_equal(col_a, 10), [&](size_t i) { return s(i) && a(i) <= 10; });
+
+    // Enumerated strings compare keys, and an index takes the string condition out of the block matching
+    table.optimize();
+    check(table.where().equal(col_s, "y").greater(col_b, 20), [&](size_t i) { return !s(i) && b(i) && *b(i) > 20; });
+    check(table.where().greater(col_b, 20).equal(col_s, "z"), [](size_t) { return false; });
+    table.add_search_index(col_s);
+    check(table.where().equal(col_s, "x").greater(col_d, 3.0), [&](size_t i) { return s(i) && d(i) > 3.0; });
+}
+
+
+TEST(Query_TimestampRange)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    size_t col_ts = table.add_column(type_Timestamp, "ts", true);
+    size_t col_int = table.add_column(type_Int, "int");
+
+    // Few distinct seconds, so that many rows share the seconds of the bounds, and nanoseconds that are mostly 0
+    const size_t num_rows = 4 * REALM_MAX_BPNODE_SIZE + 11;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (random.draw_int_mod(10) == 0) {
+            table.set_null(col_ts, i);
+        }
+        else {
+            int64_t seconds = random.draw_int_mod(21) - 10;
+            int32_t nanoseconds = random.draw_int_mod(3) == 0 ? int32_t(random.draw_int_mod(3) * 100) : 0;
+            table.set_timestamp(col_ts, i, Timestamp(seconds, seconds < 0 ? -nanoseconds : nanoseconds));
+        }
+        table.set_int(col_int, i, random.draw_int_mod(3));
+    }
+
+    auto check = [&](Query q, std::function<bool(Timestamp)> matches) {
+        auto row_matches = [&](size_t i) {
+            Timestamp ts = table.get_timestamp(col_ts, i);
+            return !ts.is_null() && matches(ts);
+        };
+        check_query_results(test_context, random, q, num_rows, row_matches);
+
+        // Matched in blocks together with another condition
+        check_query_results(test_context, random, q.equal(col_int, 1), num_rows,
+                            [&](size_t i) { return row_matches(i) && table.get_int(col_int, i) == 1; });
+    };
+
+    Timestamp bounds[] = {Timestamp(0, 0),     Timestamp(3, 0),     Timestamp(3, 100), Timestamp(3, 150),
+                          Timestamp(-4, 0),    Timestamp(-4, -100), Timestamp(-4, -300), Timestamp(-20, 0),
+                          Timestamp(20, 0)};
+    for (Timestamp v : bounds) {
+        check(table.where().greater(col_ts, v), [&](Timestamp ts) { return ts > v; });
+        check(table.where().greater_equal(col_ts, v), [&](Timestamp ts) { return ts >= v; });
+        check(table.where().less(col_ts, v), [&](Timestamp ts) { return ts < v; });
+        check(table.where().less_equal(col_ts, v), [&](Timestamp ts) { return ts <= v; });
+    }
+    check(table.where().between(col_ts, Timestamp(-4, -100), Timestamp(3, 100)),
+          [&](Timestamp ts) { return ts >= Timestamp(-4, -100) && ts <= Timestamp(3, 100); });
+    check(table.where().between(col_ts, Timestamp(3, 100), Timestamp(-4, -100)), [](Timestamp) { return false; });
+
+    // Bounds at the ends of the range of seconds
+    int64_t min = std::numeric_limits<int64_t>::min();
+    int64_t max = std::numeric_limits<int64_t>::max();
+    check(table.where().greater_equal(col_ts, Timestamp(min, 0)), [](Timestamp) { return true; });
+    check(table.where().less_equal(col_ts, Timestamp(max, 0)), [](Timestamp) { return true; });
+    check(table.where().less(col_ts, Timestamp(min, 0)), [](Timestamp) { return false; });
+    check(table.where().greater(col_ts, Timestamp(max, 0)), [](Timestamp) { return false; });
+}
+
+
+TEST(Query_ResultCache)
+{
+    Table table;
+    size_t col_int = table.add_column(type_Int, "int");
+    size_t col_double = table.add_column(type_Double, "double");
+    size_t col_str = table.add_column(type_String, "str", true);
+    table.add_empty_row(100);
+    for (size_t i = 0; i < 100; ++i) {
+        table.set_int(col_int, i, i % 10);
+        table.set_double(col_double, i, i / 2.0);
+        table.set_string(col_str, i, i % 3 ? "a" : "b");
+    }
+
+    CHECK(!table.get_query_cache());
+    table.enable_query_cache(8);
+    const QueryCache& cache = *table.get_query_cache();
+
+    // Queries built separately with the same conditions share results
+    CHECK_EQUAL(table.where().greater(col_int, 5).equal(col_str, "a").count(), 26);
+    CHECK_EQUAL(cache.hits(), 0);
+    CHECK_EQUAL(table.where().greater(col_int, 5).equal(col_str, "a").count(), 26);
+    CHECK_EQUAL(cache.hits(), 1);
+
+    // Other values, conditions, arguments and operations have results of their own
+    CHECK_EQUAL(table.where().greater(col_int, 6).equal(col_str, "a").count(), 20);
+    CHECK_EQUAL(table.where().greater_equal(col_int, 5).equal(col_str, "a").count(), 33);
+    CHECK_EQUAL(table.where().greater(col_int, 5).equal(col_str, "a").count(0, 50), 13);
+    CHECK_EQUAL(table.where().greater(col_int, 5).equal(col_str, "a").sum_int(col_int), 195);
+    CHECK_EQUAL(table.where().greater(col_int, 5).equal(col_str, "a").maximum_double(col_double), 49.0);
+    CHECK_EQUAL(table.where().greater(col_int, 5).equal(col_str, "a").find_all().size(), 26);
+    CHECK_EQUAL(cache.hits(), 1);
+    CHECK_EQUAL(cache.size(), 7);
+
+    size_t count = 0;
+    size_t ndx = not_found;
+    CHECK_EQUAL(table.where().greater(col_int, 5).equal(col_str, "a").maximum_double(col_double, &count, 0, size_t(-1),
+                                                                                       size_t(-1), &ndx),
+                49.0);
+    CHECK_EQUAL(count, 26);
+    CHECK_EQUAL(ndx, 98);
+    TableView tv = table.where().greater(col_int, 5).equal(col_str, "a").find_all();
+    CHECK_EQUAL(tv.size(), 26);
+    CHECK_EQUAL(tv.get_source_ndx(0), 7);
+    CHECK_EQUAL(cache.hits(), 3);
+
+    // Changing the table invalidates all results
+    table.set_string(col_str, 98, "b");
+    CHECK_EQUAL(table.where().greater(col_int, 5).equal(col_str, "a").count(), 25);
+    CHECK_EQUAL(cache.size(), 1);
+    tv.sync_if_needed();
+    CHECK_EQUAL(tv.size(), 25);
+    CHECK_EQUAL(cache.hits(), 3);
+
+    // The least recently used results make room for new ones
+    for (int64_t i = 0; i < 10; ++i) {
+        CHECK_EQUAL(table.where().greater(col_int, 5).equal(col_str, "a").count(), 25);
+        CHECK_EQUAL(table.where().equal(col_int, i).count(), 10);
+    }
+    CHECK_EQUAL(cache.size(), 8);
+    CHECK_EQUAL(cache.hits(), 13);
+    CHECK_EQUAL(table.where().equal(col_int, 9).count(), 10);
+    CHECK_EQUAL(table.where().equal(col_int, 3).count(), 10);
+    CHECK_EQUAL(cache.hits(), 15);
+    CHECK_EQUAL(table.where().equal(col_int, 2).count(), 10);
+    CHECK_EQUAL(cache.hits(), 15);
+
+    // Query expressions and queries restricted by a view are not cached
+    size_t hits = cache.hits();
+    for (int i = 0; i < 2; ++i) {
+        CHECK_EQUAL((table.column<Int>(col_int) + 1 > 6).count(), 40);
+        CHECK_EQUAL(table.where(&tv).greater(col_int, 7).count(), 12);
+    }
+    CHECK_EQUAL(cache.hits(), hits);
+
+    table.disable_query_cache();
+    CHECK(!table.get_query_cache());
+    CHECK_EQUAL(table.where().greater(col_int, 5).equal(col_str, "a").count(), 25);
+}
+
+
 #endif // TEST_QUERY
@@ -19,6 +19,7 @@
 #include "testsettings.hpp"
 #ifdef TEST_SHARED
 
+#include <sstream>
 #include <streambuf>
 #include <fstream>
 #include <tuple>
@@ -2773,6 +2774,79 @@ TEST(Shared_CompactEmpty)
 }
 
 
+TEST(Shared_Increment)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(backup_path);
+    SharedGroup sg(path);
+    {
+        WriteTransaction wt(sg);
+        TableRef table = wt.add_table("table");
+        table->add_column(type_Int, "int");
+        table->add_column(type_String, "string");
+        table->add_empty_row(20000);
+        for (size_t i = 0; i < table->size(); ++i) {
+            table->set_int(0, i, int64_t(i) * 7919);
+            std::string str(i % 30, 'x');
+            table->set_string(1, i, str);
+        }
+        wt.commit();
+    }
+    CHECK_LOGIC_ERROR(sg.write_increment(std::cout), LogicError::wrong_transact_state);
+
+    // A full backup, and the version that the next increment is based on
+    std::stringstream full;
+    SharedGroup::VersionID base;
+    {
+        ReadTransaction rt(sg);
+        sg.write_increment(full);
+        base = sg.pin_version();
+    }
+    SharedGroup::apply_increment(full, backup_path);
+    {
+        Group backup(backup_path);
+        ReadTransaction rt(sg);
+        CHECK(backup == rt.get_group());
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        WriteTransaction wt(sg);
+        wt.get_table("table")->set_int(0, 5000 + i, -1);
+        TableRef other = wt.get_or_add_table("other");
+        if (other->get_column_count() == 0)
+            other->add_column(type_Int, "int");
+        other->add_empty_row();
+        wt.commit();
+    }
+    std::stringstream increment;
+    {
+        ReadTransaction rt(sg);
+        sg.write_increment(increment, base);
+        sg.unpin_version(base);
+        CHECK_LESS(increment.str().size(), full.str().size() / 10);
+    }
+    SharedGroup::apply_increment(increment, backup_path);
+    {
+        Group backup(backup_path);
+        ReadTransaction rt(sg);
+        CHECK(backup == rt.get_group());
+        CHECK_EQUAL(-1, backup.get_table("table")->get_int(0, 5002));
+#ifdef REALM_DEBUG
+        backup.verify();
+#endif
+    }
+    {
+        SharedGroup backup_sg(backup_path);
+        WriteTransaction wt(backup_sg);
+        wt.get_table("table")->set_int(0, 0, 1);
+        wt.commit();
+    }
+
+    std::istringstream bad("T-DBINC2");
+    CHECK_THROW(SharedGroup::apply_increment(bad, backup_path), std::runtime_error);
+}
+
+
 TEST(Shared_VersionOfBoundSnapshot)
 {
     SHARED_GROUP_TEST_PATH(path);
@@ -312,6 +312,37 @@ TEST(StringData_Like)
     CHECK(foobarfoo.like("?oo*?oo"));
 }
 
+TEST(StringData_Like_Segments)
+{
+    // Consecutive wildcards, and patterns that used to require backtracking
+    CHECK(StringData("").like("**"));
+    CHECK(StringData("a").like("**a"));
+    CHECK(!StringData("a").like("**ab?"));
+    CHECK(StringData("abab").like("*b?b"));
+    CHECK(!StringData("abab").like("*ab?"));
+    CHECK(StringData("aaab").like("*a?b"));
+    CHECK(!StringData("aab").like("a*ab*b"));
+    CHECK(StringData("aabb").like("a*ab*b"));
+    CHECK(StringData("abc").like("a**?*c"));
+    CHECK(!StringData("ac").like("a*?*c"));
+
+    // Segments found at, and across the edges of 16-byte blocks
+    std::string text(40, 'x');
+    text.replace(14, 4, "abcd");
+    text.replace(35, 3, "efg");
+    StringData sd(text);
+    CHECK(sd.like("*abcd*efg*"));
+    CHECK(sd.like("x*bc*fg??"));
+    CHECK(sd.like("*b?d*e?g*"));
+    CHECK(!sd.like("*efg*abcd*"));
+    CHECK(!sd.like("*abcd*efg"));
+
+    CHECK(string_like_ins(sd, "*ABCD*EFG*"));
+    CHECK(string_like_ins(sd, "X*BC*fG??"));
+    CHECK(!string_like_ins(sd, "*EFG*ABCD*"));
+}
+
+
 TEST(StringData_Like_CaseInsensitive)
 {
     StringData null = realm::null();
@@ -444,6 +475,41 @@ TEST(StringData_Substrings)
 }
 
 
+TEST(StringData_Contains_Long)
+{
+    // Exercise the block-wise candidate filter near block boundaries
+    std::string haystack;
+    for (size_t i = 0; i < 100; ++i)
+        haystack += char('a' + i % 7);
+
+    StringData sd(haystack);
+    for (size_t begin = 0; begin < haystack.size(); ++begin) {
+        for (size_t size = 1; size < 20 && begin + size <= haystack.size(); ++size) {
+            std::string needle = haystack.substr(begin, size);
+            CHECK(sd.contains(needle));
+            needle.back() = 'x';
+            CHECK(!sd.contains(needle));
+        }
+    }
+    std::string longer = haystack + "a";
+    CHECK(!sd.contains(longer));
+    StringData alphabet = StringData("abcdefghijklmnopqrstuvwxyz0123456789").substr(0, 19);
+    CHECK(alphabet.contains("rs"));
+    CHECK(!alphabet.contains("st"));
+    CHECK(StringData("xy").contains("y"));
+    CHECK(!StringData("xy").contains("yx"));
+
+    // Case insensitive search
+    std::string text = haystack + "HelloWorld" + haystack;
+    size_t pos = search_case_fold(text, "HELLOWORLD", "helloworld", 10);
+    CHECK_EQUAL(haystack.size(), pos);
+    pos = search_case_fold(text, "HELLOWORLDS", "helloworlds", 11);
+    CHECK_EQUAL(text.size(), pos);
+    pos = search_case_fold(text, "", "", 0);
+    CHECK_EQUAL(0, pos);
+}
+
+
 TEST(StringData_STL_String)
 {
     const char* pre = "hilbert";
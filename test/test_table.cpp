@@ -24,8 +24,11 @@
 #include <string>
 #include <fstream>
 #include <ostream>
+#include <sstream>
 
 #include <realm.hpp>
+#include <realm/arrow.hpp>
+#include <realm/group_by.hpp>
 #include <realm/history.hpp>
 #include <realm/lang_bind_helper.hpp>
 #include <realm/util/buffer.hpp>
@@ -3972,6 +3975,309 @@ TEST(Table_Pivot)
 }
 
 
+TEST(Table_GroupBy)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    size_t col_str = table.add_column(type_String, "str", true);
+    size_t col_int = table.add_column(type_Int, "int");
+    size_t col_null_int = table.add_column(type_Int, "null_int", true);
+    size_t col_float = table.add_column(type_Float, "float", true);
+    size_t col_double = table.add_column(type_Double, "double");
+    size_t col_ts = table.add_column(type_Timestamp, "ts", true);
+    size_t col_bool = table.add_column(type_Bool, "bool");
+
+    const char* strings[] = {"a", "bb", "ccc", nullptr};
+    const size_t num_rows = 3 * REALM_MAX_BPNODE_SIZE + 17;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_string(col_str, i, strings[random.draw_int_mod(4)]);
+        table.set_int(col_int, i, random.draw_int_mod(7) - 3);
+        if (random.draw_int_mod(3))
+            table.set_int(col_null_int, i, random.draw_int_mod(1000));
+        else
+            table.set_null(col_null_int, i);
+        if (random.draw_int_mod(3))
+            table.set_float(col_float, i, random.draw_int_mod(100) / 4.0f);
+        else
+            table.set_null(col_float, i);
+        table.set_double(col_double, i, random.draw_int_mod(100) / 8.0);
+        if (random.draw_int_mod(3))
+            table.set_timestamp(col_ts, i, Timestamp(random.draw_int_mod(1000), 0));
+        else
+            table.set_timestamp(col_ts, i, Timestamp{});
+        table.set_bool(col_bool, i, random.draw_bool());
+    }
+
+    std::vector<GroupByAggregate> aggregates = {
+        {Table::aggr_count, 0},          {Table::aggr_sum, col_null_int},  {Table::aggr_avg, col_null_int},
+        {Table::aggr_min, col_float},    {Table::aggr_max, col_double},    {Table::aggr_sum, col_float},
+        {Table::aggr_max, col_ts},       {Table::aggr_min, col_int},
+    };
+
+    // Checks `result` against aggregates of the rows of `rows` computed here, for each of its groups
+    auto check = [&](const GroupByResult& result, const std::vector<size_t>& keys, const std::vector<size_t>& rows) {
+        auto same_key = [&](size_t group, size_t row) {
+            for (size_t k = 0; k < keys.size(); ++k) {
+                size_t col = keys[k];
+                bool null = table.is_nullable(col) && table.is_null(col, row);
+                if (null != result.is_key_null(k, group))
+                    return false;
+                if (null)
+                    continue;
+                Mixed key = result.get_key(k, group);
+                if (key.get_type() != table.get_column_type(col))
+                    return false;
+                switch (key.get_type()) {
+                    case type_String:
+                        if (key.get_string() != table.get_string(col, row))
+                            return false;
+                        break;
+                    case type_Int:
+                        if (key.get_int() != table.get_int(col, row))
+                            return false;
+                        break;
+                    case type_Bool:
+                        if (key.get_bool() != table.get_bool(col, row))
+                            return false;
+                        break;
+                    default:
+                        return false;
+                }
+            }
+            return true;
+        };
+
+        size_t total = 0;
+        size_t next_first_row = 0;
+        for (size_t group = 0; group < result.size(); ++group) {
+            size_t count = 0;
+            int64_t sum_null_int = 0;
+            size_t count_null_int = 0;
+            float min_float = 0;
+            size_t count_float = 0;
+            double sum_float = 0;
+            double max_double = 0;
+            Timestamp max_ts;
+            int64_t min_int = 0;
+            size_t first_row = npos;
+            for (size_t r = 0; r < rows.size(); ++r) {
+                size_t row = rows[r];
+                if (!same_key(group, row))
+                    continue;
+                if (first_row == npos)
+                    first_row = r;
+                if (!table.is_null(col_null_int, row)) {
+                    sum_null_int += table.get_int(col_null_int, row);
+                    ++count_null_int;
+                }
+                if (!table.is_null(col_float, row)) {
+                    float f = table.get_float(col_float, row);
+                    if (count_float++ == 0 || f < min_float)
+                        min_float = f;
+                    sum_float += f;
+                }
+                double d = table.get_double(col_double, row);
+                if (count == 0 || d > max_double)
+                    max_double = d;
+                Timestamp ts = table.get_timestamp(col_ts, row);
+                if (!ts.is_null() && (max_ts.is_null() || ts > max_ts))
+                    max_ts = ts;
+                int64_t i = table.get_int(col_int, row);
+                if (count == 0 || i < min_int)
+                    min_int = i;
+                ++count;
+            }
+            total += count;
+
+            // Groups are ordered by their first row
+            CHECK_GREATER_EQUAL(first_row, next_first_row);
+            next_first_row = first_row + 1;
+
+            CHECK_EQUAL(result.get_aggregate_type(0), type_Int);
+            CHECK_EQUAL(result.get_int(0, group), int64_t(count));
+            CHECK_EQUAL(result.get_int(1, group), sum_null_int);
+            CHECK_EQUAL(result.is_null(2, group), count_null_int == 0);
+            if (count_null_int)
+                CHECK_APPROXIMATELY_EQUAL(result.get_double(2, group), double(sum_null_int) / count_null_int, 1e-9);
+            CHECK_EQUAL(result.is_null(3, group), count_float == 0);
+            if (count_float)
+                CHECK_EQUAL(result.get_double(3, group), min_float);
+            CHECK_EQUAL(result.get_double(4, group), max_double);
+            CHECK_APPROXIMATELY_EQUAL(result.get_double(5, group), sum_float, 1e-9);
+            CHECK_EQUAL(result.get_aggregate_type(6), type_Timestamp);
+            CHECK_EQUAL(result.is_null(6, group), max_ts.is_null());
+            if (!max_ts.is_null())
+                CHECK(result.get_timestamp(6, group) == max_ts);
+            CHECK_EQUAL(result.get_int(7, group), min_int);
+        }
+        CHECK_EQUAL(total, rows.size());
+    };
+
+    std::vector<size_t> all_rows(num_rows);
+    for (size_t i = 0; i < num_rows; ++i)
+        all_rows[i] = i;
+
+    // Strings, then enumerated strings, as the only key
+    for (int i = 0; i < 2; ++i) {
+        GroupByResult result = table.group_by({col_str}, aggregates);
+        CHECK_EQUAL(result.size(), 4);
+        CHECK_EQUAL(result.get_key_count(), 1);
+        CHECK_EQUAL(result.get_aggregate_count(), aggregates.size());
+        check(result, {col_str}, all_rows);
+        table.optimize();
+    }
+
+    // A single integer key, several keys, and no keys at all
+    check(table.group_by({col_int}, aggregates), {col_int}, all_rows);
+    check(table.group_by({col_bool, col_str, col_int}, aggregates), {col_bool, col_str, col_int}, all_rows);
+    GroupByResult everything = table.group_by({}, aggregates);
+    CHECK_EQUAL(everything.size(), 1);
+    check(everything, {}, all_rows);
+
+    // Rows of queries and views
+    Query q = table.where().greater(col_int, 0).equal(col_bool, true);
+    TableView tv = q.find_all();
+    std::vector<size_t> view_rows;
+    for (size_t i = 0; i < tv.size(); ++i)
+        view_rows.push_back(tv.get_source_ndx(i));
+    check(q.group_by({col_str, col_null_int}, aggregates), {col_str, col_null_int}, view_rows);
+    tv.sort(col_double);
+    view_rows.clear();
+    for (size_t i = 0; i < tv.size(); ++i)
+        view_rows.push_back(tv.get_source_ndx(i));
+    check(tv.group_by({col_int}, aggregates), {col_int}, view_rows);
+
+    // Results keep their own copies of string keys
+    GroupByResult copy = table.group_by({col_str}, {{Table::aggr_count, 0}});
+    table.clear();
+    size_t rows = 0;
+    for (size_t group = 0; group < copy.size(); ++group) {
+        rows += size_t(copy.get_int(0, group));
+        if (!copy.is_key_null(0, group))
+            CHECK(copy.get_key(0, group).get_string() == "a" || copy.get_key(0, group).get_string() == "bb" ||
+                  copy.get_key(0, group).get_string() == "ccc");
+    }
+    CHECK_EQUAL(rows, num_rows);
+
+    CHECK_LOGIC_ERROR(table.group_by({7}, {}), LogicError::column_index_out_of_range);
+    CHECK_LOGIC_ERROR(table.group_by({}, {{Table::aggr_sum, col_str}}), LogicError::illegal_type);
+    CHECK_LOGIC_ERROR(table.group_by({}, {{Table::aggr_avg, col_ts}}), LogicError::illegal_type);
+}
+
+
+TEST(Table_GroupByParallel)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    size_t col_str = table.add_column(type_String, "str");
+    size_t col_int = table.add_column(type_Int, "int");
+    size_t col_null_int = table.add_column(type_Int, "null_int", true);
+    size_t col_double = table.add_column(type_Double, "double");
+    size_t col_ts = table.add_column(type_Timestamp, "ts", true);
+
+    // Keys first seen in late rows, to check that merged groups keep the order of their first rows
+    const char* strings[] = {"a", "bb", "ccc", "dddd", "late"};
+    const size_t num_rows = 9 * REALM_MAX_BPNODE_SIZE + 17;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        size_t n = i < num_rows / 2 ? 4 : 5;
+        table.set_string(col_str, i, strings[random.draw_int_mod(n)]);
+        table.set_int(col_int, i, random.draw_int_mod(1000) - 500);
+        if (random.draw_int_mod(4))
+            table.set_int(col_null_int, i, random.draw_int_mod(10));
+        else
+            table.set_null(col_null_int, i);
+        table.set_double(col_double, i, random.draw_int_mod(1000) / 8.0);
+        if (random.draw_int_mod(4))
+            table.set_timestamp(col_ts, i, Timestamp(random.draw_int_mod(1000), 0));
+        else
+            table.set_timestamp(col_ts, i, Timestamp{});
+    }
+
+    std::vector<GroupByAggregate> aggregates = {
+        {Table::aggr_count, 0}, {Table::aggr_sum, col_int}, {Table::aggr_avg, col_int},  {Table::aggr_min, col_int},
+        {Table::aggr_max, col_int}, {Table::aggr_sum, col_double}, {Table::aggr_min, col_double},
+        {Table::aggr_max, col_ts}, {Table::aggr_min, col_ts},
+    };
+
+    auto check_equal = [&](const GroupByResult& a, const GroupByResult& b) {
+        CHECK_EQUAL(a.size(), b.size());
+        if (a.size() != b.size())
+            return;
+        for (size_t group = 0; group < a.size(); ++group) {
+            for (size_t k = 0; k < a.get_key_count(); ++k) {
+                CHECK_EQUAL(a.is_key_null(k, group), b.is_key_null(k, group));
+                if (!a.is_key_null(k, group))
+                    CHECK(a.get_key(k, group).get_type() == b.get_key(k, group).get_type());
+                if (!a.is_key_null(k, group) && a.get_key_type(k) == type_String)
+                    CHECK_EQUAL(a.get_key(k, group).get_string(), b.get_key(k, group).get_string());
+                else if (!a.is_key_null(k, group) && a.get_key_type(k) == type_Int)
+                    CHECK_EQUAL(a.get_key(k, group).get_int(), b.get_key(k, group).get_int());
+            }
+            for (size_t i = 0; i < a.get_aggregate_count(); ++i) {
+                CHECK_EQUAL(a.is_null(i, group), b.is_null(i, group));
+                if (a.is_null(i, group))
+                    continue;
+                switch (a.get_aggregate_type(i)) {
+                    case type_Int:
+                        CHECK_EQUAL(a.get_int(i, group), b.get_int(i, group));
+                        break;
+                    case type_Double:
+                        CHECK_APPROXIMATELY_EQUAL(a.get_double(i, group), b.get_double(i, group), 1e-9);
+                        break;
+                    case type_Timestamp:
+                        CHECK(a.get_timestamp(i, group) == b.get_timestamp(i, group));
+                        break;
+                    default:
+                        CHECK(false);
+                }
+            }
+        }
+    };
+
+    for (int i = 0; i < 2; ++i) {
+        // Strings, then enumerated strings
+        for (size_t threads : {3, 100}) {
+            check_equal(table.group_by({col_str}, aggregates), table.group_by({col_str}, aggregates, nullptr, threads));
+            check_equal(table.group_by({col_null_int}, aggregates),
+                        table.group_by({col_null_int}, aggregates, nullptr, threads));
+            check_equal(table.group_by({col_str, col_null_int}, aggregates),
+                        table.group_by({col_str, col_null_int}, aggregates, nullptr, threads));
+            check_equal(table.group_by({}, aggregates), table.group_by({}, aggregates, nullptr, threads));
+
+            Query q = table.where().greater(col_int, -200).equal(col_str, "late");
+            check_equal(q.group_by({col_null_int}, aggregates), q.group_by({col_null_int}, aggregates, threads));
+            Query q2 = table.where().greater(col_int, 0).Or().equal(col_null_int, 3);
+            check_equal(q2.group_by({col_str}, aggregates), q2.group_by({col_str}, aggregates, threads));
+
+            TableView tv = table.where().less(col_int, 100).find_all();
+            tv.sort(col_double);
+            check_equal(tv.group_by({col_str}, aggregates), tv.group_by({col_str}, aggregates, threads));
+        }
+
+        Table sequential;
+        Table parallel;
+        table.aggregate(col_str, col_int, Table::aggr_sum, sequential);
+        table.aggregate(col_str, col_int, Table::aggr_sum, parallel, nullptr, 4);
+        CHECK(sequential == parallel);
+
+        TableView tv = table.where().greater(col_int, 0).find_all();
+        Table view_sequential;
+        Table view_parallel;
+        tv.aggregate(col_str, col_int, Table::aggr_avg, view_sequential);
+        tv.aggregate(col_str, col_int, Table::aggr_avg, view_parallel, 4);
+        CHECK_EQUAL(view_sequential.size(), view_parallel.size());
+        for (size_t r = 0; r < view_sequential.size(); ++r) {
+            CHECK_EQUAL(view_sequential.get_string(0, r), view_parallel.get_string(0, r));
+            CHECK_APPROXIMATELY_EQUAL(view_sequential.get_double(1, r), view_parallel.get_double(1, r), 1e-9);
+        }
+
+        table.optimize();
+    }
+}
+
+
 namespace {
 
 void compare_table_with_slice(TestContext& test_context, const Table& table, const Table& slice, size_t offset,
@@ -7357,4 +7663,144 @@ TEST_TYPES(Table_ColumnSizeFromRef, std::true_type, std::false_type)
 }
 
 
+TEST(Table_Arrow)
+{
+    Table table;
+    table.add_column(type_Int, "int", true);
+    table.add_column(type_Bool, "bool");
+    table.add_column(type_Float, "float", true);
+    table.add_column(type_Double, "double");
+    table.add_column(type_String, "string", true);
+    table.add_column(type_Binary, "binary");
+    table.add_column(type_Timestamp, "timestamp", true);
+    table.add_column(type_OldDateTime, "date");
+    table.add_empty_row(1000);
+    for (size_t i = 0; i < table.size(); ++i) {
+        int64_t n = int64_t(i);
+        if (i % 3 != 0)
+            table.set_int(0, i, i == 1 ? std::numeric_limits<int64_t>::min() : n * 1000000007);
+        table.set_bool(1, i, i % 5 == 1);
+        if (i % 7 != 0)
+            table.set_float(2, i, float(n) / 4);
+        table.set_double(3, i, -double(n) / 3);
+        std::string str(i % 11, char('a' + i % 26));
+        if (i % 4 != 0)
+            table.set_string(4, i, str);
+        table.set_binary(5, i, BinaryData(str.data(), str.size()));
+        int64_t seconds = n * 1000 - 500000;
+        if (i % 2 != 0)
+            table.set_timestamp(6, i, Timestamp(seconds, int32_t(seconds < 0 ? -n : n)));
+        table.set_olddatetime(7, i, OldDateTime(n * 86400));
+    }
+    table.set_string(4, 5, ""); // Empty, not null
+
+    auto check_equal = [&](const Table& expected, size_t begin, const Table& actual) {
+        CHECK_EQUAL(expected.get_column_count(), actual.get_column_count());
+        for (size_t col = 0; col < actual.get_column_count(); ++col) {
+            CHECK_EQUAL(expected.get_column_name(col), actual.get_column_name(col));
+            CHECK_EQUAL(expected.get_column_type(col), actual.get_column_type(col));
+            CHECK_EQUAL(expected.is_nullable(col), actual.is_nullable(col));
+            for (size_t row = 0; row < actual.size(); ++row) {
+                size_t expected_row = begin + row;
+                CHECK_EQUAL(expected.is_null(col, expected_row), actual.is_null(col, row));
+            }
+        }
+        for (size_t row = 0; row < actual.size(); ++row) {
+            size_t expected_row = begin + row;
+            CHECK_EQUAL(expected.get_int(0, expected_row), actual.get_int(0, row));
+            CHECK_EQUAL(expected.get_bool(1, expected_row), actual.get_bool(1, row));
+            CHECK_EQUAL(expected.get_float(2, expected_row), actual.get_float(2, row));
+            CHECK_EQUAL(expected.get_double(3, expected_row), actual.get_double(3, row));
+            CHECK_EQUAL(expected.get_string(4, expected_row), actual.get_string(4, row));
+            CHECK_EQUAL(expected.get_binary(5, expected_row), actual.get_binary(5, row));
+            if (!actual.is_null(6, row))
+                CHECK_EQUAL(expected.get_timestamp(6, expected_row), actual.get_timestamp(6, row));
+            CHECK_EQUAL(expected.get_olddatetime(7, expected_row), actual.get_olddatetime(7, row));
+        }
+    };
+
+    // Memory layout
+    ArrowBatch batch = export_arrow(table, 3, 12);
+    CHECK_EQUAL(9, batch.length);
+    CHECK_EQUAL(8, batch.columns.size());
+    const ArrowColumn& ints = batch.columns[0];
+    CHECK_EQUAL(3, ints.null_count); // Rows 3, 6 and 9
+    CHECK_EQUAL(2, ints.validity.size());
+    CHECK_EQUAL(0xb6, ints.validity[0]); // Rows 4, 5, 7, 8 and 10
+    CHECK_EQUAL(0x01, ints.validity[1]); // Row 11
+    CHECK_EQUAL(9 * 8, ints.data.size());
+    const ArrowColumn& bools = batch.columns[1];
+    CHECK_EQUAL(0, bools.null_count);
+    CHECK(bools.validity.empty());
+    CHECK_EQUAL(0x08, bools.data[0]); // Row 6
+    CHECK_EQUAL(0x01, bools.data[1]); // Row 11
+    const ArrowColumn& strings = batch.columns[4];
+    CHECK_EQUAL(10, strings.offsets.size());
+    CHECK_EQUAL(0, strings.offsets[0]);
+    CHECK_EQUAL(3, strings.offsets[1]);
+    CHECK_EQUAL(3, strings.offsets[2]); // Row 4 is null
+    CHECK_EQUAL(3, strings.offsets[3]); // Row 5 is empty
+    CHECK_EQUAL(9, strings.offsets[4]);
+    CHECK_EQUAL(strings.offsets[9], strings.data.size());
+
+    Table imported;
+    import_arrow(batch, imported);
+    CHECK_EQUAL(9, imported.size());
+    check_equal(table, 3, imported);
+    import_arrow(export_arrow(table, 12), imported);
+    CHECK_EQUAL(997, imported.size());
+    check_equal(table, 3, imported);
+
+    // Arrow file, with an incomplete last batch
+    std::stringstream file;
+    write_arrow(table, file, 300);
+    Table read;
+    CHECK_EQUAL(1000, read_arrow(file, read));
+    check_equal(table, 0, read);
+
+    // View
+    TableView view = table.where().equal(1, true).find_all();
+    view.remove(0);
+    std::stringstream view_file;
+    write_arrow(view, view_file, 7);
+    Table read_view;
+    read_view.add_column(type_Int, "int", true);
+    read_view.add_column(type_Bool, "bool");
+    read_view.add_column(type_Float, "float", true);
+    read_view.add_column(type_Double, "double");
+    read_view.add_column(type_String, "string", true);
+    read_view.add_column(type_Binary, "binary");
+    read_view.add_column(type_Timestamp, "timestamp", true);
+    read_view.add_column(type_OldDateTime, "date");
+    CHECK_EQUAL(view.size(), read_arrow(view_file, read_view));
+    CHECK_EQUAL(export_arrow(view).length, view.size());
+    for (size_t i = 0; i < view.size(); ++i) {
+        CHECK_EQUAL(view.get_int(0, i), read_view.get_int(0, i));
+        CHECK_EQUAL(view.get_string(4, i), read_view.get_string(4, i));
+    }
+
+    // Errors
+    Table other;
+    other.add_column(type_Int, "int");
+    CHECK_LOGIC_ERROR(import_arrow(batch, other), LogicError::type_mismatch);
+    ArrowBatch non_nullable = export_arrow(table, 0, 10);
+    non_nullable.columns.resize(1);
+    CHECK_LOGIC_ERROR(import_arrow(non_nullable, other), LogicError::column_not_nullable);
+    Group group;
+    TableRef links = group.add_table("links");
+    links->add_column_link(type_Link, "link", *links);
+    CHECK_LOGIC_ERROR(export_arrow(*links), LogicError::illegal_type);
+    Table timestamps;
+    timestamps.add_column(type_Timestamp, "timestamp");
+    timestamps.add_empty_row();
+    timestamps.set_timestamp(0, 0, Timestamp(std::numeric_limits<int64_t>::max() / 1000, 0));
+    CHECK_THROW(export_arrow(timestamps), std::out_of_range);
+    std::string truncated = file.str();
+    truncated.resize(truncated.size() / 2);
+    std::istringstream truncated_file(truncated);
+    Table bad;
+    CHECK_THROW(read_arrow(truncated_file, bad), std::runtime_error);
+}
+
+
 #endif // TEST_TABLE
@@ -25,6 +25,7 @@
 #include <ostream>
 #include <cwchar>
 
+#include <realm/column_string_enum.hpp>
 #include <realm/table_macros.hpp>
 
 #include "util/misc.hpp"
@@ -1565,6 +1566,163 @@ TEST(TableView_SortEnum)
 }
 
 
+TEST(TableView_SortExtractedKeys)
+{
+    Table table;
+    table.add_column(type_Int, "int", true);
+    table.add_column(type_Timestamp, "timestamp", true);
+    table.add_column(type_String, "string", true);
+    table.add_column(type_Double, "double", true);
+
+    const char* strings[] = {"b", "a", "c", "B", "A"};
+    size_t num_rows = 500;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (i % 7 != 0)
+            table.set_int(0, i, int64_t(i * 37 % 11) - 5);
+        if (i % 5 != 0)
+            table.set_timestamp(1, i, Timestamp(int64_t(i * 13 % 4), int32_t(i % 3)));
+        if (i % 6 != 0)
+            table.set_string(2, i, strings[i * 17 % 5]);
+        if (i % 9 != 0)
+            table.set_double(3, i, double(i * 31 % 13) / 4);
+    }
+    table.optimize(true);
+    CHECK(dynamic_cast<const StringEnumColumn*>(&_impl::TableFriend::get_column(table, 2)));
+
+    // Nulls sort before other values, ties are broken by the original order
+    auto check_order = [&](size_t col, bool ascending, size_t a, size_t b) -> int {
+        bool null_a = table.is_null(col, a);
+        bool null_b = table.is_null(col, b);
+        int c = 0;
+        if (null_a || null_b) {
+            c = null_a == null_b ? 0 : null_a ? -1 : 1;
+        }
+        else {
+            switch (table.get_column_type(col)) {
+                case type_Int:
+                    c = table.get_int(col, a) < table.get_int(col, b) ? -1
+                                                                      : table.get_int(col, b) < table.get_int(col, a);
+                    break;
+                case type_Timestamp:
+                    c = table.get_timestamp(col, a) < table.get_timestamp(col, b)
+                            ? -1
+                            : table.get_timestamp(col, b) < table.get_timestamp(col, a);
+                    break;
+                case type_String: {
+                    StringData sa = table.get_string(col, a);
+                    StringData sb = table.get_string(col, b);
+                    c = sa == sb ? 0 : utf8_compare(sa, sb) ? -1 : 1;
+                    break;
+                }
+                case type_Double:
+                    c = table.get_double(col, a) < table.get_double(col, b)
+                            ? -1
+                            : table.get_double(col, b) < table.get_double(col, a);
+                    break;
+                default:
+                    REALM_UNREACHABLE();
+            }
+        }
+        return ascending ? c : -c;
+    };
+
+    std::vector<std::vector<size_t>> columns = {{0}, {1}, {2}, {3}};
+    std::vector<bool> ascending = {true, false, true, false};
+    TableView tv = table.where().find_all();
+    tv.sort(SortDescriptor(table, columns, ascending));
+    CHECK_EQUAL(tv.size(), num_rows);
+    for (size_t i = 1; i < tv.size(); ++i) {
+        size_t a = tv.get_source_ndx(i - 1);
+        size_t b = tv.get_source_ndx(i);
+        int c = 0;
+        for (size_t t = 0; t < columns.size() && c == 0; ++t)
+            c = check_order(columns[t][0], ascending[t], a, b);
+        CHECK(c < 0 || (c == 0 && a < b));
+    }
+
+    // Each column on its own, in both directions
+    for (size_t col = 0; col < 4; ++col) {
+        for (bool asc : {true, false}) {
+            tv.sort(col, asc);
+            for (size_t i = 1; i < tv.size(); ++i) {
+                size_t a = tv.get_source_ndx(i - 1);
+                size_t b = tv.get_source_ndx(i);
+                CHECK(check_order(col, asc, a, b) <= 0);
+            }
+        }
+    }
+}
+
+TEST(TableView_SortWithLimit)
+{
+    Table table;
+    table.add_column(type_Int, "int");
+    table.add_column(type_Int, "group");
+    size_t num_rows = 1000;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        table.set_int(0, i, int64_t(i * 7919 % num_rows));
+        table.set_int(1, i, int64_t(i % 10));
+    }
+
+    TableView tv = table.where().find_all();
+    tv.sort(SortDescriptor(table, {{0}}), 5);
+    CHECK_EQUAL(tv.size(), 5);
+    for (size_t i = 0; i < tv.size(); ++i)
+        CHECK_EQUAL(tv.get_int(0, i), int64_t(i));
+
+    // Descending, with ties broken by the original order
+    tv = table.where().find_all();
+    tv.sort(SortDescriptor(table, {{1}}, {false}), 3);
+    CHECK_EQUAL(tv.size(), 3);
+    CHECK_EQUAL(tv.get_source_ndx(0), 9);
+    CHECK_EQUAL(tv.get_source_ndx(1), 19);
+    CHECK_EQUAL(tv.get_source_ndx(2), 29);
+
+    // A limit larger than the view sorts everything
+    tv = table.where().find_all();
+    tv.sort(SortDescriptor(table, {{0}}), num_rows + 1);
+    CHECK_EQUAL(tv.size(), num_rows);
+
+    // The limit is reapplied when the view is synced
+    TableView query_tv = table.where().greater(0, 100).find_all(SortDescriptor(table, {{0}}), 4);
+    CHECK_EQUAL(query_tv.size(), 4);
+    CHECK_EQUAL(query_tv.get_int(0, 0), 101);
+    CHECK_EQUAL(query_tv.get_int(0, 3), 104);
+    size_t row = table.add_empty_row();
+    table.set_int(0, row, 102);
+    query_tv.sync_if_needed();
+    CHECK_EQUAL(query_tv.size(), 4);
+    CHECK_EQUAL(query_tv.get_int(0, 1), 102);
+    CHECK_EQUAL(query_tv.get_int(0, 2), 102);
+    CHECK_EQUAL(query_tv.get_source_ndx(2), row);
+    CHECK_EQUAL(query_tv.get_int(0, 3), 103);
+
+    // Distinct is applied before the limit
+    query_tv.distinct(1);
+    CHECK_EQUAL(query_tv.size(), 4);
+    for (size_t i = 1; i < query_tv.size(); ++i) {
+        CHECK_LESS(query_tv.get_int(0, i - 1), query_tv.get_int(0, i));
+        for (size_t j = 0; j < i; ++j)
+            CHECK_NOT_EQUAL(query_tv.get_int(1, i), query_tv.get_int(1, j));
+    }
+
+    query_tv.sort(SortDescriptor(table, {{0}}), 0);
+    CHECK_EQUAL(query_tv.size(), 0);
+
+    // Sorting again brings back the rows removed by the earlier limit
+    query_tv.sort(SortDescriptor(table, {{0}}));
+    CHECK(query_tv.is_in_sync());
+    CHECK_EQUAL(query_tv.size(), 10);
+    TableView top_tv = table.where().greater(0, 100).find_all(SortDescriptor(table, {{0}}, {false}), 2);
+    CHECK_EQUAL(top_tv.get_int(0, 0), 999);
+    top_tv.sort(SortDescriptor(table, {{0}}), 2);
+    CHECK_EQUAL(top_tv.size(), 2);
+    CHECK_EQUAL(top_tv.get_int(0, 0), 101);
+    CHECK_EQUAL(top_tv.get_int(0, 1), 102);
+}
+
 TEST(TableView_UnderlyingRowRemoval)
 {
     struct Fixture {
@@ -2162,6 +2320,78 @@ TEST(TableView_DistinctOverNullLink)
     CHECK_EQUAL(tv.get_source_ndx(1), 1);
 }
 
+TEST(TableView_DistinctMultipleColumns)
+{
+    Table table;
+    table.add_column(type_Int, "int", true);
+    table.add_column(type_Double, "double");
+    table.add_column(type_String, "string", true);
+    table.add_column(type_Timestamp, "timestamp", true);
+    table.add_column(type_Binary, "binary");
+
+    const char* strings[] = {"a", "A", "b", "ab"};
+    size_t num_rows = 300;
+    table.add_empty_row(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (i % 4 != 0)
+            table.set_int(0, i, int64_t(i % 3));
+        table.set_double(1, i, i % 2 == 0 ? 0.0 : -0.0);
+        if (i % 5 != 0)
+            table.set_string(2, i, strings[i % 4]);
+        if (i % 7 != 0)
+            table.set_timestamp(3, i, Timestamp(int64_t(i % 2), 0));
+        table.set_binary(4, i, BinaryData(strings[i % 3], 1));
+    }
+    table.optimize(true);
+
+    // Keeps the first row of each distinct combination, in the original order
+    auto check_distinct = [&](std::vector<size_t> columns) {
+        std::vector<std::vector<size_t>> column_indices;
+        for (size_t col : columns)
+            column_indices.push_back({col});
+        TableView tv = table.where().find_all();
+        tv.distinct(SortDescriptor(table, column_indices));
+
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < num_rows; ++i) {
+            bool is_duplicate = std::any_of(expected.begin(), expected.end(), [&](size_t j) {
+                return std::all_of(columns.begin(), columns.end(), [&](size_t col) {
+                    if (table.is_null(col, i) || table.is_null(col, j))
+                        return table.is_null(col, i) == table.is_null(col, j);
+                    switch (table.get_column_type(col)) {
+                        case type_Int:
+                            return table.get_int(col, i) == table.get_int(col, j);
+                        case type_Double:
+                            return table.get_double(col, i) == table.get_double(col, j);
+                        case type_String:
+                            return table.get_string(col, i) == table.get_string(col, j);
+                        case type_Timestamp:
+                            return table.get_timestamp(col, i) == table.get_timestamp(col, j);
+                        case type_Binary:
+                            return table.get_binary(col, i) == table.get_binary(col, j);
+                        default:
+                            REALM_UNREACHABLE();
+                    }
+                });
+            });
+            if (!is_duplicate)
+                expected.push_back(i);
+        }
+        if (CHECK_EQUAL(tv.size(), expected.size())) {
+            for (size_t i = 0; i < expected.size(); ++i)
+                CHECK_EQUAL(tv.get_source_ndx(i), expected[i]);
+        }
+    };
+
+    check_distinct({0});
+    check_distinct({1});
+    check_distinct({2});
+    check_distinct({3});
+    check_distinct({0, 2});
+    check_distinct({0, 1, 2, 3});
+    check_distinct({2, 4});
+}
+
 TEST(TableView_IsRowAttachedAfterClear)
 {
     Table t;
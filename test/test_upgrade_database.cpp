@@ -296,7 +296,7 @@ TEST(Upgrade_Database_2_Backwards_Compatible)
     SharedGroup g(temp_copy, 0);
 
     using sgf = _impl::SharedGroupFriend;
-    CHECK_EQUAL(6, sgf::get_file_format_version(g));
+    CHECK_EQUAL(7, sgf::get_file_format_version(g));
 
     // First table is non-indexed for all columns, second is indexed for all columns
     for (size_t tbl = 0; tbl < 2; tbl++) {
@@ -437,7 +437,7 @@ TEST(Upgrade_Database_2_Backwards_Compatible_WriteTransaction)
     SharedGroup g(temp_copy, 0);
 
     using sgf = _impl::SharedGroupFriend;
-    CHECK_EQUAL(6, sgf::get_file_format_version(g));
+    CHECK_EQUAL(7, sgf::get_file_format_version(g));
 
     // First table is non-indexed for all columns, second is indexed for all columns
     for (size_t tbl = 0; tbl < 2; tbl++) {
@@ -792,7 +792,7 @@ TEST(Upgrade_InRealmHistory)
         {
             SharedGroup sg(temp_path, no_create);
             using sgf = _impl::SharedGroupFriend;
-            CHECK_EQUAL(6, sgf::get_file_format_version(sg));
+            CHECK_EQUAL(7, sgf::get_file_format_version(sg));
         }
         {
             std::unique_ptr<Replication> hist = make_in_realm_history(temp_path);
@@ -1153,4 +1153,54 @@ TEST(Upgrade_Database_5_6_StringIndex)
 #endif // TEST_READ_UPGRADE_MODE
 }
 
+
+// Files of version 6 have the layout of version 7 files without compressed
+// string leaves, so a version 6 file is made by relabeling a new file
+TEST(Upgrade_Database_6_7)
+{
+    SHARED_GROUP_TEST_PATH(path);
+
+    // Unique strings in the first half keep the column from being enumerated,
+    // and duplicates in the second half make its leaves worth compressing
+    auto value = [](size_t i) { return std::string(100, 'x') + to_string(i < 1000 ? i : 1000); };
+    {
+        Group g;
+        TableRef t = g.add_table("table");
+        t->add_column(type_String, "str");
+        t->add_empty_row(2000);
+        for (size_t i = 0; i < 2000; ++i) {
+            std::string str = value(i);
+            t->set_string(0, i, str);
+        }
+        g.write(path);
+    }
+    {
+        File file(path, File::mode_Update);
+        file.seek(20); // SlabAlloc::Header::m_file_format
+        const char versions[2] = {6, 6};
+        file.write(versions, 2);
+    }
+
+    // A version 6 file must be upgraded, which a Group cannot do
+    CHECK_THROW(Group(path, nullptr, Group::mode_ReadOnly), InvalidDatabase);
+
+    SharedGroup sg(path);
+    using sgf = _impl::SharedGroupFriend;
+    CHECK_EQUAL(7, sgf::get_file_format_version(sg));
+    {
+        WriteTransaction wt(sg);
+        TableRef t = wt.get_table("table");
+        t->optimize();
+        CHECK_EQUAL(t->get_column_type(0), type_String);
+        wt.commit();
+    }
+    ReadTransaction rt(sg);
+    ConstTableRef t = rt.get_table("table");
+    CHECK_EQUAL(t->size(), 2000);
+    for (size_t i = 0; i < 2000; ++i) {
+        std::string str = value(i);
+        CHECK_EQUAL(t->get_string(0, i), str);
+    }
+}
+
 #endif // TEST_GROUP
@@ -0,0 +1,122 @@
+/*************************************************************************
+ *
+ * Copyright 2016 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <realm/util/ordered_pipeline.hpp>
+
+#include "test.hpp"
+
+using namespace realm;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+namespace {
+
+TEST(Util_OrderedPipeline_Order)
+{
+    size_t count = 1000;
+    for (size_t thread_count = 0; thread_count <= 4; ++thread_count) {
+        std::vector<size_t> slots(util::get_pipeline_slot_count(thread_count));
+        size_t consumed = 0;
+        auto produce = [&](size_t item, size_t slot) {
+            slots[slot] = item * item;
+        };
+        auto consume = [&](size_t item, size_t slot) {
+            CHECK_EQUAL(consumed, item);
+            CHECK_EQUAL(item * item, slots[slot]);
+            ++consumed;
+            return true;
+        };
+        util::run_ordered_pipeline(count, thread_count, produce, consume);
+        CHECK_EQUAL(count, consumed);
+    }
+}
+
+TEST(Util_OrderedPipeline_Stop)
+{
+    std::atomic<size_t> produced(0);
+    size_t consumed = 0;
+    auto produce = [&](size_t, size_t) {
+        ++produced;
+    };
+    auto consume = [&](size_t item, size_t) {
+        ++consumed;
+        return item < 10;
+    };
+    size_t thread_count = 3;
+    util::run_ordered_pipeline(1000, thread_count, produce, consume);
+    CHECK_EQUAL(11, consumed);
+    // Workers do not claim items whose slot has not been freed
+    CHECK_LESS_EQUAL(produced, consumed + util::get_pipeline_slot_count(thread_count));
+}
+
+TEST(Util_OrderedPipeline_Error)
+{
+    size_t consumed = 0;
+    auto produce = [&](size_t item, size_t) {
+        if (item == 100)
+            throw std::runtime_error("produce");
+    };
+    auto consume = [&](size_t, size_t) {
+        ++consumed;
+        return true;
+    };
+    CHECK_THROW(util::run_ordered_pipeline(1000, 4, produce, consume), std::runtime_error);
+    CHECK_LESS_EQUAL(consumed, 100);
+
+    auto fail = [&](size_t item, size_t) -> bool {
+        if (item == 100)
+            throw std::runtime_error("consume");
+        return true;
+    };
+    auto ignore = [](size_t, size_t) {};
+    CHECK_THROW(util::run_ordered_pipeline(1000, 4, ignore, fail), std::runtime_error);
+}
+
+} // unnamed namespace